@@ -51,7 +51,8 @@ struct device_system {
 // Configuration
 //
 //------------------------------------------------------------------------------
-static struct device_system DeviceSYSTEM = {
+// default state of every dev_check_ctx
+static const struct device_system DeviceSYSTEM = {
     0, 0, 0, {0, }
 };
 
@@ -59,23 +60,31 @@ static struct device_system DeviceSYSTEM = {
 //------------------------------------------------------------------------------
 static int get_memory_size (void)
 {
-    struct sysinfo sinfo;
+    char rdata[STR_PATH_LENGTH];
+    unsigned long mem_total = 0;
     int mem_size = 0;
+    FILE *fp;
 
-    if (!sysinfo (&sinfo)) {
-        if (sinfo.totalram) {
-
-            mem_size = sinfo.totalram / 1024 / 1024;
+    // MemTotal (kB), same value as sysinfo().totalram
+    if ((fp = dev_root_fopen ("/proc/meminfo", "r")) != NULL) {
+        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
+            if (sscanf (rdata, "MemTotal: %lu kB", &mem_total) == 1)
+                break;
+        }
+        fclose (fp);
+    }
 
-            switch (mem_size) {
-                case    8193 ... 16384: mem_size = 16;  break;
-                case    4097 ... 8192:  mem_size = 8;   break;
-                case    2049 ... 4096:  mem_size = 4;   break;
-                case    1025 ... 2048:  mem_size = 2;   break;
-                default :
-                    mem_size = 0;
-                    break;
-            }
+    if (mem_total) {
+        mem_size = mem_total / 1024;
+
+        switch (mem_size) {
+            case    8193 ... 16384: mem_size = 16;  break;
+            case    4097 ... 8192:  mem_size = 8;   break;
+            case    2049 ... 4096:  mem_size = 4;   break;
+            case    1025 ... 2048:  mem_size = 2;   break;
+            default :
+                mem_size = 0;
+                break;
         }
     }
     return mem_size;
@@ -84,41 +93,35 @@ static int get_memory_size (void)
 //------------------------------------------------------------------------------
 static int get_fb_size (const char *path, int id)
 {
-    FILE *fp;
-    int x, y;
+    char rdata[16], *ptr, *save;
+    int x = 0, y = 0;
 
-    if (access (path, R_OK) == 0) {
-        if ((fp = fopen(path, "r")) != NULL) {
-            char rdata[16], *ptr;
+    // "x,y"
+    if (sysfs_attr_read (path, rdata, sizeof(rdata)) <= 0)
+        return 0;
 
-            memset (rdata, 0x00, sizeof(rdata));
+    if ((ptr = strtok_r (rdata, ",", &save)) != NULL)
+        x = atoi(ptr);
 
-            if (fgets (rdata, sizeof(rdata), fp) != NULL) {
-                if ((ptr = strtok (rdata, ",")) != NULL)
-                    x = atoi(ptr);
+    if ((ptr = strtok_r (NULL, ",", &save)) != NULL)
+        y = atoi(ptr);
 
-                if ((ptr = strtok (NULL, ",")) != NULL)
-                    y = atoi(ptr);
-            }
-            fclose(fp);
-        }
-        switch (id) {
-            case eSYSTEM_FB_X:  return x;
-            case eSYSTEM_FB_Y:  return y;
-            default :           return 0;
-        }
+    switch (id) {
+        case eSYSTEM_FB_X:  return x;
+        case eSYSTEM_FB_Y:  return y;
+        default :           return 0;
     }
-    return 0;
 }
 
 //------------------------------------------------------------------------------
-int system_data_check (int dev_id, int resp_i)
+int system_data_check (struct dev_check_ctx *ctx, int dev_id, int resp_i)
 {
+    struct device_system *sys = dev_check_ctx_data (ctx, eGID_SYSTEM);
     int status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eSYSTEM_MEM:
-        DeviceSYSTEM.mem_size = resp_i;
+        sys->mem_size = resp_i;
         status = (resp_i == get_memory_size()) ? 1 : 0;
 
         default :
@@ -128,29 +131,30 @@ int system_data_check (int dev_id, int resp_i)
 }
 
 //------------------------------------------------------------------------------
-int system_check (int dev_id, char *resp)
+int system_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_system *sys = dev_check_ctx_data (ctx, eGID_SYSTEM);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eSYSTEM_MEM:
             value  = get_memory_size();
-            if (DeviceSYSTEM.mem_size)
-                status = (DeviceSYSTEM.mem_size == value) ? 1 : -1;
+            if (sys->mem_size)
+                status = (sys->mem_size == value) ? 1 : -1;
             else
                 status = value ? 1 : -1;
             break;
         case eSYSTEM_FB_X:
-            value  = get_fb_size (DeviceSYSTEM.fb_path, id);
-            status = (value == DeviceSYSTEM.res_x) ? 1 : -1;
+            value  = get_fb_size (sys->fb_path, id);
+            status = (value == sys->res_x) ? 1 : -1;
             break;
         case eSYSTEM_FB_Y:
-            value = get_fb_size (DeviceSYSTEM.fb_path, id);
-            status = (value == DeviceSYSTEM.res_y) ? 1 : -1;
+            value = get_fb_size (sys->fb_path, id);
+            status = (value == sys->res_y) ? 1 : -1;
             break;
         case eSYSTEM_FB_SIZE:
-            if ((get_fb_size (DeviceSYSTEM.fb_path, eSYSTEM_FB_X) == DeviceSYSTEM.res_x) &&
-                (get_fb_size (DeviceSYSTEM.fb_path, eSYSTEM_FB_Y) == DeviceSYSTEM.res_y))
+            if ((get_fb_size (sys->fb_path, eSYSTEM_FB_X) == sys->res_x) &&
+                (get_fb_size (sys->fb_path, eSYSTEM_FB_Y) == sys->res_y))
                 status = 1;
             else
                 value = -1;
@@ -158,38 +162,39 @@ int system_check (int dev_id, char *resp)
         default :
             break;
     }
-    if ((id == eSYSTEM_MEM) && !DeviceSYSTEM.mem_size)
+    if ((id == eSYSTEM_MEM) && !sys->mem_size)
         DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'C' : 'F', value);
     else
         DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'F', value);
 
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_SYSTEM, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void system_grp_init (char *cfg)
+void system_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_system *sys = dev_check_ctx_data (ctx, eGID_SYSTEM);
+    char *tok, *save;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             switch (atoi(tok)) {
                 case eSYSTEM_MEM:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceSYSTEM.mem_size = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        sys->mem_size = atoi(tok);
                     break;
                 case eSYSTEM_FB_X:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceSYSTEM.res_x = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        sys->res_x = atoi(tok);
                     break;
                 case eSYSTEM_FB_Y:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                    DeviceSYSTEM.res_y = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                    sys->res_y = atoi(tok);
                     break;
                 case eSYSTEM_FB_SIZE:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceSYSTEM.fb_path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (sys->fb_path, tok, strlen(tok));
                     break;
                 default :
                     printf ("%s : error! unknown did = %d\n", __func__, atoi(tok));
@@ -199,5 +204,20 @@ void system_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static int system_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    pdata->status_i = system_data_check (ctx, pdata->did, pdata->resp_i);
+    return pdata->status_i;
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupSYSTEM = {
+    "SYSTEM", eGID_SYSTEM, eGID_SYSTEM, sizeof(struct device_system), &DeviceSYSTEM,
+    system_grp_init, system_check, system_resp_check, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupSYSTEM);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
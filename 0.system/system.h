@@ -31,9 +31,11 @@ enum {
 //------------------------------------------------------------------------------
 // function prototype
 //------------------------------------------------------------------------------
-extern int  system_data_check   (int dev_id, int resp_i);
-extern int  system_check        (int dev_id, char *resp);
-extern void system_grp_init     (char *cfg);
+struct dev_check_ctx;
+
+extern int  system_data_check   (struct dev_check_ctx *ctx, int dev_id, int resp_i);
+extern int  system_check        (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void system_grp_init     (struct dev_check_ctx *ctx, char *cfg);
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
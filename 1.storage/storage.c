@@ -51,131 +51,129 @@ struct device_storage {
 
     // r/w mode(0 = read, 1 = write)
     int rw;
-
-    // r/w thread
-    int thread_en;
-    pthread_t thread;
 };
 
-pthread_mutex_t mutex_storage = PTHREAD_MUTEX_INITIALIZER;
-
 //------------------------------------------------------------------------------
 //
 // Configuration
 //
 //------------------------------------------------------------------------------
-struct device_storage DeviceSTORAGE [eSTORAGE_END] = {
-    // init, boot_device, path, rw_check, rw_value, rw_mode, thread_en, pthread,
+// default state of every dev_check_ctx
+static const struct device_storage DeviceSTORAGE [eSTORAGE_END] = {
+    // init, boot_device, path, rw_check, rw_value, rw_mode,
     // eSTORAGE_EMMC
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // eSTORAGE_uSD (boot device : /root)
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // eSTORAGE_SATA
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // eSTORAGE_NVME
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
 };
 
 //------------------------------------------------------------------------------
 #define TEMP_FILE       "/tmp/wdat"
 
-// Storage Read / Write (16 Mbytes, 1 block count)
-const char *STORAGE_R_CHECK = "dd of=/dev/null bs=16M count=1 iflag=nocache,dsync oflag=nocache,dsync if=";
-const char *STORAGE_W_CHECK = "dd if=/dev/zero bs=16M count=1 iflag=nocache,dsync oflag=nocache,dsync of=";
+// Storage Read / Write (16 Mbytes, 1 block count), dd {if} {of} ...
+#define STORAGE_DD_TIMEOUT  20000   // ms
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 static int remove_tmp (const char *path)
 {
-    FILE *fp;
-    char cmd[STR_PATH_LENGTH];
+    if (access (path, R_OK) == 0)
+        return (unlink (path) == 0);
 
-    if (access (path, R_OK) == 0) {
-        memset  (cmd, 0x00, sizeof(cmd));
-        sprintf (cmd, "rm -f %s 2>&1", path);
-
-        if ((fp = popen (cmd, "r")) != NULL) {
-            pclose(fp);
-            return 1;
-        }
-    }
     return 0;
 }
 
 //------------------------------------------------------------------------------
 static int storage_rw (struct device_storage *p_storage)
 {
-    FILE *fp;
-    char cmd[STR_PATH_LENGTH *2], rdata[STR_PATH_LENGTH], *ptr;
-
-    if (!access (p_storage->path, F_OK)) {
-        memset  (cmd, 0x00, sizeof(cmd));
-        if (p_storage->rw) {
-            sprintf (cmd, "%s%s 2>&1 && sync",
-                STORAGE_W_CHECK, p_storage->boot_device ? TEMP_FILE : p_storage->path);
-
-        } else {
-            sprintf (cmd, "%s%s 2>&1 && sync",
-                STORAGE_R_CHECK, p_storage->path);
-        }
+    struct subproc sp;
+    char rdata[STR_PATH_LENGTH], *ptr, dd_if[PATH_MAX +4], dd_of[PATH_MAX +4];
+    char buf[PATH_MAX];
+    const char *path = dev_root_path (p_storage->path, buf, sizeof(buf));
+    char *argv[] = { "dd", dd_if, dd_of, "bs=16M", "count=1",
+                     "iflag=nocache,dsync", "oflag=nocache,dsync", NULL };
+    int speed = 0;
+
+    if (access (path, F_OK))
+        return -1;
+
+    if (p_storage->rw) {
+        snprintf (dd_if, sizeof(dd_if), "if=/dev/zero");
+        snprintf (dd_of, sizeof(dd_of), "of=%s", p_storage->boot_device ? TEMP_FILE : path);
+    } else {
+        snprintf (dd_if, sizeof(dd_if), "if=%s", path);
+        snprintf (dd_of, sizeof(dd_of), "of=/dev/null");
+    }
 
-        if ((fp = popen (cmd, "r")) != NULL) {
-            while (fgets (rdata, sizeof(rdata), fp) != NULL) {
-                if ((ptr = strstr (rdata, " MB/s")) != NULL) {
-                    while (*ptr != ',') ptr--;
-                    pclose(fp);
-                    return atoi (ptr+1);
-                }
-            }
-            pclose(fp);
-        }
+    if (!subproc_spawn (&sp, argv, SUBPROC_OUT, STORAGE_DD_TIMEOUT))
         return 0;
+
+    while (subproc_gets (&sp, rdata, sizeof(rdata)) != NULL) {
+        if ((ptr = strstr (rdata, " MB/s")) != NULL) {
+            while (*ptr != ',') ptr--;
+            speed = atoi (ptr+1);
+            break;
+        }
+        // faster than 1GB/s (nvme, file backed fixture)
+        if ((ptr = strstr (rdata, " GB/s")) != NULL) {
+            while (*ptr != ',') ptr--;
+            speed = (int)(atof (ptr+1) * 1000);
+            break;
+        }
     }
-    return -1;
+    // dd failed or killed at the deadline
+    if (subproc_wait (&sp) != 0)
+        return 0;
+
+    sync ();
+    return speed;
 }
 
 //------------------------------------------------------------------------------
-static void *thread_func_storage (void *arg)
+static void storage_rw_retry (struct device_storage *p_storage)
 {
-    struct device_storage *p_storage = (struct device_storage *)arg;
+    struct res_lock_set set;
     int retry = 5;
 
-    p_storage->thread_en = 1;
-    while (retry--) {
-        pthread_mutex_lock(&mutex_storage);
+    // dd speed : nothing else on the device (boot device : temp file)
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "%s", p_storage->path);
+    if (p_storage->boot_device)
+        res_lock_set_add (&set, RES_LOCK_WRITE, "%s", TEMP_FILE);
 
-        if (p_storage->rw_value[p_storage->rw] <= p_storage->rw_check[p_storage->rw])
-            p_storage->rw_value[p_storage->rw] = storage_rw (p_storage);
+    while (retry--) {
+        if (res_lock_acquire (&set, STORAGE_DD_TIMEOUT)) {
+            if (p_storage->rw_value[p_storage->rw] <= p_storage->rw_check[p_storage->rw])
+                p_storage->rw_value[p_storage->rw] = storage_rw (p_storage);
 
-        pthread_mutex_unlock(&mutex_storage);
+            res_lock_release (&set);
+        }
 
         if (p_storage->rw_value[p_storage->rw] > p_storage->rw_check[p_storage->rw])
             break;
 
         usleep (100 * 1000);
     }
-    p_storage->thread_en = 0;
-    return arg;
 }
 
 //------------------------------------------------------------------------------
-int storage_check (int dev_id, char *resp)
+int storage_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_storage *storage = dev_check_ctx_data (ctx, eGID_STORAGE);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
-    struct device_storage *p_storage = &DeviceSTORAGE[id];
+    struct device_storage *p_storage = &storage[id];
 
     switch (id) {
         case eSTORAGE_eMMC: case eSTORAGE_uSD:
         case eSTORAGE_SATA: case eSTORAGE_NVME:
 
-            do { usleep (100 * 1000); } while (p_storage->thread_en);
-
+            // the lane lock (device_check) keeps the checks of a storage apart
             p_storage->rw = DEVICE_ACTION(dev_id);
-
-            pthread_create (&p_storage->thread, NULL,
-                                thread_func_storage, p_storage);
-
-            do { usleep (100 * 1000); } while (p_storage->thread_en);
+            storage_rw_retry (p_storage);
 
             if (p_storage->rw && p_storage->boot_device)
                 remove_tmp (TEMP_FILE);
@@ -187,33 +185,34 @@ int storage_check (int dev_id, char *resp)
             break;
     }
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'F', value);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_STORAGE, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void storage_grp_init (char *cfg)
+void storage_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_storage *storage = dev_check_ctx_data (ctx, eGID_STORAGE);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eSTORAGE_eMMC: case eSTORAGE_uSD:
                 case eSTORAGE_SATA: case eSTORAGE_NVME:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceSTORAGE[did].path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (storage[did].path, tok, strlen(tok));
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceSTORAGE[did].rw_check[0] = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        storage[did].rw_check[0] = atoi(tok);
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceSTORAGE[did].rw_check[1] = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        storage[did].rw_check[1] = atoi(tok);
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceSTORAGE[did].boot_device = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        storage[did].boot_device = atoi(tok);
                     break;
 
                 default :
@@ -224,5 +223,13 @@ void storage_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static const struct dev_group GroupSTORAGE = {
+    "STORAGE", eGID_STORAGE, eGID_STORAGE, sizeof(DeviceSTORAGE), DeviceSTORAGE,
+    storage_grp_init, storage_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupSTORAGE);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
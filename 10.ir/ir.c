@@ -31,6 +31,7 @@
 #include <linux/input.h>
 #include <getopt.h>
 #include <pthread.h>
+#include <sys/epoll.h>
 #include <sys/sysinfo.h>
 
 //------------------------------------------------------------------------------
@@ -48,6 +49,10 @@ struct device_ir {
 
     int key_code;
     int key_count;
+
+    // event node open (find_event : worker pool), event loop source
+    struct worker_future job;
+    int fd, src;
 };
 
 //------------------------------------------------------------------------------
@@ -55,16 +60,21 @@ struct device_ir {
 // Configuration
 //
 //------------------------------------------------------------------------------
-struct device_ir DeviceIR = {
-    { 0, }, { 0, }, 0, 0, 0, 0
+// default state of every dev_check_ctx
+static const struct device_ir DeviceIR = {
+    { 0, }, { 0, }, 0, 0, 0, 0, { 0, }, -1, 0
 };
 
 //------------------------------------------------------------------------------
+#define UDEVADM_TIMEOUT     2000    // ms
+
 static int find_event (const char *f_str)
 {
     FILE *fp;
-    char cmd  [STR_PATH_LENGTH];
-    int ev_num = 0;
+    struct subproc sp;
+    char cmd  [STR_PATH_LENGTH], node[STR_PATH_LENGTH];
+    char *argv[] = { "udevadm", "info", "-a", "-n", node, NULL };
+    int ev_num = 0, found = 0;
 
     /*
         find /dev/input -name event*        udevadm info -a -n /dev/input/event3 | grep 0705
@@ -72,130 +82,159 @@ static int find_event (const char *f_str)
     while (1) {
         memset  (cmd, 0, sizeof(cmd));
         sprintf (cmd, "/dev/input/event%d", ev_num);
-        if (access  (cmd, F_OK))    return -1;
+        if (dev_root_access (cmd, F_OK))    return -1;
 
-        memset  (cmd, 0, sizeof(cmd));
-        sprintf (cmd, "udevadm info -a -n /dev/input/event%d | grep %s", ev_num, f_str);
-        if ((fp = popen(cmd, "r")) != NULL) {
-            memset (cmd, 0x00, sizeof(cmd));
-            while (fgets (cmd, sizeof(cmd), fp) != NULL) {
-                if (strstr (cmd, f_str) != NULL) {
+        // fake device tree : no udev database, match the input device name
+        if (dev_root_get () != NULL) {
+            sprintf (cmd, "/sys/class/input/event%d/device/name", ev_num);
+            if ((fp = dev_root_fopen (cmd, "r")) != NULL) {
+                memset (cmd, 0x00, sizeof(cmd));
+                fgets  (cmd, sizeof(cmd), fp);
+                fclose (fp);
+                if (strstr (cmd, f_str) != NULL)
                     return ev_num;
-                    pclose (fp);
+            }
+            ev_num++;
+            continue;
+        }
+
+        // udevadm info -a -n /dev/input/event{ev_num}
+        sprintf (node, "/dev/input/event%d", ev_num);
+        if (subproc_spawn (&sp, argv, SUBPROC_OUT, UDEVADM_TIMEOUT)) {
+            while (subproc_gets (&sp, cmd, sizeof(cmd)) != NULL) {
+                if (strstr (cmd, f_str) != NULL) {
+                    found = 1;
+                    break;
                 }
             }
+            subproc_wait (&sp);
+            if (found)
+                return ev_num;
         }
         ev_num++;
     }
 }
 
 //------------------------------------------------------------------------------
-pthread_t thread_ir;
+static void ir_key (struct device_ir *ir, struct input_event *event)
+{
+    switch (event->type) {
+        case EV_SYN:
+            break;
+        case EV_KEY:
+            switch (event->code) {
+                /* emergency stop */
+                case KEY_MUTE:  case KEY_HOME:  case KEY_VOLUMEDOWN: case KEY_VOLUMEUP:
+                case KEY_MENU:  case KEY_UP:    case KEY_DOWN:       case KEY_LEFT:
+                case KEY_RIGHT: case KEY_ENTER: case KEY_BACK:
+                    if (ir->pass_key_code && (ir->pass_key_code == event->code))
+                        ir->key_count++;
+                    else
+                        ir->key_count++;
+
+                    ir->key_code = event->code;
+                    DEV_LOG (eLOG_INFO, eGID_IR, "IR_EVENT_COUNT = %d, IR_KEY_CODE = %d\n",
+                        ir->key_count, ir->key_code);
+                    break;
+                default :
+                    break;
+            }
+            break;
+        default :
+            DEV_LOG (eLOG_DEBUG, eGID_IR, "unknown event\n");
+            break;
+    }
+}
 
-void *thread_func_ir (void *arg)
+//------------------------------------------------------------------------------
+// event loop callback (EPOLLIN)
+//------------------------------------------------------------------------------
+static void ir_event (void *arg, int fd, unsigned int events)
 {
+    struct device_ir *ir = (struct device_ir *)arg;
     struct input_event event;
-    struct timeval  timeout;
-    fd_set readFds;
-    static int fd = -1;
+    ssize_t n;
+
+    (void)events;
+    while ((n = read (fd, &event, sizeof(struct input_event))) == sizeof(struct input_event))
+        ir_key (ir, &event);
+
+    // writer closed (fifo of a fake device tree) : open it again
+    if (n == 0) {
+        if ((ir->fd = dev_root_open (ir->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC)) >= 0)
+            event_loop_fd (ir->src, ir->fd);
+        else
+            event_loop_fd (ir->src, -1);
+        close (fd);
+    }
+}
+
+//------------------------------------------------------------------------------
+// worker pool : find_event runs udevadm
+//------------------------------------------------------------------------------
+static void ir_open_job (void *arg)
+{
     struct device_ir *ir = (struct device_ir *)arg;
+    int fd;
 
     // IR Device Name (meson-ir)
     sprintf (ir->path, "/dev/input/event%d", find_event (ir->f_str));
 
-    if ((fd = open(ir->path, O_RDONLY)) < 0) {
-        printf ("%s : %s error!\n", __func__, ir->path);
-        return arg;
+    if ((fd = dev_root_open (ir->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        DEV_LOG (eLOG_ERR, eGID_IR, "%s : %s error!\n", __func__, ir->path);
+        return;
     }
-
-    while (1) {
-        // recive time out config
-        // Set 1ms timeout counter
-        timeout.tv_sec  = 0;
-        // timeout.tv_usec = timeout_ms*1000;
-        timeout.tv_usec = 300000;
-
-        FD_ZERO(&readFds);
-        FD_SET(fd, &readFds);
-        select(fd+1, &readFds, NULL, NULL, &timeout);
-
-        if(FD_ISSET(fd, &readFds))
-        {
-            if(fd && read(fd, &event, sizeof(struct input_event))) {
-
-                switch (event.type) {
-                    case EV_SYN:
-                        break;
-                    case EV_KEY:
-                        switch (event.code) {
-                            /* emergency stop */
-                            case KEY_MUTE:  case KEY_HOME:  case KEY_VOLUMEDOWN: case KEY_VOLUMEUP:
-                            case KEY_MENU:  case KEY_UP:    case KEY_DOWN:       case KEY_LEFT:
-                            case KEY_RIGHT: case KEY_ENTER: case KEY_BACK:
-                                if (ir->pass_key_code && (ir->pass_key_code == event.code))
-                                    ir->key_count++;
-                                else
-                                    ir->key_count++;
-
-                                ir->key_code = event.code;
-                                printf ("IR_EVENT_COUNT = %d, IR_KEY_CODE = %d\n",
-                                    ir->key_count, ir->key_code);
-                                break;
-                            default :
-                                break;
-                        }
-                        break;
-                    default :
-                        printf("unknown event\n");
-                        break;
-                }
-            }
-        }
+    ir->fd  = fd;
+    if (!(ir->src = event_loop_add (fd, EPOLLIN, ir_event, ir))) {
+        close (fd);
+        ir->fd = -1;
     }
-    return arg;
 }
 
 //------------------------------------------------------------------------------
-int ir_check (int dev_id, char *resp)
+int ir_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_ir *ir = dev_check_ctx_data (ctx, eGID_IR);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eIR_ID0:
-            status = (DeviceIR.key_count > DeviceIR.pass_count) ? 1 : 0;
-            value  =  DeviceIR.key_code;
+            status = (ir->key_count > ir->pass_count) ? 1 : 0;
+            value  =  ir->key_code;
             break;
         default :
             break;
     }
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'C', value);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_IR, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void ir_grp_init (char *cfg)
+void ir_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_ir *ir = dev_check_ctx_data (ctx, eGID_IR);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eIR_ID0:
                     break;
                 case eIR_CFG:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceIR.f_str, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (ir->f_str, tok, strlen(tok));
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceIR.pass_count = atoi (tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        ir->pass_count = atoi (tok);
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceIR.pass_key_code = atoi (tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        ir->pass_key_code = atoi (tok);
 
-                    pthread_create (&thread_ir, NULL, thread_func_ir, &DeviceIR);
+                    if (!ir->src && !worker_future_busy (&ir->job))
+                        worker_future_submit (&ir->job, ir_open_job, ir, 0);
                     break;
                 default :
                     break;
@@ -204,5 +243,35 @@ void ir_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static int ir_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    char resp [DEVICE_RESP_SIZE+1];
+
+    /* IR Thread running */
+    memset (resp, 0, sizeof(resp));
+    pdata->status_i = ir_check (ctx, pdata->did, resp);
+    return pdata->status_i;
+}
+
+//------------------------------------------------------------------------------
+static void ir_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct device_ir *ir = dev_check_ctx_data (ctx, eGID_IR);
+
+    worker_future_wait (&ir->job);
+    event_loop_del (ir->src);
+    if (ir->fd >= 0)
+        close (ir->fd);
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupIR = {
+    "IR", eGID_IR, eGID_IR, sizeof(DeviceIR), &DeviceIR,
+    ir_grp_init, ir_check, ir_resp_check, ir_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupIR);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,40 +1,42 @@
-//------------------------------------------------------------------------------
-/**
- * @file ir.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-21
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __IR_H__
-#define __IR_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the IR group.
-//------------------------------------------------------------------------------
-#define eIR_CFG -1
-
-enum {
-    eIR_ID0 = 0,
-    eIR_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  ir_check     (int dev_id, char *resp);
-extern void ir_grp_init  (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __IR_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file ir.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-21
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __IR_H__
+#define __IR_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the IR group.
+//------------------------------------------------------------------------------
+#define eIR_CFG -1
+
+enum {
+    eIR_ID0 = 0,
+    eIR_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  ir_check     (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void ir_grp_init  (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __IR_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
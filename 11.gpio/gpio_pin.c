@@ -49,7 +49,8 @@ struct device_gpio {
 // Configuration
 //
 //------------------------------------------------------------------------------
-struct device_gpio DeviceGPIO[eGPIO_END] = {
+// default state of every dev_check_ctx
+static const struct device_gpio DeviceGPIO[eGPIO_END] = {
     // eGPIO_ID0
     { 0, { 0, }, 0, 0 },
     // eGPIO_ID1
@@ -57,28 +58,40 @@ struct device_gpio DeviceGPIO[eGPIO_END] = {
     // ...
 };
 
+// bank used by a header pattern check (ms)
+#define GPIO_LOCK_TIMEOUT   1000
+
 //------------------------------------------------------------------------------
-static int gpio_pin_control (int id, int value)
+static int gpio_pin_control (struct device_gpio *gpio, int id, int value)
 {
+    struct res_lock_set set;
     int g_value = 0;
 
-    gpio_set_value (DeviceGPIO[id].num, value);
-    gpio_get_value (DeviceGPIO[id].num, &g_value);
+    // header pattern check on the same bank
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "gpio_bank%d", gpio[id].num / RES_LOCK_GPIO_BANK);
+    if (!res_lock_acquire (&set, GPIO_LOCK_TIMEOUT))
+        return 0;
+
+    gpio_set_value (gpio[id].num, value);
+    gpio_get_value (gpio[id].num, &g_value);
 
+    res_lock_release (&set);
     return (value == g_value) ? 1 : 0;
 }
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-int gpio_data_check (int dev_id, int resp_i)
+int gpio_data_check (struct dev_check_ctx *ctx, int dev_id, int resp_i)
 {
+    struct device_gpio *gpio = dev_check_ctx_data (ctx, eGID_GPIO);
     int status = 0, id = DEVICE_ID(dev_id);
     switch (id) {
         case 0 ... 9:
             if (DEVICE_ACTION(dev_id))
-                status = (resp_i > DeviceGPIO[id].max) ? 1 : 0;    // gpio on
+                status = (resp_i > gpio[id].max) ? 1 : 0;    // gpio on
             else
-                status = (resp_i < DeviceGPIO[id].min) ? 1 : 0;    // gpio off
+                status = (resp_i < gpio[id].min) ? 1 : 0;    // gpio off
             break;
         default :
             status = 0;
@@ -88,51 +101,53 @@ int gpio_data_check (int dev_id, int resp_i)
 }
 
 //------------------------------------------------------------------------------
-int gpio_check (int dev_id, char *resp)
+int gpio_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_gpio *gpio = dev_check_ctx_data (ctx, eGID_GPIO);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case 0 ... 9:
-            value  = gpio_pin_control (id, DEVICE_ACTION(dev_id));
+            value  = gpio_pin_control (gpio, id, DEVICE_ACTION(dev_id));
             status = (value == 1) ? 1 : -1;
             break;
         default :
             break;
     }
-    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', DeviceGPIO[id].cname);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', gpio[id].cname);
+    DEV_LOG (eLOG_DEBUG, eGID_GPIO, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void gpio_grp_init (char *cfg)
+void gpio_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_gpio *gpio = dev_check_ctx_data (ctx, eGID_GPIO);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case 0 ... 9:
                     // gpio num
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceGPIO[did].num = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        gpio[did].num = atoi(tok);
 
                     // gpio adc con name
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceGPIO[did].cname, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (gpio[did].cname, tok, strlen(tok));
 
                     // gpio on value
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceGPIO[did].max = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        gpio[did].max = atoi(tok);
 
                     // gpio off value
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceGPIO[did].min = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        gpio[did].min = atoi(tok);
 
-                    gpio_export (DeviceGPIO[did].num);  gpio_direction (DeviceGPIO[did].num, 1);
+                    gpio_export (gpio[did].num);  gpio_direction (gpio[did].num, 1);
                     break;
                 default :
                     printf ("%s : error! unknown did = %d\n", __func__, did);
@@ -142,5 +157,13 @@ void gpio_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static const struct dev_group GroupGPIO = {
+    "GPIO", eGID_GPIO, eGID_HEADER, sizeof(DeviceGPIO), DeviceGPIO,
+    gpio_grp_init, gpio_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupGPIO);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,40 +1,42 @@
-//------------------------------------------------------------------------------
-/**
- * @file gpio_pin.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-21
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __GPIO_PIN_H__
-#define __GPIO_PIN_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the GPIO group.
-//------------------------------------------------------------------------------
-enum {
-    eGPIO_ID0,
-    eGPIO_ID1,
-    eGPIO_END = 10,
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  gpio_data_check(int dev_id, int resp_i);
-extern int  gpio_check     (int dev_id, char *resp);
-extern void gpio_grp_init  (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __GPIO_PIN_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file gpio_pin.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-21
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __GPIO_PIN_H__
+#define __GPIO_PIN_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the GPIO group.
+//------------------------------------------------------------------------------
+enum {
+    eGPIO_ID0,
+    eGPIO_ID1,
+    eGPIO_END = 10,
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  gpio_data_check(struct dev_check_ctx *ctx, int dev_id, int resp_i);
+extern int  gpio_check     (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void gpio_grp_init  (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __GPIO_PIN_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -52,26 +52,29 @@ struct device_fw {
 // Configuration
 //
 //------------------------------------------------------------------------------
-struct device_fw DeviceFW [eFW_END] = {
+// default state of every dev_check_ctx
+static const struct device_fw DeviceFW [eFW_END] = {
     // C4
     { { 0, }, { 0, }, { 0, }, { 0, } },
 };
 
-const char *scan_hub  = "lsusb | grep 2109 | awk '{print $6}'";
-const char *reset_hub = "echo reset > /sys/devices/platform/gpio-reset/reset-usb_hub/control";
-const char *read_fw_ver  = "usb-devices | grep Rev | grep 2109 | grep 817 | awk '{print $4}' | sed \"s/Rev=//g\"";
+// lsusb : "ID 2109:0817", usb-devices : "Vendor=2109 ProdID=0817 Rev=xx.xx"
+const char *reset_hub = "/sys/devices/platform/gpio-reset/reset-usb_hub/control";
+
+#define FW_SCAN_TIMEOUT     5000    // ms
+#define FW_WRITE_TIMEOUT    120000  // ms
 
 //------------------------------------------------------------------------------
 static void usb_hub_reset (void)
 {
     FILE *fp;
-    char cmd [STR_PATH_LENGTH *2];
-
-    memset  (cmd, 0, sizeof(cmd));
-    sprintf (cmd, "%s && sync", reset_hub);
 
-    if ((fp = popen (cmd, "w")) != NULL)
-        pclose(fp);
+    // echo reset > {reset_hub}
+    if ((fp = dev_root_fopen (reset_hub, "w")) != NULL) {
+        fputs  ("reset", fp);
+        fclose (fp);
+    }
+    sync ();
 
     sleep (1);
 }
@@ -79,135 +82,149 @@ static void usb_hub_reset (void)
 //------------------------------------------------------------------------------
 static int usb_hub_check (void)
 {
-    FILE *fp;
-    char cmd [STR_PATH_LENGTH *2], rdata[10];
+    struct subproc sp;
+    char rdata[STR_PATH_LENGTH];
+    char *argv[] = { "lsusb", NULL };
+    int found = 0;
 
-    memset  (cmd, 0, sizeof(cmd));
-    sprintf (cmd, "%s && sync", scan_hub);
+    if (!subproc_spawn (&sp, argv, SUBPROC_OUT, FW_SCAN_TIMEOUT))
+        return 0;
 
-    if ((fp = popen (cmd, "r")) != NULL) {
-        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
-            if (strstr(rdata, "2109") != NULL) {
-                pclose(fp);
-                return 1;
-            }
+    while (subproc_gets (&sp, rdata, sizeof(rdata)) != NULL) {
+        if (strstr(rdata, " 2109:") != NULL) {
+            found = 1;
+            break;
         }
-        pclose(fp);
     }
-    return 0;
+    subproc_wait (&sp);
+    return found;
 }
 
 //------------------------------------------------------------------------------
-static int c4_fw_write (int id)
+static int c4_fw_write (struct device_fw *fw, int id)
 {
-    FILE *fp;
-    char cmd [STR_PATH_LENGTH *3], rdata[STR_PATH_LENGTH];
+    struct subproc sp;
+    char script [STR_PATH_LENGTH + 8], rdata[STR_PATH_LENGTH];
+    char *argv[] = { fw[id].bin_path, "--vid=2109", "-pid=0817", script, NULL };
+    int success = 0;
 
     if (!usb_hub_check())   return 0;
 
-    memset  (cmd, 0, sizeof(cmd));
-    sprintf (cmd, "%s --vid=2109 -pid=0817 -script=%s && sync",
-                DeviceFW[id].bin_path, DeviceFW[id].fw_path);
+    snprintf (script, sizeof(script), "-script=%s", fw[id].fw_path);
 
-    printf ("%s : %s\n", __func__, cmd);
-    if ((fp = popen (cmd, "r")) != NULL) {
-        memset (rdata, 0, sizeof(rdata));
-        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
-            if (strstr(rdata, "success") != NULL) {
-                pclose(fp);
-                return 1;
-            }
-            memset (rdata, 0, sizeof(rdata));
+    DEV_LOG (eLOG_INFO, eGID_FW, "%s : %s --vid=2109 -pid=0817 %s\n", __func__, fw[id].bin_path, script);
+    if (!subproc_spawn (&sp, argv, SUBPROC_OUT, FW_WRITE_TIMEOUT))
+        return 0;
+
+    memset (rdata, 0, sizeof(rdata));
+    while (subproc_gets (&sp, rdata, sizeof(rdata)) != NULL) {
+        if (strstr(rdata, "success") != NULL) {
+            success = 1;
+            break;
         }
-        pclose(fp);
+        memset (rdata, 0, sizeof(rdata));
     }
-    return 0;
+    if (subproc_wait (&sp) != 0)
+        return 0;
+
+    sync ();
+    return success;
 }
 
 //------------------------------------------------------------------------------
-static int c4_ver_read (int id)
+static int c4_ver_read (struct device_fw *fw, int id)
 {
-    FILE *fp;
-    char cmd [STR_PATH_LENGTH *2], rdata[10];
-
-    memset  (cmd, 0, sizeof(cmd));
-    sprintf (cmd, "%s && sync", read_fw_ver);
+    struct subproc sp;
+    char rdata[STR_PATH_LENGTH], *ver;
+    char *argv[] = { "usb-devices", NULL };
+    int found = 0;
 
     if (!usb_hub_check())   return 0;
 
-    if ((fp = popen (cmd, "r")) != NULL) {
-        while (fgets (rdata, sizeof(rdata), fp) != NULL) {
-            if (strlen(rdata) > 2) {
-                strncpy (DeviceFW[id].fw_ver, rdata, strlen(rdata)-1);
-                printf ("%s : version = %s\n", __func__, rdata);
-                pclose(fp);
-                return 1;
-            }
+    if (!subproc_spawn (&sp, argv, SUBPROC_OUT, FW_SCAN_TIMEOUT))
+        return 0;
+
+    while (subproc_gets (&sp, rdata, sizeof(rdata)) != NULL) {
+        if ((strstr(rdata, "2109") == NULL) || (strstr(rdata, "817") == NULL))
+            continue;
+        if ((ver = strstr(rdata, "Rev=")) == NULL)
+            continue;
+
+        ver += strlen("Rev=");
+        ver[strcspn (ver, " \t\r\n")] = 0;
+        if (strlen(ver) > 1) {
+            memset  (fw[id].fw_ver, 0, sizeof(fw[id].fw_ver));
+            strncpy (fw[id].fw_ver, ver, sizeof(fw[id].fw_ver) -1);
+            DEV_LOG (eLOG_INFO, eGID_FW, "%s : version = %s\n", __func__, ver);
+            found = 1;
+            break;
         }
-        pclose(fp);
     }
-    return 0;
+    subproc_wait (&sp);
+    return found;
 }
 
 //------------------------------------------------------------------------------
-static int c4_ver_check (int id)
+static int c4_ver_check (struct device_fw *fw, int id)
 {
-    if (c4_ver_read (id)) {
-        if (!strncmp (DeviceFW[id].fw_ver, DeviceFW[id].check_fw_ver,
-                        strlen(DeviceFW[id].check_fw_ver)))
+    if (c4_ver_read (fw, id)) {
+        if (!strncmp (fw[id].fw_ver, fw[id].check_fw_ver,
+                        strlen(fw[id].check_fw_ver)))
             return 1;
 
-        printf ("%s : firmware version check error! (read %s : check %s)\n",
-                            __func__, DeviceFW[id].fw_ver, DeviceFW[id].check_fw_ver);
+        DEV_LOG (eLOG_WARN, eGID_FW, "%s : firmware version check error! (read %s : check %s)\n",
+                            __func__, fw[id].fw_ver, fw[id].check_fw_ver);
 
-        if (c4_fw_write (id)) {
+        if (c4_fw_write (fw, id)) {
             usb_hub_reset ();
-            return (c4_ver_read (id));
+            return (c4_ver_read (fw, id));
         }
     }
     return 0;
 }
 
 //------------------------------------------------------------------------------
-int fw_check (int dev_id, char *resp)
+int fw_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_fw *fw = dev_check_ctx_data (ctx, eGID_FW);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eFW_C4:
-            value  = c4_ver_check (id);
+            value  = c4_ver_check (fw, id);
             status = (value == 1) ? 1 : -1;
             break;
         default :
             break;
     }
-    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', DeviceFW[id].fw_ver);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', fw[id].fw_ver);
+    DEV_LOG (eLOG_DEBUG, eGID_FW, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void fw_grp_init (char *cfg)
+void fw_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_fw *fw = dev_check_ctx_data (ctx, eGID_FW);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eFW_C4:
                     // exec bin file path
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        find_file_path (tok, DeviceFW[did].bin_path);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        find_file_path (tok, fw[did].bin_path);
 
                     // f/w file path
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        find_file_path (tok, DeviceFW[did].fw_path);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        find_file_path (tok, fw[did].fw_path);
 
                     // f/w ver str
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceFW[did].check_fw_ver, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (fw[did].check_fw_ver, tok, strlen(tok));
                     break;
                 default :
                     printf ("%s : error! unknown did = %d\n", __func__, did);
@@ -217,5 +234,13 @@ void fw_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static const struct dev_group GroupFW = {
+    "FW", eGID_FW, eGID_STORAGE, sizeof(DeviceFW), DeviceFW,
+    fw_grp_init, fw_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupFW);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
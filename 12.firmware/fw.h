@@ -1,38 +1,40 @@
-//------------------------------------------------------------------------------
-/**
- * @file fw.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-21
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __FW_H__
-#define __FW_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the Firmware group.
-//------------------------------------------------------------------------------
-enum {
-    eFW_C4,
-    eFW_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  fw_check     (int dev_id, char *resp);
-extern void fw_grp_init  (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __FW_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file fw.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-21
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __FW_H__
+#define __FW_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the Firmware group.
+//------------------------------------------------------------------------------
+enum {
+    eFW_C4,
+    eFW_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  fw_check     (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void fw_grp_init  (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __FW_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
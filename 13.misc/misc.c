@@ -31,6 +31,7 @@
 #include <linux/input.h>
 #include <getopt.h>
 #include <pthread.h>
+#include <sys/epoll.h>
 #include <sys/sysinfo.h>
 
 //------------------------------------------------------------------------------
@@ -38,10 +39,31 @@
 #include "misc.h"
 
 //------------------------------------------------------------------------------
-static char spi_bt_path [STR_PATH_LENGTH] = { 0, };
-static char spi_pass_str[STR_NAME_LENGTH] = { 0, };
-
-static char hpdet_str [STR_NAME_LENGTH] = { 0, };
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+struct device_misc {
+    // eMISC_ID0 : SPI BT
+    char spi_bt_path [STR_PATH_LENGTH];
+    char spi_pass_str[STR_NAME_LENGTH];
+    volatile int BTPress, BTRelease;
+    // last button state (-1 = not read), sysfs_notify watch
+    int bt_state, watch_id0;
+
+    // eMISC_ID1 : HP DETECT
+    char hpdet_str [STR_NAME_LENGTH];
+    volatile int HPDetIn, HPDetOut;
+
+    // event node open (find_event : worker pool), event loop source
+    struct worker_future job_id1;
+    int hp_state, fd_id1, src_id1;
+};
+
+// default state of every dev_check_ctx
+static const struct device_misc DeviceMISC = {
+    { 0, }, { 0, }, 0, 0, -1, 0, { 0, }, 0, 0, { 0, }, 0, -1, 0
+};
 
 //------------------------------------------------------------------------------
 static void tolowerstr (char *p)
@@ -53,11 +75,15 @@ static void tolowerstr (char *p)
 }
 
 //------------------------------------------------------------------------------
+#define UDEVADM_TIMEOUT     2000    // ms
+
 static int find_event (const char *f_str)
 {
     FILE *fp;
-    char cmd  [STR_PATH_LENGTH];
-    int ev_num = 0;
+    struct subproc sp;
+    char cmd  [STR_PATH_LENGTH], node[STR_PATH_LENGTH];
+    char *argv[] = { "udevadm", "info", "-a", "-n", node, NULL };
+    int ev_num = 0, found = 0;
 
     /*
         find /dev/input -name event*        udevadm info -a -n /dev/input/event3 | grep 0705
@@ -65,206 +91,204 @@ static int find_event (const char *f_str)
     while (1) {
         memset  (cmd, 0, sizeof(cmd));
         sprintf (cmd, "/dev/input/event%d", ev_num);
-        if (access  (cmd, F_OK))    return -1;
+        if (dev_root_access (cmd, F_OK))    return -1;
+
+        // fake device tree : no udev database, match the input device name
+        if (dev_root_get () != NULL) {
+            sprintf (cmd, "/sys/class/input/event%d/device/name", ev_num);
+            if ((fp = dev_root_fopen (cmd, "r")) != NULL) {
+                memset (cmd, 0x00, sizeof(cmd));
+                fgets  (cmd, sizeof(cmd), fp);
+                fclose (fp);
+                if (strstr (cmd, f_str) != NULL)
+                    return ev_num;
+            }
+            ev_num++;
+            continue;
+        }
 
-        memset  (cmd, 0, sizeof(cmd));
-        sprintf (cmd, "udevadm info -a -n /dev/input/event%d | grep %s", ev_num, f_str);
-        if ((fp = popen(cmd, "r")) != NULL) {
-            memset (cmd, 0x00, sizeof(cmd));
-            while (fgets (cmd, sizeof(cmd), fp) != NULL) {
+        // udevadm info -a -n /dev/input/event{ev_num}
+        sprintf (node, "/dev/input/event%d", ev_num);
+        if (subproc_spawn (&sp, argv, SUBPROC_OUT, UDEVADM_TIMEOUT)) {
+            while (subproc_gets (&sp, cmd, sizeof(cmd)) != NULL) {
                 if (strstr (cmd, f_str) != NULL) {
-                    return ev_num;
-                    pclose (fp);
+                    found = 1;
+                    break;
                 }
             }
+            subproc_wait (&sp);
+            if (found)
+                return ev_num;
         }
         ev_num++;
     }
 }
 
 //------------------------------------------------------------------------------
-pthread_t thread_id0;   // SPI BT
-volatile int BTPress = 0, BTRelease = 0;
-
-void *thread_func_id0 (void *arg)
+// SPI BT (sysfs_notify callback). return 1 : press and release seen, stop.
+static int notify_func_id0 (void *arg, const char *value)
 {
-    FILE *fd;
-    int prev_state = -1, state = 0;
-    char rdata[STR_PATH_LENGTH];
-
-    while (1) {
-        if ((fd = fopen(spi_bt_path, "r")) == NULL) {
-            printf ("%s : %s error!\n", __func__, spi_bt_path);
-            return arg;
-        }
-
-        memset (rdata, 0, sizeof(rdata));
-        if (NULL != fgets (rdata, sizeof(rdata), fd)) {
-            tolowerstr (rdata);
-            if (NULL != strstr (rdata, spi_pass_str))   state = 0;
-            else                                        state = 1;
-
-            if (prev_state == -1)
-                prev_state = state;
-
-            if (prev_state != state) {
-                prev_state  = state;
-                if (state)  BTPress   = 1;
-                else        BTRelease = 1;
-            }
-        }
-        fclose (fd);
-        usleep (300 * 1000);
-
-        if (BTRelease && BTPress)   break;
+    struct device_misc *misc = (struct device_misc *)arg;
+    char rdata[SYSFS_NOTIFY_VALUE_MAX];
+    int state;
+
+    // missing attribute : the watch waits for it
+    if (!value[0])
+        return 0;
+
+    strncpy    (rdata, value, sizeof(rdata) -1);
+    rdata[sizeof(rdata) -1] = 0;
+    tolowerstr (rdata);
+    state = (strstr (rdata, misc->spi_pass_str) != NULL) ? 0 : 1;
+
+    if (misc->bt_state == -1)
+        misc->bt_state = state;
+
+    if (misc->bt_state != state) {
+        misc->bt_state  = state;
+        if (state)  misc->BTPress   = 1;
+        else        misc->BTRelease = 1;
     }
-    return arg;
+    return (misc->BTRelease && misc->BTPress);
 }
 
 //------------------------------------------------------------------------------
-pthread_t thread_id1;   // HP DETECT
-volatile int HPDetIn = 0, HPDetOut = 0;
-
-int test_bit(int bit, const unsigned long *array) {
+static int test_bit(int bit, const unsigned long *array) {
     return (array[bit / (8 * sizeof(unsigned long))] >> (bit % (8 * sizeof(unsigned long)))) & 1;
 }
 
-void *thread_func_id1 (void *arg)
+//------------------------------------------------------------------------------
+// HP DETECT : event loop callback (EPOLLIN)
+static void event_func_id1 (void *arg, int fd, unsigned int events)
 {
+    struct device_misc *misc = (struct device_misc *)arg;
     struct input_event event;
-    struct timeval  timeout;
-    fd_set readFds;
-    int fd = -1, prev_state;
-    char path[STR_PATH_LENGTH] = { 0, };
+    ssize_t n;
+
+    (void)events;
+    while ((n = read (fd, &event, sizeof(struct input_event))) == sizeof(struct input_event)) {
+        switch (event.type) {
+            case EV_SYN:
+                break;
+            case EV_SW:
+                switch (event.code) {
+                    case SW_HEADPHONE_INSERT:
+                        if (misc->hp_state != event.value) {
+                            misc->hp_state  = event.value;
+                            if (event.value)    misc->HPDetIn = 1;
+                            else                misc->HPDetOut = 1;
+                        }
 
-    // IR Device Name (meson-ir)
-    sprintf (path, "/dev/input/event%d", find_event (hpdet_str));
+                        DEV_LOG (eLOG_INFO, eGID_MISC, "%s : value = %d\n", __func__, event.value);
+                        break;
+                    case SW_MICROPHONE_INSERT:
+                    default :
+                        break;
+                }
+                break;
+            default :
+                DEV_LOG (eLOG_DEBUG, eGID_MISC, "unknown event\n");
+                break;
+        }
+    }
 
-    if ((fd = open(path, O_RDONLY)) < 0) {
-        printf ("%s : %s error!\n", __func__, path);
-        return arg;
+    // in and out seen, or the node is gone : stop watching (loop thread, no wait)
+    if ((misc->HPDetIn && misc->HPDetOut) || (n == 0)) {
+        event_loop_del (misc->src_id1);
+        close (fd);
+        misc->fd_id1 = -1;
     }
+}
 
-    {
-        unsigned long sw_bits[(SW_MAX / (8 * sizeof(unsigned long))) + 1];
+//------------------------------------------------------------------------------
+// HP DETECT : worker pool (find_event runs udevadm)
+static void open_job_id1 (void *arg)
+{
+    struct device_misc *misc = (struct device_misc *)arg;
+    unsigned long sw_bits[(SW_MAX / (8 * sizeof(unsigned long))) + 1];
+    char path[STR_PATH_LENGTH] = { 0, };
+    int fd;
 
-        memset(sw_bits, 0, sizeof(sw_bits));
+    // IR Device Name (meson-ir)
+    sprintf (path, "/dev/input/event%d", find_event (misc->hpdet_str));
 
-        // ioctl로 EV_SW 상태 읽기
-        if (ioctl(fd, EVIOCGSW(sizeof(sw_bits)), sw_bits) == -1) {
-            perror("EVIOCGSW failed");
-            close(fd);
-            return arg;
-        }
+    if ((fd = dev_root_open (path, O_RDONLY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        DEV_LOG (eLOG_ERR, eGID_MISC, "%s : %s error!\n", __func__, path);
+        return;
+    }
 
-        if (test_bit(SW_HEADPHONE_INSERT, sw_bits)) prev_state = 1;
-        else                                        prev_state = 0;;
+    memset(sw_bits, 0, sizeof(sw_bits));
 
-        /*
-        printf("현재 SW 상태:\n");
-        for (int i = 0; i <= SW_MAX; ++i) {
-            if (test_bit(i, sw_bits)) {
-                printf("  SW code %d (0x%02x): ON\n", i, i);
-            }
-        }
-        */
+    // ioctl로 EV_SW 상태 읽기
+    if (ioctl(fd, EVIOCGSW(sizeof(sw_bits)), sw_bits) == -1) {
+        perror("EVIOCGSW failed");
+        close(fd);
+        return;
     }
 
-    while (1) {
-        // recive time out config
-        // Set 1ms timeout counter
-        timeout.tv_sec  = 0;
-        // timeout.tv_usec = timeout_ms*1000;
-        timeout.tv_usec = 300000;
-
-        FD_ZERO(&readFds);
-        FD_SET(fd, &readFds);
-        select(fd+1, &readFds, NULL, NULL, &timeout);
-
-        if(FD_ISSET(fd, &readFds))
-        {
-            if(fd && read(fd, &event, sizeof(struct input_event))) {
-
-                switch (event.type) {
-                    case EV_SYN:
-                        break;
-                    case EV_SW:
-                        switch (event.code) {
-                            case SW_HEADPHONE_INSERT:
-                                if (prev_state != event.value) {
-                                    prev_state  = event.value;
-                                    if (event.value)    HPDetIn = 1;
-                                    else                HPDetOut = 1;
-                                }
-
-                                printf ("%s : value = %d\n", __func__, event.value);
-                                break;
-                            case SW_MICROPHONE_INSERT:
-                            default :
-                                break;
-                        }
-                        break;
-                    default :
-                        printf("unknown event\n");
-                        break;
-                }
-            }
-        }
-        if (HPDetIn && HPDetOut)    break;
+    if (test_bit(SW_HEADPHONE_INSERT, sw_bits)) misc->hp_state = 1;
+    else                                        misc->hp_state = 0;
+
+    misc->fd_id1 = fd;
+    if (!(misc->src_id1 = event_loop_add (fd, EPOLLIN, event_func_id1, misc))) {
+        close (fd);
+        misc->fd_id1 = -1;
     }
-    close (fd);
-    return arg;
 }
 
 //------------------------------------------------------------------------------
-int misc_check (int dev_id, char *resp)
+int misc_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_misc *misc = dev_check_ctx_data (ctx, eGID_MISC);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eMISC_ID0:
-            status = DEVICE_ACTION(dev_id) ? BTPress : BTRelease;
+            status = DEVICE_ACTION(dev_id) ? misc->BTPress : misc->BTRelease;
             value  = status;
             break;
 
         case eMISC_ID1:
-            status = DEVICE_ACTION(dev_id) ? HPDetIn : HPDetOut;
+            status = DEVICE_ACTION(dev_id) ? misc->HPDetIn : misc->HPDetOut;
             value  = status;
             break;
         default :
             break;
     }
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'C', value);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_MISC, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void misc_grp_init (char *cfg)
+void misc_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_misc *misc = dev_check_ctx_data (ctx, eGID_MISC);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eMISC_ID0:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (spi_bt_path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (misc->spi_bt_path, tok, strlen(tok));
 
-                    if ((tok = strtok (NULL, ",")) != NULL) {
-                        strncpy    (spi_pass_str, tok, strlen(tok));
-                        tolowerstr (spi_pass_str);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
+                        strncpy    (misc->spi_pass_str, tok, strlen(tok));
+                        tolowerstr (misc->spi_pass_str);
                     }
 
-                    pthread_create (&thread_id0, NULL, thread_func_id0, NULL);
+                    if (!misc->watch_id0)
+                        misc->watch_id0 = sysfs_notify_add (misc->spi_bt_path, notify_func_id0, misc);
                     break;
                 case eMISC_ID1:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (hpdet_str, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (misc->hpdet_str, tok, strlen(tok));
 
-                    pthread_create (&thread_id1, NULL, thread_func_id1, NULL);
+                    if (!misc->src_id1 && !worker_future_busy (&misc->job_id1))
+                        worker_future_submit (&misc->job_id1, open_job_id1, misc, 0);
                     break;
                 default :
                     break;
@@ -272,5 +296,37 @@ void misc_grp_init (char *cfg)
         }
     }
 }
+
+//------------------------------------------------------------------------------
+static int misc_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    char resp [DEVICE_RESP_SIZE+1];
+
+    memset (resp, 0, sizeof(resp));
+    pdata->status_i = misc_check (ctx, pdata->did, resp);
+    return pdata->status_i;
+}
+
+//------------------------------------------------------------------------------
+static void misc_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct device_misc *misc = dev_check_ctx_data (ctx, eGID_MISC);
+
+    sysfs_notify_del (misc->watch_id0);
+
+    worker_future_wait (&misc->job_id1);
+    event_loop_del (misc->src_id1);
+    if (misc->fd_id1 >= 0)
+        close (misc->fd_id1);
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupMISC = {
+    "MISC", eGID_MISC, eGID_MISC, sizeof(DeviceMISC), &DeviceMISC,
+    misc_grp_init, misc_check, misc_resp_check, misc_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupMISC);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
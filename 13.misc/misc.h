@@ -1,41 +1,43 @@
-//------------------------------------------------------------------------------
-/**
- * @file misc.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2025-08-01
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __MISC_H__
-#define __MISC_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device MISC for the ETC group.
-//------------------------------------------------------------------------------
-#define eMISC_CFG -1
-
-enum {
-    eMISC_ID0 = 0,  //SPI_BT = 0,
-    eMISC_ID1,      // HP DETECT
-    eMISC_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  misc_check      (int dev_id, char *resp);
-extern void misc_grp_init   (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __MISC_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file misc.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2025-08-01
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __MISC_H__
+#define __MISC_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device MISC for the ETC group.
+//------------------------------------------------------------------------------
+#define eMISC_CFG -1
+
+enum {
+    eMISC_ID0 = 0,  //SPI_BT = 0,
+    eMISC_ID1,      // HP DETECT
+    eMISC_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  misc_check      (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void misc_grp_init   (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __MISC_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
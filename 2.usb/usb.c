@@ -49,14 +49,8 @@ struct device_usb {
 
     // r/w mode
     int rw;
-
-    // r/w thread
-    int thread_en;
-    pthread_t thread;
 };
 
-pthread_mutex_t mutex_usb = PTHREAD_MUTEX_INITIALIZER;
-
 //------------------------------------------------------------------------------
 //
 // Configuration (ODROID-C5)
@@ -68,136 +62,159 @@ pthread_mutex_t mutex_usb = PTHREAD_MUTEX_INITIALIZER;
 //  | ETH |  | USB_L_DN |  | USB_R_DN |               | USB-OTG |
 //  -------  ------------  ------------               -----------
 //------------------------------------------------------------------------------
-struct device_usb DeviceUSB [eUSB_END] = {
-    // init, speed, path, rw_check, rw_value, rw_mode, thread_en, pthread,
+// default state of every dev_check_ctx
+static const struct device_usb DeviceUSB [eUSB_END] = {
+    // init, speed, path, rw_check, rw_value, rw_mode,
     // USB0-OTG
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // USB1 - USB_L_DN
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // USB2 - USB_L_UP
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // USB3 - USB_R_DN
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // USB4 - USB_R_UP
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
     // USB5
-    { 0, {0, }, {0, 0}, {0, 0}, 0, 0, 0} ,
+    { 0, {0, }, {0, 0}, {0, 0}, 0 } ,
 };
 
 //------------------------------------------------------------------------------
-// USB Read / Write (16 Mbytes, 1 block count)
+// USB Read / Write (16 Mbytes, 1 block count), dd {if} {of} ...
 //------------------------------------------------------------------------------
-const char *USB_R_CHECK = "dd of=/dev/null bs=16M count=1 iflag=nocache,dsync oflag=nocache,dsync if=/dev/";
-const char *USB_W_CHECK = "dd if=/dev/zero bs=16M count=1 iflag=nocache,dsync oflag=nocache,dsync of=/dev/";
+#define USB_DD_TIMEOUT      20000   // ms
+#define USB_FIND_TIMEOUT    2000    // ms
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 static int usb_speed (const char *path)
 {
-    FILE *fp;
-    char cmd[STR_PATH_LENGTH], rdata[STR_PATH_LENGTH];
-
-    if (access (path, R_OK) == 0) {
-        memset  (cmd, 0x00, sizeof(cmd));
-        sprintf (cmd, "%s/speed", path);
-        if ((fp = fopen (cmd, "r")) != NULL) {
-            memset (rdata, 0, sizeof(rdata));
-            fgets  (rdata, sizeof(rdata), fp);
-            fclose (fp);
-        }
-        return atoi (rdata);
-    }
-    return 0;
+    char cmd[STR_PATH_LENGTH + 8], rdata[16];
+
+    snprintf (cmd, sizeof(cmd), "%s/speed", path);
+    if (sysfs_attr_read (cmd, rdata, sizeof(rdata)) <= 0)
+        return 0;
+
+    return atoi (rdata);
+}
+
+//------------------------------------------------------------------------------
+static int usb_disk (const char *path, char *disk, int size)
+{
+    struct subproc sp;
+    char dir[PATH_MAX +1], rdata[PATH_MAX], *ptr;
+    char *argv[] = { "find", dir, "-name", "sd*", NULL };
+
+    snprintf (dir, sizeof(dir), "%s/", path);
+    if (!subproc_spawn (&sp, argv, SUBPROC_OUT, USB_FIND_TIMEOUT))
+        return 0;
+
+    memset (rdata, 0x00, sizeof(rdata));
+    // 1 line read
+    subproc_gets (&sp, rdata, sizeof(rdata));
+    subproc_wait (&sp);
+
+    // block device name (last path element "sd*")
+    ptr = strrchr (rdata, '/');
+    if ((ptr == NULL) || strncmp (++ptr, "sd", 2))
+        return 0;
+
+    ptr[strcspn (ptr, "\r\n")] = 0;
+    snprintf (disk, size, "/dev/%s", ptr);
+    return 1;
 }
 
 //------------------------------------------------------------------------------
 static int usb_rw (struct device_usb *p_usb)
 {
-    FILE *fp;
-    char cmd[STR_PATH_LENGTH*2], rdata[STR_PATH_LENGTH], *ptr;
-
-    if (!access (p_usb->path, F_OK)) {
-        memset  (cmd, 0x00, sizeof(cmd));
-        sprintf (cmd, "find %s/ -name sd* 2>&1", p_usb->path);
-
-        if ((fp = popen (cmd, "r")) != NULL) {
-            memset (rdata, 0x00, sizeof(rdata));
-            // 1 line read
-            fgets (rdata, sizeof(rdata), fp);
-            pclose (fp);
-
-            // find string "sd"
-            if ((ptr = strstr (rdata, "sd")) != NULL) {
-                memset  (cmd, 0, sizeof (cmd));
-                // 0x00 -> 0x20 (space)
-                ptr[strlen(ptr)-1] = ' ';
-                sprintf (cmd, "%s%s 2>&1",
-                    p_usb->rw ? USB_W_CHECK : USB_R_CHECK, ptr);
-
-                if ((fp = popen(cmd, "r")) != NULL) {
-                    while (1) {
-                        memset (rdata, 0, sizeof (rdata));
-                        if ((fgets (rdata, sizeof (rdata), fp)) == NULL)
-                            break;
-                        if ((ptr = strstr (rdata, " MB/s")) != NULL) {
-                            while (*ptr != ',') ptr--;
-                            pclose (fp);
-                            return atoi (ptr+1);
-                        }
-                    }
-                    pclose (fp);
-                }
-            }
-        }
+    struct subproc sp;
+    char rdata[PATH_MAX], *ptr, node[STR_PATH_LENGTH];
+    char dd_if[PATH_MAX +4], dd_of[PATH_MAX +4], buf[PATH_MAX];
+    const char *path = dev_root_path (p_usb->path, buf, sizeof(buf));
+    char *argv[] = { "dd", dd_if, dd_of, "bs=16M", "count=1",
+                     "iflag=nocache,dsync", "oflag=nocache,dsync", NULL };
+    int speed = 0;
+
+    if (access (path, F_OK))
+        return -1;
+
+    memset (node, 0, sizeof (node));
+    if (!usb_disk (path, node, sizeof(node)))
+        return 0;
+
+    path = dev_root_path (node, buf, sizeof(buf));
+    if (p_usb->rw) {
+        snprintf (dd_if, sizeof(dd_if), "if=/dev/zero");
+        snprintf (dd_of, sizeof(dd_of), "of=%s", path);
+    } else {
+        snprintf (dd_if, sizeof(dd_if), "if=%s", path);
+        snprintf (dd_of, sizeof(dd_of), "of=/dev/null");
+    }
+
+    if (!subproc_spawn (&sp, argv, SUBPROC_OUT, USB_DD_TIMEOUT))
         return 0;
+
+    while (subproc_gets (&sp, rdata, sizeof(rdata)) != NULL) {
+        if ((ptr = strstr (rdata, " MB/s")) != NULL) {
+            while (*ptr != ',') ptr--;
+            speed = atoi (ptr+1);
+            break;
+        }
+        // faster than 1GB/s (file backed fixture)
+        if ((ptr = strstr (rdata, " GB/s")) != NULL) {
+            while (*ptr != ',') ptr--;
+            speed = (int)(atof (ptr+1) * 1000);
+            break;
+        }
     }
-    return -1;
+    // dd failed or killed at the deadline
+    if (subproc_wait (&sp) != 0)
+        return 0;
+
+    return speed;
 }
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-void *thread_func_usb (void *arg)
+static void usb_rw_retry (struct device_usb *p_usb)
 {
-    struct device_usb *p_usb = (struct device_usb *)arg;
+    struct res_lock_set set;
     int retry = 5;
 
-    p_usb->thread_en = 1;
-    while (retry--) {
-        pthread_mutex_lock(&mutex_usb);
+    // dd speed : the ports share the hub bandwidth
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "usb_hub");
 
-        if (p_usb->rw_value[p_usb->rw] <= p_usb->rw_check[p_usb->rw])
-            p_usb->rw_value[p_usb->rw] = usb_rw (p_usb);
+    while (retry--) {
+        if (res_lock_acquire (&set, USB_DD_TIMEOUT)) {
+            if (p_usb->rw_value[p_usb->rw] <= p_usb->rw_check[p_usb->rw])
+                p_usb->rw_value[p_usb->rw] = usb_rw (p_usb);
 
-        pthread_mutex_unlock(&mutex_usb);
+            res_lock_release (&set);
+        }
 
         if (p_usb->rw_value[p_usb->rw] > p_usb->rw_check[p_usb->rw])
             break;
 
         usleep (100 * 1000);
     }
-    p_usb->thread_en = 0;
-    return arg;
 }
 
 //------------------------------------------------------------------------------
-int usb_check (int dev_id, char *resp)
+int usb_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_usb *usb = dev_check_ctx_data (ctx, eGID_USB);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
-    struct device_usb *p_usb = &DeviceUSB[id];
+    struct device_usb *p_usb = &usb[id];
 
     switch (id) {
         case eUSB_0: case eUSB_1: case eUSB_2:
         case eUSB_3: case eUSB_4: case eUSB_5:
 
             if ((DEVICE_ACTION(dev_id) == 0) || (DEVICE_ACTION(dev_id) == 1)) {
-                do { usleep (100 * 1000); } while (p_usb->thread_en);
-
+                // the lane lock (device_check) keeps the checks of a port apart
                 p_usb->rw = DEVICE_ACTION(dev_id);
-
-                pthread_create (&p_usb->thread, NULL,
-                                    thread_func_usb, p_usb);
-
-                do { usleep (100 * 1000); } while (p_usb->thread_en);
+                usb_rw_retry (p_usb);
 
                 value  = p_usb->rw_value[p_usb->rw];
                 status = (value > p_usb->rw_check[p_usb->rw]) ? 1 : -1;
@@ -210,33 +227,34 @@ int usb_check (int dev_id, char *resp)
             break;
     }
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'F', value);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_USB, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void usb_grp_init (char *cfg)
+void usb_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_usb *usb = dev_check_ctx_data (ctx, eGID_USB);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eUSB_0: case eUSB_1: case eUSB_2:
                 case eUSB_3: case eUSB_4: case eUSB_5:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceUSB[did].path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (usb[did].path, tok, strlen(tok));
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceUSB[did].rw_check[0] = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        usb[did].rw_check[0] = atoi(tok);
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceUSB[did].rw_check[1] = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        usb[did].rw_check[1] = atoi(tok);
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceUSB[did].speed = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        usb[did].speed = atoi(tok);
                     break;
 
                 default :
@@ -247,5 +265,13 @@ void usb_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static const struct dev_group GroupUSB = {
+    "USB", eGID_USB, eGID_STORAGE, sizeof(DeviceUSB), DeviceUSB,
+    usb_grp_init, usb_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupUSB);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,44 +1,46 @@
-//------------------------------------------------------------------------------
-/**
- * @file usb.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-20
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __USB_H__
-#define __USB_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the USB group.
-//------------------------------------------------------------------------------
-// ODROID-M1S USB Port define
-enum {
-    eUSB_0,
-    eUSB_1,
-    eUSB_2,
-    eUSB_3,
-    eUSB_4,
-    eUSB_5,
-    eUSB_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  usb_check       (int dev_id, char *resp);
-extern void usb_grp_init    (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __USB_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file usb.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-20
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __USB_H__
+#define __USB_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the USB group.
+//------------------------------------------------------------------------------
+// ODROID-M1S USB Port define
+enum {
+    eUSB_0,
+    eUSB_1,
+    eUSB_2,
+    eUSB_3,
+    eUSB_4,
+    eUSB_5,
+    eUSB_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  usb_check       (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void usb_grp_init    (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __USB_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
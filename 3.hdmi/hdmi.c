@@ -44,6 +44,8 @@ struct device_hdmi {
     char pass_str[STR_PATH_LENGTH +1];
     // edid value str
     int is_str;
+    // HPD : sysfs_notify watch (cache invalidate on change)
+    int watch;
 };
 
 //------------------------------------------------------------------------------
@@ -55,35 +57,40 @@ struct device_hdmi {
 //------------------------------------------------------------------------------
 #define HDMI_READ_BYTES 16
 
-struct device_hdmi DeviceHDMI [eHDMI_END] = {
+// default state of every dev_check_ctx
+static const struct device_hdmi DeviceHDMI [eHDMI_END] = {
     // EDID
-    {{0,},{0,},0},
-    {{0,},{0,},0},
+    {{0,},{0,},0,0},
+    {{0,},{0,},0,0},
 };
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 static int hdmi_read (const char *path, char *rdata)
 {
-    FILE *fp;
+    // edid / hpd value get (rdata : HDMI_READ_BYTES +1)
+    return (sysfs_attr_read (path, rdata, HDMI_READ_BYTES +1) >= 0);
+}
 
-    // led value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fread (rdata, 1, HDMI_READ_BYTES, fp);
-        fclose(fp);
-        return 1;
-    }
+//------------------------------------------------------------------------------
+// hot plug : the cached EDID / HPD results of this context are stale
+static int hpd_notify (void *arg, const char *value)
+{
+    struct dev_check_ctx *ctx = (struct dev_check_ctx *)arg;
+
+    check_cache_invalidate (ctx, eGID_HDMI, -1);
+    DEV_LOG (eLOG_INFO, eGID_HDMI, "%s : hpd_state = %s\n", __func__, value);
     return 0;
 }
 
 //------------------------------------------------------------------------------
-static int data_check (int id, const char *rdata)
+static int data_check (struct device_hdmi *p_hdmi, const char *rdata)
 {
     char buf[HDMI_READ_BYTES+1];
 
     memset  (buf, 0, sizeof(buf));
 
-    if (DeviceHDMI[id].is_str)
+    if (p_hdmi->is_str)
         sprintf (buf, "%s", rdata);
     else
         sprintf (buf, "%02x%02x%02x%02x%02x%02x%02x%02x",
@@ -91,21 +98,23 @@ static int data_check (int id, const char *rdata)
             rdata [4], rdata [5], rdata [6], rdata [7]
         );
 
-    if (!strncmp (buf, DeviceHDMI[id].pass_str, strlen (DeviceHDMI[id].pass_str)))
+    if (!strncmp (buf, p_hdmi->pass_str, strlen (p_hdmi->pass_str)))
         return 1;
 
     return 0;
 }
 
 //------------------------------------------------------------------------------
-int hdmi_check (int dev_id, char *resp)
+int hdmi_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_hdmi *hdmi = dev_check_ctx_data (ctx, eGID_HDMI);
     int status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eHDMI_EDID: case eHDMI_HPD:
-            if (hdmi_read (DeviceHDMI[id].path, resp))
-                status = data_check (id, resp);
+            // live read : the watch value may be a poll period old (plug test)
+            if (hdmi_read (hdmi[id].path, resp))
+                status = data_check (&hdmi[id], resp);
             else
                 status = -1;
             break;
@@ -117,27 +126,30 @@ int hdmi_check (int dev_id, char *resp)
     else
         DEVICE_RESP_FORM_STR (resp, 'F', "FAIL");
 
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_HDMI, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void hdmi_grp_init (char *cfg)
+void hdmi_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_hdmi *hdmi = dev_check_ctx_data (ctx, eGID_HDMI);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eHDMI_EDID: case eHDMI_HPD:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceHDMI[did].path, tok, strlen(tok));
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceHDMI[did].pass_str, tok, strlen(tok));
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceHDMI[did].is_str = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (hdmi[did].path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (hdmi[did].pass_str, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        hdmi[did].is_str = atoi(tok);
+                    if ((did == eHDMI_HPD) && !hdmi[did].watch)
+                        hdmi[did].watch = sysfs_notify_add (hdmi[did].path, hpd_notify, ctx);
                     break;
                 default :
                     printf ("%s : error! unknown did = %d\n", __func__, did);
@@ -147,5 +159,22 @@ void hdmi_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static void hdmi_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct device_hdmi *hdmi = dev_check_ctx_data (ctx, eGID_HDMI);
+
+    // the callback uses the context
+    sysfs_notify_del (hdmi[eHDMI_HPD].watch);
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupHDMI = {
+    "HDMI", eGID_HDMI, eGID_HDMI, sizeof(DeviceHDMI), DeviceHDMI,
+    hdmi_grp_init, hdmi_check, NULL, hdmi_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupHDMI);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
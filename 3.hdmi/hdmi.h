@@ -1,39 +1,41 @@
-//------------------------------------------------------------------------------
-/**
- * @file hdmi.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-20
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __HDMI_H__
-#define __HDMI_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the HDMI group.
-//------------------------------------------------------------------------------
-enum {
-    eHDMI_EDID,
-    eHDMI_HPD,
-    eHDMI_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  hdmi_check      (int dev_id, char *resp);
-extern void hdmi_grp_init   (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __HDMI_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file hdmi.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-20
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __HDMI_H__
+#define __HDMI_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the HDMI group.
+//------------------------------------------------------------------------------
+enum {
+    eHDMI_EDID,
+    eHDMI_HPD,
+    eHDMI_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  hdmi_check      (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void hdmi_grp_init   (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __HDMI_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -44,6 +44,13 @@ struct device_adc {
     int max, min;
 };
 
+// group state (one per dev_check_ctx)
+struct adc_grp {
+    struct device_adc adc[eADC_END];
+    // eADC_CFG : reference voltage (mV), resolution
+    int reference, resolution;
+};
+
 //------------------------------------------------------------------------------
 //
 // Configuration
@@ -51,49 +58,46 @@ struct device_adc {
 //------------------------------------------------------------------------------
 /* define adc devices */
 //------------------------------------------------------------------------------
-struct device_adc DeviceADC [eADC_END] = {
-    // eADC_H37 (Header 37) - const 1.358V
-    { {0, }, 0, 0 },
-    // eADC_H40 (Header 40) - const 0.441V
-    { {0, }, 0, 0 },
+// default state of every dev_check_ctx
+static const struct adc_grp DeviceADC = {
+    {
+        // eADC_H37 (Header 37) - const 1.358V
+        { {0, }, 0, 0 },
+        // eADC_H40 (Header 40) - const 0.441V
+        { {0, }, 0, 0 },
+    },
+    0, 0
 };
 
-int ResolutionADC = 0, ReferenceADC = 0;
-
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 // default adc range (mV). ADC res 1.7578125mV (1800mV / ADC RESOLUTION)
 // adc voltage = adc raw read * ADC res (1.75)
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-static int adc_read (const char *path)
+static int adc_read (struct adc_grp *grp, const char *path)
 {
     char rdata[16];
-    FILE *fp;
-
-    memset (rdata, 0, sizeof (rdata));
 
     // adc raw value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fgets (rdata, sizeof(rdata), fp);
-        fclose(fp);
-    }
+    sysfs_attr_read (path, rdata, sizeof(rdata));
 
-    if (ReferenceADC && ResolutionADC)
-        return (atoi (rdata) * ReferenceADC) / ResolutionADC;
+    if (grp->reference && grp->resolution)
+        return (atoi (rdata) * grp->reference) / grp->resolution;
 
     return (atoi (rdata));
 }
 
 //------------------------------------------------------------------------------
-int adc_check (int dev_id, char *resp)
+int adc_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct adc_grp *grp = dev_check_ctx_data (ctx, eGID_ADC);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eADC_H37: case eADC_H40:
-            value = adc_read (DeviceADC[id].path);
-            if ((value < DeviceADC[id].max) && (value > DeviceADC[id].min))
+            value = adc_read (grp, grp->adc[id].path);
+            if ((value < grp->adc[id].max) && (value > grp->adc[id].min))
                 status = 1;
             else
                 status = -1;
@@ -102,39 +106,40 @@ int adc_check (int dev_id, char *resp)
             break;
     }
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'F', value);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_ADC, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void adc_grp_init (char *cfg)
+void adc_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct adc_grp *grp = dev_check_ctx_data (ctx, eGID_ADC);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eADC_H37: case eADC_H40:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceADC[did].path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (grp->adc[did].path, tok, strlen(tok));
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceADC[did].max = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->adc[did].max = atoi(tok);
 
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceADC[did].min = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->adc[did].min = atoi(tok);
                     break;
 
                 case eADC_CFG: /* ADC config */
                     // Reference voltage(mV)
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        ReferenceADC = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->reference = atoi(tok);
 
                     // Resolution ADC bits
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        ResolutionADC = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->resolution = atoi(tok);
                     break;
                 default :
                     printf ("%s : error! unknown did = %d\n", __func__, did);
@@ -144,5 +149,13 @@ void adc_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static const struct dev_group GroupADC = {
+    "ADC", eGID_ADC, eGID_ADC, sizeof(struct adc_grp), &DeviceADC,
+    adc_grp_init, adc_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupADC);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,45 +1,47 @@
-//------------------------------------------------------------------------------
-/**
- * @file adc.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-20
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __ADC_H__
-#define __ADC_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the ADC group.
-//------------------------------------------------------------------------------
-// ADC Config
-#define eADC_CFG    9
-
-enum {
-    // Header 37 ADC
-    eADC_H37,
-    // Header 40 ADC
-    eADC_H40,
-
-    eADC_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  adc_check       (int dev_id, char *resp);
-extern void adc_grp_init    (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __ADC_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file adc.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-20
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __ADC_H__
+#define __ADC_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the ADC group.
+//------------------------------------------------------------------------------
+// ADC Config
+#define eADC_CFG    9
+
+enum {
+    // Header 37 ADC
+    eADC_H37,
+    // Header 40 ADC
+    eADC_H40,
+
+    eADC_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  adc_check       (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void adc_grp_init    (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __ADC_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
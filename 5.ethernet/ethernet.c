@@ -76,116 +76,162 @@ struct device_ethernet {
     int  board_mac_validate;
     char board_mac_str[20];
     char board_mac[MAC_STR_SIZE +1];
+    // eFuse uuid (board identity, result journal)
+    char board_uuid[EFUSE_UUID_SIZE +1];
 
     int link_speed;
     int iperf_speed_s;
     int iperf_speed_c;
     int iperf_check_speed;
+
+    // iperf3 server job (worker pool), iperf3 process (thread_iperf_stop)
+    struct worker_future iperf3_job;
+    struct subproc iperf3;
 };
 
+// ping, nmap scan, ethtool speed change
+#define PING_TIMEOUT        3000    // ms
+#define NMAP_TIMEOUT        30000   // ms
+#define ETHTOOL_TIMEOUT     5000    // ms
+// link up with the new speed
+#define LINK_SETUP_TIMEOUT  10000   // ms
+// iperf3 server stop : kill again until the job ends
+#define IPERF_STOP_WAIT     100     // ms
+
 //------------------------------------------------------------------------------
 //
 // Configuration
 //
 //------------------------------------------------------------------------------
-struct device_ethernet DeviceETHERNET = {
-    {0, }, {0, }, {0, }, {0, }, 0, {0, }, 0, {0, }, {0, }, 0, 0, 0, 0
+// default state of every dev_check_ctx
+static const struct device_ethernet DeviceETHERNET = {
+    {0, }, {0, }, {0, }, {0, }, 0, {0, }, 0, {0, }, {0, }, {0, }, 0, 0, 0, 0, { 0, },
+    { 0, -1, 0, 0, 0, { 0, } }
 };
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 static int net_status (char *ip_addr)
 {
-    char cmd_line[STR_PATH_LENGTH];
-    FILE *fp;
+    struct subproc sp;
+    char cmd_line[STR_PATH_LENGTH], ip[sizeof(struct sockaddr)+1];
+    char *argv[] = { "ping", "-c", "1", "-w", "1", ip, NULL };
+    int alive = 0;
 
-    memset  (cmd_line, 0x00, sizeof(cmd_line));
-    sprintf (cmd_line, "ping -c 1 -w 1 %s", ip_addr);
+    // ip_addr : rest of a nmap output line
+    memset  (ip, 0x00, sizeof(ip));
+    strncpy (ip, ip_addr, sizeof(ip) -1);
+    ip[strspn (ip, "0123456789.")] = 0;
 
-    if ((fp = popen(cmd_line, "r")) != NULL) {
+    if (subproc_spawn (&sp, argv, SUBPROC_OUT, PING_TIMEOUT)) {
         memset (cmd_line, 0x00, sizeof(cmd_line));
-        while (fgets(cmd_line, STR_PATH_LENGTH, fp)) {
+        while (subproc_gets (&sp, cmd_line, sizeof(cmd_line)) != NULL) {
             if (NULL != strstr(cmd_line, "1 received")) {
-                pclose(fp);
-                printf ("%s : alive %s\n", __func__, ip_addr);
-                return 1;
+                alive = 1;
+                break;
             }
         }
-        pclose(fp);
+        subproc_wait (&sp);
     }
-    printf ("%s : dead %s\n", __func__, ip_addr);
-    return 0;
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : %s %s\n", __func__, alive ? "alive" : "dead", ip);
+    return alive;
 }
 
 //------------------------------------------------------------------------------
 static void ip_str_to_int (char *ip_str, int *ip_int)
 {
-    char *tok;
+    char *tok, *save;
 
-    tok = strtok(ip_str, ".");  if (tok != NULL)    ip_int [0] = atoi(tok);
-    tok = strtok(NULL  , ".");  if (tok != NULL)    ip_int [1] = atoi(tok);
-    tok = strtok(NULL  , ".");  if (tok != NULL)    ip_int [2] = atoi(tok);
-    tok = strtok(NULL  , ".");  if (tok != NULL)    ip_int [3] = atoi(tok);
+    tok = strtok_r(ip_str, ".", &save);  if (tok != NULL)    ip_int [0] = atoi(tok);
+    tok = strtok_r(NULL  , ".", &save);  if (tok != NULL)    ip_int [1] = atoi(tok);
+    tok = strtok_r(NULL  , ".", &save);  if (tok != NULL)    ip_int [2] = atoi(tok);
+    tok = strtok_r(NULL  , ".", &save);  if (tok != NULL)    ip_int [3] = atoi(tok);
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_board_ip (void)
+static int ethernet_board_ip (struct device_ethernet *eth)
 {
     int fd, retry_cnt = 100;
     struct ifreq ifr;
     char ip_addr[sizeof(struct sockaddr)+1];
 
-    if (DeviceETHERNET.board_ip_int[0] != 0)    return 1;
+    if (eth->board_ip_int[0] != 0)    return 1;
 retry:
     usleep (100 * 1000);    // 500ms delay
     /* this entire function is almost copied from ethtool source code */
     /* Open control socket. */
     if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
     {
-        fprintf (stdout, "Cannot get control socket\n");
+        DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : cannot get control socket (retry %d)\n", __func__, retry_cnt);
         if (retry_cnt--)    goto retry;
         return 0;
     }
     strncpy(ifr.ifr_name, "eth0", IFNAMSIZ);
     if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) {
-        fprintf (stdout, "SIOCGIFADDR ioctl Error!!\n");
+        DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : SIOCGIFADDR ioctl error (retry %d)\n", __func__, retry_cnt);
         close(fd);
         if (retry_cnt--)    goto retry;
         return 0;
     }
     memset (ip_addr, 0x00, sizeof(ip_addr));
     inet_ntop(AF_INET, ifr.ifr_addr.sa_data+2, ip_addr, sizeof(struct sockaddr));
-    printf ("%s : ip_address = %s\n", __func__, ip_addr);
-
-    ip_str_to_int (ip_addr, DeviceETHERNET.board_ip_int);
-    memset  (DeviceETHERNET.board_ip_str, 0, sizeof(DeviceETHERNET.board_ip_str));
-    sprintf (DeviceETHERNET.board_ip_str, "%d.%d.%d.%d",
-                DeviceETHERNET.board_ip_int[0],
-                DeviceETHERNET.board_ip_int[1],
-                DeviceETHERNET.board_ip_int[2],
-                DeviceETHERNET.board_ip_int[3]);
+    DEV_LOG (eLOG_INFO, eGID_ETHERNET, "%s : ip_address = %s\n", __func__, ip_addr);
+
+    ip_str_to_int (ip_addr, eth->board_ip_int);
+    memset  (eth->board_ip_str, 0, sizeof(eth->board_ip_str));
+    sprintf (eth->board_ip_str, "%d.%d.%d.%d",
+                eth->board_ip_int[0],
+                eth->board_ip_int[1],
+                eth->board_ip_int[2],
+                eth->board_ip_int[3]);
     return 1;
 }
 
+//------------------------------------------------------------------------------
+// default context
 //------------------------------------------------------------------------------
 char *get_board_ip (void)
 {
-    if (ethernet_board_ip())
-        return DeviceETHERNET.board_ip_str;
+    struct device_ethernet *eth = dev_check_ctx_data (dev_check_ctx_default (), eGID_ETHERNET);
+
+    if (ethernet_board_ip(eth))
+        return eth->board_ip_str;
     return NULL;
 }
 
 char *get_mac_addr (void)
 {
-    if (DeviceETHERNET.board_mac_validate)
-        return DeviceETHERNET.board_mac_str;
+    return get_mac_addr_ctx (dev_check_ctx_default ());
+}
+
+//------------------------------------------------------------------------------
+// board identity of a context (result journal), NULL : eFuse not read / blank
+//------------------------------------------------------------------------------
+char *get_mac_addr_ctx (struct dev_check_ctx *ctx)
+{
+    struct device_ethernet *eth = dev_check_ctx_data (ctx, eGID_ETHERNET);
+
+    if (eth->board_mac_validate)
+        return eth->board_mac_str;
+
+    return NULL;
+}
+
+char *get_efuse_uuid_ctx (struct dev_check_ctx *ctx)
+{
+    struct device_ethernet *eth = dev_check_ctx_data (ctx, eGID_ETHERNET);
+
+    if (eth->board_mac_validate)
+        return eth->board_uuid;
 
     return NULL;
 }
 
 int get_ethernet_iperf (void)
 {
-    return (DeviceETHERNET.iperf_speed_s && DeviceETHERNET.iperf_speed_c) ? 1 : 0;
+    struct device_ethernet *eth = dev_check_ctx_data (dev_check_ctx_default (), eGID_ETHERNET);
+
+    return (eth->iperf_speed_s && eth->iperf_speed_c) ? 1 : 0;
 }
 
 //------------------------------------------------------------------------------
@@ -199,14 +245,14 @@ static int ethernet_board_ip_file (void)
         memset (ip_addr, 0x00, sizeof(ip_addr));
         if (fgets(ip_addr, sizeof(struct sockaddr), fp) != NULL) {
             printf ("%s : IP Address = %s\n", __func__, ip_addr);
-            ip_str_to_int (ip_addr, DeviceETHERNET.board_ip_int);
+            ip_str_to_int (ip_addr, eth->board_ip_int);
             pclose(fp);
-            memset  (DeviceETHERNET.board_ip_str, 0, sizeof(DeviceETHERNET.board_ip_str));
-            sprintf(DeviceETHERNET.board_ip_str, "%d.%d.%d.%d",
-                DeviceETHERNET.board_ip_int[0],
-                DeviceETHERNET.board_ip_int[1],
-                DeviceETHERNET.board_ip_int[2],
-                DeviceETHERNET.board_ip_int[3]);
+            memset  (eth->board_ip_str, 0, sizeof(eth->board_ip_str));
+            sprintf(eth->board_ip_str, "%d.%d.%d.%d",
+                eth->board_ip_int[0],
+                eth->board_ip_int[1],
+                eth->board_ip_int[2],
+                eth->board_ip_int[3]);
             return 1;
         }
         pclose(fp);
@@ -215,51 +261,52 @@ static int ethernet_board_ip_file (void)
 }
 #endif
 //------------------------------------------------------------------------------
-static int ethernet_server_ip (void)
+static int ethernet_server_ip (struct device_ethernet *eth)
 {
-    FILE *fp;
-    char cmd_line[STR_PATH_LENGTH], *ip_tok;
+    struct subproc sp;
+    char cmd_line[STR_PATH_LENGTH], *ip_tok, subnet[STR_NAME_LENGTH], port[STR_NAME_LENGTH];
+    char *argv[] = { "nmap", subnet, "-p", port, "-T5", "--open", NULL };
+    int found = 0;
 
-    if (DeviceETHERNET.server_ip_int[0] != 0)   return 1;
+    if (eth->server_ip_int[0] != 0)   return 1;
 
-    memset(cmd_line, 0, sizeof(cmd_line));
-    sprintf(cmd_line, "nmap %d.%d.%d.* -p T:%4d -T5 --open 2<&1",
-        DeviceETHERNET.board_ip_int[0],
-        DeviceETHERNET.board_ip_int[1],
-        DeviceETHERNET.board_ip_int[2],
-        DeviceETHERNET.server_port);
+    snprintf (subnet, sizeof(subnet), "%d.%d.%d.*",
+        eth->board_ip_int[0],
+        eth->board_ip_int[1],
+        eth->board_ip_int[2]);
+    snprintf (port, sizeof(port), "T:%d", eth->server_port);
 
-    if ((fp = popen(cmd_line, "r")) != NULL) {
+    if (subproc_spawn (&sp, argv, SUBPROC_OUT, NMAP_TIMEOUT)) {
         memset(cmd_line, 0, sizeof(cmd_line));
-        while (fgets(cmd_line, sizeof(cmd_line), fp)) {
+        while (subproc_gets (&sp, cmd_line, sizeof(cmd_line)) != NULL) {
             char ip[10];
             memset  (ip, 0, sizeof(ip));
-            sprintf (ip, "%d.%d.", DeviceETHERNET.board_ip_int[0], DeviceETHERNET.board_ip_int[1]);
+            sprintf (ip, "%d.%d.", eth->board_ip_int[0], eth->board_ip_int[1]);
             ip_tok = strstr(cmd_line, ip);
             if (ip_tok != NULL) {
-                printf ("%s : %s\n", __func__, ip_tok);
+                DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : %s\n", __func__, ip_tok);
                 if (net_status (ip_tok)) {
-                    ip_str_to_int (ip_tok, DeviceETHERNET.server_ip_int);
+                    ip_str_to_int (ip_tok, eth->server_ip_int);
 
                     // ip_addr arrary size = 20 bytes
-                    memset (DeviceETHERNET.server_ip_str, 0, sizeof (DeviceETHERNET.server_ip_str));
-                    sprintf(DeviceETHERNET.server_ip_str, "%d.%d.%d.%d",
-                                                DeviceETHERNET.server_ip_int[0],
-                                                DeviceETHERNET.server_ip_int[1],
-                                                DeviceETHERNET.server_ip_int[2],
-                                                DeviceETHERNET.server_ip_int[3]);
-                    pclose(fp);
-                    return 1;
+                    memset (eth->server_ip_str, 0, sizeof (eth->server_ip_str));
+                    sprintf(eth->server_ip_str, "%d.%d.%d.%d",
+                                                eth->server_ip_int[0],
+                                                eth->server_ip_int[1],
+                                                eth->server_ip_int[2],
+                                                eth->server_ip_int[3]);
+                    found = 1;
+                    break;
                 }
             }
         }
+        subproc_wait (&sp);
     }
-    pclose(fp);
-    return 0;
+    return found;
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_mac_write (const char *model)
+static int ethernet_mac_write (struct device_ethernet *eth, const char *model)
 {
     char efuse [EFUSE_UUID_SIZE];
 
@@ -270,8 +317,8 @@ static int ethernet_mac_write (const char *model)
             memset (efuse, 0, sizeof(efuse));
             if (efuse_control (efuse, EFUSE_READ)) {
                 if (efuse_valid_check (efuse)) {
-                    memset (DeviceETHERNET.board_mac, 0, sizeof(DeviceETHERNET.board_mac));
-                    efuse_get_mac (efuse, DeviceETHERNET.board_mac);
+                    memset (eth->board_mac, 0, sizeof(eth->board_mac));
+                    efuse_get_mac (efuse, eth->board_mac);
                     return 1;
                 }
             }
@@ -281,148 +328,172 @@ static int ethernet_mac_write (const char *model)
     return 0;
 }
 //------------------------------------------------------------------------------
-static void ethernet_efuse_check (void)
+// read only : mac / uuid (board identity). return : 1 = valid mac
+//------------------------------------------------------------------------------
+static int ethernet_efuse_read (struct device_ethernet *eth)
 {
     char efuse [EFUSE_UUID_SIZE];
 
     memset (efuse, 0, sizeof (efuse));
 
-    efuse_set_board_str (DeviceETHERNET.efuse_board_name);
+    efuse_set_board_str (eth->efuse_board_name);
 
-    // mac status & value
-    if (efuse_control (efuse, EFUSE_READ)) {
-        DeviceETHERNET.board_mac_validate = efuse_valid_check (efuse);
-        if (!DeviceETHERNET.board_mac_validate) {
-            if (ethernet_mac_write (DeviceETHERNET.efuse_board_name)) {
-                memset (efuse, 0, sizeof (efuse));
-                efuse_control (efuse, EFUSE_READ);
-                DeviceETHERNET.board_mac_validate = efuse_valid_check (efuse);
-            }
-        }
+    if (!efuse_control (efuse, EFUSE_READ))
+        return 0;
 
-        efuse_get_mac (efuse, DeviceETHERNET.board_mac);
-        sprintf (DeviceETHERNET.board_mac_str, "%c%c:%c%c:%c%c:%c%c:%c%c:%c%c",
-            DeviceETHERNET.board_mac[0], DeviceETHERNET.board_mac[1],
-            DeviceETHERNET.board_mac[2], DeviceETHERNET.board_mac[3],
-            DeviceETHERNET.board_mac[4], DeviceETHERNET.board_mac[5],
-            DeviceETHERNET.board_mac[6], DeviceETHERNET.board_mac[7],
-            DeviceETHERNET.board_mac[8], DeviceETHERNET.board_mac[9],
-            DeviceETHERNET.board_mac[10], DeviceETHERNET.board_mac[11]);
-
-        if (DeviceETHERNET.board_mac_validate)
-            printf ("%s : mac address = %s\n", __func__, DeviceETHERNET.board_mac_str);
-        else
-            printf ("%s : ethernet mac write error! (%s)\n", __func__, DeviceETHERNET.efuse_board_name);
+    efuse_get_mac (efuse, eth->board_mac);
+    memcpy (eth->board_uuid, efuse, EFUSE_UUID_SIZE);
+    sprintf (eth->board_mac_str, "%c%c:%c%c:%c%c:%c%c:%c%c:%c%c",
+        eth->board_mac[0], eth->board_mac[1],
+        eth->board_mac[2], eth->board_mac[3],
+        eth->board_mac[4], eth->board_mac[5],
+        eth->board_mac[6], eth->board_mac[7],
+        eth->board_mac[8], eth->board_mac[9],
+        eth->board_mac[10], eth->board_mac[11]);
+
+    // last : get_mac_addr / get_efuse_uuid of other threads
+    eth->board_mac_validate = efuse_valid_check (efuse);
+    return eth->board_mac_validate;
+}
+
+//------------------------------------------------------------------------------
+static void ethernet_efuse_check (struct device_ethernet *eth)
+{
+    // mac status & value
+    if (!ethernet_efuse_read (eth)) {
+        if (ethernet_mac_write (eth, eth->efuse_board_name))
+            ethernet_efuse_read (eth);
     }
+
+    if (eth->board_mac_validate)
+        DEV_LOG (eLOG_INFO, eGID_ETHERNET, "%s : mac address = %s\n", __func__, eth->board_mac_str);
+    else
+        DEV_LOG (eLOG_ERR, eGID_ETHERNET, "%s : ethernet mac write error! (%s)\n", __func__, eth->efuse_board_name);
 }
 
 //------------------------------------------------------------------------------
 static int ethernet_link_speed (void)
 {
-    FILE *fp;
-    char cmd_line[STR_PATH_LENGTH];
+    char rdata[16];
 
-    if (access ("/sys/class/net/eth0/speed", F_OK) != 0)
+    // link down : read error (EINVAL)
+    if (sysfs_attr_read ("/sys/class/net/eth0/speed", rdata, sizeof(rdata)) <= 0)
         return 0;
 
-    memset (cmd_line, 0x00, sizeof(cmd_line));
-    if ((fp = fopen ("/sys/class/net/eth0/speed", "r")) != NULL) {
-        memset (cmd_line, 0x00, sizeof(cmd_line));
-        if (NULL != fgets (cmd_line, sizeof(cmd_line), fp)) {
-            fclose (fp);
-            return atoi (cmd_line);
-        }
-    }
-    return 0;
+    return atoi (rdata);
 }
 
 //------------------------------------------------------------------------------
 static int ethernet_link_setup (int speed)
 {
-    FILE *fp;
-    char cmd_line[STR_PATH_LENGTH], retry = 10;
+    char speed_str[16];
+    char *argv[] = { "ethtool", "-s", "eth0", "speed", speed_str, "duplex", "full", NULL };
+    struct res_lock_set set;
+    int ret = 1;
+
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "eth0");
+    if (!res_lock_acquire (&set, LINK_SETUP_TIMEOUT))
+        return 0;
 
     if (ethernet_link_speed () != speed) {
-        memset (cmd_line, 0x00, sizeof(cmd_line));
-        sprintf(cmd_line,"ethtool -s eth0 speed %d duplex full && sync", speed);
-        if ((fp = popen(cmd_line, "w")) != NULL)
-            pclose(fp);
+        snprintf (speed_str, sizeof(speed_str), "%d", speed);
+        if (subproc_run (argv, ETHTOOL_TIMEOUT) == 0)
+            sync ();
 
-        // timeout 10 sec
-        while (retry--) {
-            sleep (1);
-            if (ethernet_link_speed() == speed)
-                return 1;
-        }
-        return 0;
+        // speed attribute change (or the poll fallback)
+        ret = sysfs_notify_wait ("/sys/class/net/eth0/speed", speed_str, LINK_SETUP_TIMEOUT);
     }
-    return 1;
+    res_lock_release (&set);
+    return ret;
 }
 
 //------------------------------------------------------------------------------
 static int ethernet_link_check (char *resp)
 {
     int status = 0, link_speed = 0;
-
-    link_speed = ethernet_link_speed ();
+    struct res_lock_set set;
+
+    // not in the middle of a speed change
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_READ, "eth0");
+    if (res_lock_acquire (&set, LINK_SETUP_TIMEOUT)) {
+        link_speed = ethernet_link_speed ();
+        res_lock_release (&set);
+    }
 
     status = (link_speed == LINK_SPEED_1G)  ? 1 : -1;
 
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'F', link_speed);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_ip_check (char *resp)
+static int ethernet_ip_check (struct device_ethernet *eth, char *resp)
 {
     int status = 0;
 
-    if (!DeviceETHERNET.board_ip_int[0])
-        ethernet_board_ip ();
+    if (!eth->board_ip_int[0])
+        ethernet_board_ip (eth);
 
-    status = DeviceETHERNET.board_ip_int[0] ? 1 : -1;
+    status = eth->board_ip_int[0] ? 1 : -1;
 
-    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', DeviceETHERNET.board_ip_str);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', eth->board_ip_str);
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_mac_check (char *resp)
+static int ethernet_mac_check (struct device_ethernet *eth, char *resp)
 {
     int status = 0;
 
-    if (!DeviceETHERNET.board_mac_validate)
-        ethernet_efuse_check ();
+    if (!eth->board_mac_validate)
+        ethernet_efuse_check (eth);
 
-    status = DeviceETHERNET.board_mac_validate ? 1 : -1;
+    status = eth->board_mac_validate ? 1 : -1;
 
-    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', DeviceETHERNET.board_mac_str);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', eth->board_mac_str);
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-pthread_t thread_iperf3;
-static volatile int ThreadRunning = 0;
-
-static void *thread_iperf3_func (void *arg)
+static void thread_iperf3_func (void *arg)
 {
-    FILE *fp;
+    struct device_ethernet *eth = (struct device_ethernet *)arg;
     char cmd_line [STR_PATH_LENGTH], *pstr = NULL;
-
-    printf ("\n%s : thread running!\n", __func__);
-    ThreadRunning = 1;
+    char *argv[] = { "iperf3", "-s", "-1", NULL };
+    struct res_lock_set set;
+    int lock_err = 0;
+
+    // eth0 read lock from the client connection to the end of the test only.
+    // Held while waiting for the host client (open-ended), a LED link speed
+    // change would time out and its waiting write lock (writer preferred)
+    // would stall the link checks too.
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_READ, "eth0");
+
+    DEV_LOG (eLOG_INFO, eGID_ETHERNET, "%s : thread running!\n", __func__);
     memset (cmd_line, 0, sizeof(cmd_line));
-    if ((fp = popen("iperf3 -s -1", "r")) != NULL) {
-        while (fgets(cmd_line, sizeof(cmd_line), fp)) {
+    // no deadline : the server waits for the client (thread_iperf_stop)
+    if (subproc_spawn (&eth->iperf3, argv, SUBPROC_OUT, 0)) {
+        while (subproc_gets (&eth->iperf3, cmd_line, sizeof(cmd_line)) != NULL) {
+            // no link speed change (LED 100M / 1G) while the client measures
+            if (!set.held && !lock_err && (strstr (cmd_line, "Accepted connection") != NULL)) {
+                if (!res_lock_acquire (&set, LINK_SETUP_TIMEOUT)) {
+                    DEV_LOG (eLOG_ERR, eGID_ETHERNET, "%s : eth0 lock timeout, speed dropped!\n", __func__);
+                    lock_err = 1;
+                }
+            }
             if (strstr (cmd_line, "receiver") != NULL) {
                 if ((pstr = strstr (cmd_line, "MBytes")) != NULL) {
                     while (*pstr != ' ')    pstr++;
-                    DeviceETHERNET.iperf_speed_s = atoi (pstr);
-                    printf ("\n%s : popen stop (receiver), iperf speed = %d\n",
-                        __func__, DeviceETHERNET.iperf_speed_s);
+                    // link changed during the test : no speed (check fails)
+                    eth->iperf_speed_s = lock_err ? 0 : atoi (pstr);
+                    DEV_LOG (eLOG_INFO, eGID_ETHERNET, "%s : iperf3 stop (receiver), iperf speed = %d\n",
+                        __func__, eth->iperf_speed_s);
                     break;
                 }
             }
@@ -430,145 +501,191 @@ static void *thread_iperf3_func (void *arg)
             if (strstr (cmd_line, "sender") != NULL) {
                 if ((pstr = strstr (cmd_line, "MBytes")) != NULL) {
                     while (*pstr != ' ')    pstr++;
-                    DeviceETHERNET.iperf_speed_c = atoi (pstr);
-                    printf ("\n%s : popen stop (sender), iperf speed = %d\n",
-                        __func__, DeviceETHERNET.iperf_speed_c);
+                    eth->iperf_speed_c = lock_err ? 0 : atoi (pstr);
+                    DEV_LOG (eLOG_INFO, eGID_ETHERNET, "%s : iperf3 stop (sender), iperf speed = %d\n",
+                        __func__, eth->iperf_speed_c);
                     break;
                 }
             }
             memset (cmd_line, 0, sizeof(cmd_line));
         }
-        pclose(fp);
+        subproc_wait (&eth->iperf3);
     }
-    ThreadRunning = 0;
-    printf ("\n%s : thread stop! \n", __func__);
-    return arg;
+    res_lock_release (&set);
+    DEV_LOG (eLOG_INFO, eGID_ETHERNET, "%s : thread stop!\n", __func__);
 }
 
 //------------------------------------------------------------------------------
-void thread_iperf_stop (void)
+static void thread_iperf_stop (struct device_ethernet *eth)
 {
-    FILE *fp;
-    const char *cmd = "ps ax | grep iperf3 | awk '{print $1}' | xargs kill";
-
-    if ((fp = popen (cmd, "w")) != NULL)
-        pclose(fp);
+    // not started yet : dropped from the pool queue
+    if (worker_future_cancel (&eth->iperf3_job))
+        return;
+
+    // iperf3 server started by thread_iperf3_func only (may be spawned after the kill)
+    do {
+        subproc_kill (&eth->iperf3);
+    } while (!worker_future_timedwait (&eth->iperf3_job, IPERF_STOP_WAIT));
+}
 
-    ThreadRunning = 0;    usleep (100 *1000);
+//------------------------------------------------------------------------------
+static void thread_iperf_start (struct device_ethernet *eth)
+{
+    // previous server already stopped (thread_iperf_stop)
+    worker_future_submit (&eth->iperf3_job, thread_iperf3_func, eth, WORKER_LONG);
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_iperf_check (char *resp, int id)
+static int ethernet_iperf_check (struct device_ethernet *eth, char *resp, int id)
 {
     int status = 0, iperf_speed = 0;
 
-    if (DeviceETHERNET.board_ip_int[0] != 0) {
-        thread_iperf_stop ();
+    if (eth->board_ip_int[0] != 0) {
+        thread_iperf_stop (eth);
 
         switch (id) {
             case eETHERNET_IPERF: case eETHERNET_IPERF_S:
-                if (!ThreadRunning && (DeviceETHERNET.iperf_speed_s < DeviceETHERNET.iperf_check_speed)) {
-                    DeviceETHERNET.iperf_speed_s = 0;
-                    pthread_create (&thread_iperf3, NULL, thread_iperf3_func, NULL);
+                if (eth->iperf_speed_s < eth->iperf_check_speed) {
+                    eth->iperf_speed_s = 0;
+                    thread_iperf_start (eth);
                 }
 
-                iperf_speed = DeviceETHERNET.iperf_speed_s;
+                iperf_speed = eth->iperf_speed_s;
 
                 if (id == eETHERNET_IPERF)
-                    DeviceETHERNET.iperf_speed_c = iperf_speed;
+                    eth->iperf_speed_c = iperf_speed;
 
                 break;
             case eETHERNET_IPERF_C:
-                if (!ThreadRunning && (DeviceETHERNET.iperf_speed_c < DeviceETHERNET.iperf_check_speed)) {
-                    DeviceETHERNET.iperf_speed_c = 0;
-                    pthread_create (&thread_iperf3, NULL, thread_iperf3_func, NULL);
+                if (eth->iperf_speed_c < eth->iperf_check_speed) {
+                    eth->iperf_speed_c = 0;
+                    thread_iperf_start (eth);
                 }
 
-                iperf_speed = DeviceETHERNET.iperf_speed_c;
+                iperf_speed = eth->iperf_speed_c;
                 break;
         }
 
         if (iperf_speed)
-            status = (iperf_speed > DeviceETHERNET.iperf_check_speed) ? 1 : -1;
+            status = (iperf_speed > eth->iperf_check_speed) ? 1 : -1;
     }
 
     if (status) DEVICE_RESP_FORM_INT(resp, (status == 1) ? 'P' : 'F', iperf_speed);
-    else        DEVICE_RESP_FORM_STR(resp, 'C', DeviceETHERNET.board_ip_str);
+    else        DEVICE_RESP_FORM_STR(resp, 'C', eth->board_ip_str);
 
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_server_check (char *resp)
+static int ethernet_server_check (struct device_ethernet *eth, char *resp)
 {
     int status = 0;
 
-    if (DeviceETHERNET.board_ip_int[0]) {
-        ethernet_server_ip   ();
+    if (eth->board_ip_int[0]) {
+        ethernet_server_ip   (eth);
 
-        if (DeviceETHERNET.server_ip_int[0] != 0)   status = 1;
+        if (eth->server_ip_int[0] != 0)   status = 1;
 
-        DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', DeviceETHERNET.server_ip_str);
+        DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'P' : 'F', eth->server_ip_str);
     }
 
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-int ethernet_check (int dev_id, char *resp)
+int ethernet_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_ethernet *eth = dev_check_ctx_data (ctx, eGID_ETHERNET);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
-        case eETHERNET_IP:      return ethernet_ip_check    (resp);
-        case eETHERNET_MAC:     return ethernet_mac_check   (resp);
+        case eETHERNET_IP:      return ethernet_ip_check    (eth, resp);
+        case eETHERNET_MAC:     return ethernet_mac_check   (eth, resp);
 
         case eETHERNET_IPERF_S: case eETHERNET_IPERF_C:
-        case eETHERNET_IPERF:   return ethernet_iperf_check (resp, id);
+        case eETHERNET_IPERF:   return ethernet_iperf_check (eth, resp, id);
 
         case eETHERNET_LINK:    return ethernet_link_check  (resp);
-        case eETHERNET_SERVER:  return ethernet_server_check(resp);
+        case eETHERNET_SERVER:  return ethernet_server_check(eth, resp);
         default:
             break;
     }
     DEVICE_RESP_FORM_INT (resp, (status == 1) ? 'P' : 'F', value);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_ETHERNET, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-void ethernet_grp_init (char *cfg)
+void ethernet_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_ethernet *eth = dev_check_ctx_data (ctx, eGID_ETHERNET);
+    char *tok, *save;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             if (atoi(tok) == eETHERNET_CFG) {
-                if ((tok = strtok (NULL, ",")) != NULL)
-                    DeviceETHERNET.link_speed = atoi(tok);
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                    eth->link_speed = atoi(tok);
 
-                if ((tok = strtok (NULL, ",")) != NULL)
-                    strncpy (DeviceETHERNET.efuse_board_name, tok, strlen(tok));
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                    strncpy (eth->efuse_board_name, tok, strlen(tok));
 
-                if ((tok = strtok (NULL, ",")) != NULL)
-                    DeviceETHERNET.server_port = atoi(tok);
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                    eth->server_port = atoi(tok);
 
-                if ((tok = strtok (NULL, ",")) != NULL)
-                    DeviceETHERNET.iperf_check_speed = atoi(tok);
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                    eth->iperf_check_speed = atoi(tok);
             }
         }
     }
 
-    if (ethernet_link_speed() != DeviceETHERNET.link_speed) {
-        ethernet_link_setup (DeviceETHERNET.link_speed);
+    if (ethernet_link_speed() != eth->link_speed) {
+        ethernet_link_setup (eth->link_speed);
         sleep (1);
     }
-    ethernet_board_ip ();
+    ethernet_board_ip (eth);
+
+    // board identity (journal resume), the mac is written by the MAC check
+    ethernet_efuse_read (eth);
+}
+
+//------------------------------------------------------------------------------
+static int ethernet_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    char resp [DEVICE_RESP_SIZE+1];
+
+    switch (pdata->did) {
+        case eETHERNET_IPERF:
+        case eETHERNET_IPERF_S:
+        case eETHERNET_IPERF_C:
+            memset (resp, 0, sizeof(resp));
+            pdata->status_i = ethernet_check (ctx, pdata->did, resp);
+            return pdata->status_i;
+        default :
+            break;
+    }
+    return 1;
 }
 
+//------------------------------------------------------------------------------
+static void ethernet_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct device_ethernet *eth = dev_check_ctx_data (ctx, eGID_ETHERNET);
+
+    thread_iperf_stop (eth);
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupETHERNET = {
+    "ETHERNET", eGID_ETHERNET, eGID_ETHERNET, sizeof(DeviceETHERNET), &DeviceETHERNET,
+    ethernet_grp_init, ethernet_check, ethernet_resp_check, ethernet_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupETHERNET);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
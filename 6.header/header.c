@@ -37,15 +37,29 @@
 #include "header.h"
 
 //------------------------------------------------------------------------------
-// GPIO num
-int HEADER40[40 +1] = { -1, };
-int HEADER14[14 +1] = { -1, };
-int HEADER7 [ 7 +1] = { -1, };
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+struct device_header {
+    // GPIO num
+    int HEADER40[40 +1];
+    int HEADER14[14 +1];
+    int HEADER7 [ 7 +1];
+
+    // Check ADC Connecter name
+    char HEADER40_CON[16];
+    char HEADER14_CON[16];
+    char HEADER7_CON [16];
+};
+
+// default state of every dev_check_ctx
+static const struct device_header DeviceHEADER = {
+    { -1, }, { -1, }, { -1, }, { 0, }, { 0, }, { 0, }
+};
 
-// Check ADC Connecter name
-char HEADER40_CON[16] = { 0, };
-char HEADER14_CON[16] = { 0, };
-char HEADER7_CON [16] = { 0, };;
+// banks used by a gpio check (ms)
+#define HEADER_LOCK_TIMEOUT 1000
 
 //------------------------------------------------------------------------------
 const int HEADER_PATTERN[4][2] = {
@@ -56,70 +70,82 @@ const int HEADER_PATTERN[4][2] = {
 };
 
 //------------------------------------------------------------------------------
-static int pattern_write (int id, int pattern)
+static int pattern_write (struct device_header *hdr, int id, int pattern)
 {
     int cnt = 0, err_cnt = 0, read = 0, nc_pin_cnt = 0;
     int gpio_cnt = 0, *gpio_list, *gpio_pattern, pattern_pos = 0;
+    struct res_lock_set set;
 
     switch (id) {
         case eHEADER_7:
-            gpio_cnt     = sizeof(HEADER7)/sizeof(HEADER7[0]);
-            gpio_list    = (int *)HEADER7;
+            gpio_cnt     = sizeof(hdr->HEADER7)/sizeof(hdr->HEADER7[0]);
+            gpio_list    = (int *)hdr->HEADER7;
             break;
         case eHEADER_14:
-            gpio_cnt     = sizeof(HEADER14)/sizeof(HEADER14[0]);
-            gpio_list    = (int *)HEADER14;
+            gpio_cnt     = sizeof(hdr->HEADER14)/sizeof(hdr->HEADER14[0]);
+            gpio_list    = (int *)hdr->HEADER14;
             break;
         case eHEADER_40:
-            gpio_cnt     = sizeof(HEADER40)/sizeof(HEADER40[0]);
-            gpio_list    = (int *)HEADER40;
+            gpio_cnt     = sizeof(hdr->HEADER40)/sizeof(hdr->HEADER40[0]);
+            gpio_list    = (int *)hdr->HEADER40;
             break;
         default:
-            printf ("%s : unknown header (id = %d)\n", __func__, id);
+            DEV_LOG (eLOG_ERR, eGID_HEADER, "%s : unknown header (id = %d)\n", __func__, id);
             return 0;
     }
     gpio_pattern = (int *)&HEADER_PATTERN[pattern % 4][0];
 
+    // every bank of the header at once
+    res_lock_set_init (&set);
+    for (cnt = 0; cnt < gpio_cnt; cnt++) {
+        if (gpio_list[cnt] != NC)
+            res_lock_set_add (&set, RES_LOCK_WRITE, "gpio_bank%d", gpio_list[cnt] / RES_LOCK_GPIO_BANK);
+    }
+    if (!res_lock_acquire (&set, HEADER_LOCK_TIMEOUT))
+        return 0;
+
     for (cnt = 0; cnt < gpio_cnt; cnt++) {
         if (gpio_list[cnt] != NC) {
             gpio_set_value (gpio_list[cnt], gpio_pattern[pattern_pos]);
             gpio_get_value (gpio_list[cnt], &read);
             if (read != gpio_pattern[pattern_pos]) {
-                printf ("%s : error, num = %d gpio = %d, set = %d, get = %d\n",
+                DEV_LOG (eLOG_ERR, eGID_HEADER, "%s : error, num = %d gpio = %d, set = %d, get = %d\n",
                     __func__, cnt, gpio_list[cnt], gpio_pattern [pattern_pos], read);
                 err_cnt++;
             }
             pattern_pos = !pattern_pos;
         } else nc_pin_cnt++;
     }
+    res_lock_release (&set);
+
     if (nc_pin_cnt == gpio_cnt) {
-        printf ("%s : not used header id(%d)\n", __func__, id);
+        DEV_LOG (eLOG_WARN, eGID_HEADER, "%s : not used header id(%d)\n", __func__, id);
         return 0;
     }
     return err_cnt ? 0 : 1;
 }
 
 //------------------------------------------------------------------------------
-static int pattern_compare (int id, int pattern, int *resp_pt)
+static int pattern_compare (struct device_header *hdr, int id, int pattern, int *resp_pt)
 {
     int cnt = 0, err_cnt = 0, nc_pin_cnt = 0;
     int gpio_cnt = 0, *gpio_list, *gpio_pattern, pattern_pos = 0;
 
     switch (id) {
         case eHEADER_7:
-            gpio_cnt     = sizeof(HEADER7)/sizeof(HEADER7[0]);
-            gpio_list    = (int *)HEADER7;
+            gpio_cnt     = sizeof(hdr->HEADER7)/sizeof(hdr->HEADER7[0]);
+            gpio_list    = (int *)hdr->HEADER7;
             break;
         case eHEADER_14:
-            gpio_cnt     = sizeof(HEADER14)/sizeof(HEADER14[0]);
-            gpio_list    = (int *)HEADER14;
+            gpio_cnt     = sizeof(hdr->HEADER14)/sizeof(hdr->HEADER14[0]);
+            gpio_list    = (int *)hdr->HEADER14;
             break;
         case eHEADER_40:
-            gpio_cnt     = sizeof(HEADER40)/sizeof(HEADER40[0]);
-            gpio_list    = (int *)HEADER40;
+            gpio_cnt     = sizeof(hdr->HEADER40)/sizeof(hdr->HEADER40[0]);
+            gpio_list    = (int *)hdr->HEADER40;
             break;
         default:
-            printf ("%s : unknown header (id = %d)\n", __func__, id);
+            DEV_LOG (eLOG_ERR, eGID_HEADER, "%s : unknown header (id = %d)\n", __func__, id);
             return 0;
     }
     gpio_pattern = (int *)&HEADER_PATTERN[pattern % 4][0];
@@ -127,7 +153,7 @@ static int pattern_compare (int id, int pattern, int *resp_pt)
     for (cnt = 0; cnt < gpio_cnt; cnt++) {
         if (gpio_list[cnt] != NC) {
             if (gpio_pattern[pattern_pos] != resp_pt [cnt]) {
-                printf ("%s : error, num = %d gpio = %d, set = %d, get = %d\n",
+                DEV_LOG (eLOG_ERR, eGID_HEADER, "%s : error, num = %d gpio = %d, set = %d, get = %d\n",
                     __func__, cnt, gpio_list [cnt], gpio_pattern [pattern_pos], resp_pt [cnt]);
                 err_cnt++;
             }
@@ -136,17 +162,18 @@ static int pattern_compare (int id, int pattern, int *resp_pt)
     }
 
     if (nc_pin_cnt == gpio_cnt) {
-        printf ("%s : not used header id(%d)\n", __func__, id);
+        DEV_LOG (eLOG_WARN, eGID_HEADER, "%s : not used header id(%d)\n", __func__, id);
         return 0;
     }
     return err_cnt ? 0 : 1;
 }
 
 //------------------------------------------------------------------------------
-int header_data_check (int dev_id, char *resp_s)
+int header_data_check (struct dev_check_ctx *ctx, int dev_id, char *resp_s)
 {
+    struct device_header *hdr = dev_check_ctx_data (ctx, eGID_HEADER);
     int id = DEVICE_ID(dev_id), i;
-    int resp_pt[sizeof(HEADER40)/sizeof(HEADER40[0])];
+    int resp_pt[sizeof(hdr->HEADER40)/sizeof(hdr->HEADER40[0])];
 
     memset (resp_pt, 0, sizeof(resp_pt));
 
@@ -162,76 +189,78 @@ int header_data_check (int dev_id, char *resp_s)
         }
     }
 
-    return pattern_compare (id, DEVICE_ACTION(dev_id), resp_pt);
+    return pattern_compare (hdr, id, DEVICE_ACTION(dev_id), resp_pt);
 }
 
 //------------------------------------------------------------------------------
-int header_check (int dev_id, char *resp)
+int header_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_header *hdr = dev_check_ctx_data (ctx, eGID_HEADER);
     int status = 0, id = DEVICE_ID(dev_id);
 
-    status = pattern_write (id, DEVICE_ACTION(dev_id)) ? 1 : -1;
+    status = pattern_write (hdr, id, DEVICE_ACTION(dev_id)) ? 1 : -1;
     switch (id) {
         case eHEADER_40:
-            DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', HEADER40_CON);
+            DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', hdr->HEADER40_CON);
             break;
         case eHEADER_14:
-            DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', HEADER14_CON);
+            DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', hdr->HEADER14_CON);
             break;
         case eHEADER_7:
-            DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', HEADER7_CON);
+            DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', hdr->HEADER7_CON);
             break;
         default :
             break;
     }
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_HEADER, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void header_grp_init (char *cfg)
+void header_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_header *hdr = dev_check_ctx_data (ctx, eGID_HEADER);
+    char *tok, *save;
     int did, h_s, h_c, *h_a, i;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             if (did != eHEADER_CFG) {
-                if ((tok = strtok (NULL, ",")) != NULL) h_s = atoi (tok);
-                if ((tok = strtok (NULL, ",")) != NULL) h_c = atoi (tok);
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL) h_s = atoi (tok);
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL) h_c = atoi (tok);
                 switch (did) {
-                    case eHEADER_40: h_a = &HEADER40[0]; break;
-                    case eHEADER_14: h_a = &HEADER14[0]; break;
-                    case eHEADER_7:  h_a = &HEADER7 [0]; break;
+                    case eHEADER_40: h_a = &hdr->HEADER40[0]; break;
+                    case eHEADER_14: h_a = &hdr->HEADER14[0]; break;
+                    case eHEADER_7:  h_a = &hdr->HEADER7 [0]; break;
                     default :
                         printf ("%s : error! unknown did = %d\n", __func__, did);
                         return;
                 }
                 for (i = 0; i < h_c; i++) {
-                    if ((tok = strtok (NULL, ",")) != NULL) h_a [h_s +i] = atoi (tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) h_a [h_s +i] = atoi (tok);
                     if (h_a[h_s +i] != NC) {
                         gpio_export    (h_a[h_s +i]);   gpio_direction (h_a[h_s +i], 1);
                     }
                 }
             } else {
                 // Header ADC Name(h_s == 0)
-                if ((tok = strtok (NULL, ",")) != NULL) {
+                if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
                     switch (atoi(tok)) {
                         case eHEADER_40:
-                            HEADER40[0] = NC;
-                            if ((tok = strtok (NULL, ",")) != NULL)
-                                strncpy (HEADER40_CON, tok, strlen(tok));
+                            hdr->HEADER40[0] = NC;
+                            if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                                strncpy (hdr->HEADER40_CON, tok, strlen(tok));
                             break;
                         case eHEADER_14:
-                            HEADER14[0] = NC;
-                            if ((tok = strtok (NULL, ",")) != NULL)
-                                strncpy (HEADER14_CON, tok, strlen(tok));
+                            hdr->HEADER14[0] = NC;
+                            if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                                strncpy (hdr->HEADER14_CON, tok, strlen(tok));
                             break;
                         case eHEADER_7:
-                            HEADER7 [0] = NC;
-                            if ((tok = strtok (NULL, ",")) != NULL)
-                                strncpy (HEADER7_CON,  tok, strlen(tok));
+                            hdr->HEADER7 [0] = NC;
+                            if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                                strncpy (hdr->HEADER7_CON,  tok, strlen(tok));
                             break;
                         default :
                             printf ("%s : error! unknown did = %d\n", __func__, did);
@@ -243,5 +272,20 @@ void header_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static int header_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    pdata->status_i = header_data_check (ctx, pdata->did, pdata->resp_s);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupHEADER = {
+    "HEADER", eGID_HEADER, eGID_HEADER, sizeof(DeviceHEADER), &DeviceHEADER,
+    header_grp_init, header_check, header_resp_check, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupHEADER);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,46 +1,48 @@
-//------------------------------------------------------------------------------
-/**
- * @file header.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-25
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __HEADER_H__
-#define __HEADER_H__
-
-//------------------------------------------------------------------------------
-// Not Control
-#define NC              -1
-#define PATTERN_COUNT   4
-
-//------------------------------------------------------------------------------
-// Define the Device ID for the HEADER group.
-//------------------------------------------------------------------------------
-#define eHEADER_CFG -1
-enum {
-    eHEADER_40,
-    eHEADER_7,
-    eHEADER_14,
-    eHEADER_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  header_data_check   (int dev_id, char *resp_s);
-extern int  header_check        (int dev_id, char *resp);
-extern void header_grp_init     (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __HEADER_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file header.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-25
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __HEADER_H__
+#define __HEADER_H__
+
+//------------------------------------------------------------------------------
+// Not Control
+#define NC              -1
+#define PATTERN_COUNT   4
+
+//------------------------------------------------------------------------------
+// Define the Device ID for the HEADER group.
+//------------------------------------------------------------------------------
+#define eHEADER_CFG -1
+enum {
+    eHEADER_40,
+    eHEADER_7,
+    eHEADER_14,
+    eHEADER_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  header_data_check   (struct dev_check_ctx *ctx, int dev_id, char *resp_s);
+extern int  header_check        (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void header_grp_init     (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __HEADER_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -50,6 +50,13 @@ struct device_audio {
     int max, min;
 };
 
+// aplay deadline = play time + margin (sec)
+#define AUDIO_APLAY_MARGIN  5
+// aplay stop : kill again until the job ends (ms)
+#define AUDIO_STOP_WAIT     100
+// card used by the aplay of another context (ms)
+#define AUDIO_LOCK_TIMEOUT  3000
+
 //------------------------------------------------------------------------------
 //
 // Configuration
@@ -57,69 +64,89 @@ struct device_audio {
 //------------------------------------------------------------------------------
 /* define audio devices */
 //------------------------------------------------------------------------------
-struct device_audio DeviceAUDIO [eAUDIO_END] = {
-    // AUDIO LEFT
-    { { 0, }, { 0, }, { 0, }, 0, 0 },
-    // AUDIO RIGHT
-    { { 0, }, { 0, }, { 0, }, 0, 0 },
-    // AUDIO SLEFT
-    { { 0, }, { 0, }, { 0, }, 0, 0 },
-    // AUDIO SRIGHT
-    { { 0, }, { 0, }, { 0, }, 0, 0 },
+struct audio_grp {
+    struct device_audio audio[eAUDIO_END];
+
+    // Devuce H/W num. ch, play time
+    int hw, ch, time;
+
+    // aplay job (play : device being played)
+    struct worker_future job;
+    struct device_audio *play;
+    // aplay process (audio_thread_stop)
+    struct subproc aplay;
 };
 
-// Devuce H/W num. ch, play time
-volatile int AudioHW = 0, AudioCH = 0, AudioTime = 0, AudioEnable = 0;
+// default state of every dev_check_ctx
+static const struct audio_grp DeviceAUDIO = {
+    {
+        // AUDIO LEFT
+        { { 0, }, { 0, }, { 0, }, 0, 0 },
+        // AUDIO RIGHT
+        { { 0, }, { 0, }, { 0, }, 0, 0 },
+        // AUDIO SLEFT
+        { { 0, }, { 0, }, { 0, }, 0, 0 },
+        // AUDIO SRIGHT
+        { { 0, }, { 0, }, { 0, }, 0, 0 },
+    },
+    0, 0, 0, { 0, }, NULL, { 0, -1, 0, 0, 0, { 0, } }
+};
 
 //------------------------------------------------------------------------------
 // thread control variable
 //------------------------------------------------------------------------------
-// speaker-test -D hw:AudioHW,AudioCH -c 2 -t sine -f 1000 -p 2 -s 1 (left)
-// speaker-test -D hw:AudioHW,AudioCH -c 2 -t sine -f 1000 -p 2 -s 2 (right)
+// speaker-test -D hw:grp->hw,grp->ch -c 2 -t sine -f 1000 -p 2 -s 1 (left)
+// speaker-test -D hw:grp->hw,grp->ch -c 2 -t sine -f 1000 -p 2 -s 2 (right)
 //------------------------------------------------------------------------------
-void *audio_thread_func (void *arg)
+static void audio_thread_func (void *arg)
 {
-    struct device_audio *paudio = (struct device_audio *)arg;
-
-    FILE *fp;
-    char cmd [STR_PATH_LENGTH *2];
-
-    AudioEnable = 1;
+    struct audio_grp *grp = (struct audio_grp *)arg;
+    char hw[STR_NAME_LENGTH], sec[16];
+    char *argv[] = { "aplay", hw, grp->play->path, "-d", sec, NULL };
+    struct res_lock_set set;
 
-    memset  (cmd, 0, sizeof(cmd));
-    sprintf (cmd, "aplay -Dhw:%d,%d %s -d %d && sync",
-                AudioHW, AudioCH, paudio->path, AudioTime);
+    // one aplay on the card (other contexts)
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "hw:%d,%d", grp->hw, grp->ch);
+    if (!res_lock_acquire (&set, AUDIO_LOCK_TIMEOUT)) {
+        DEV_LOG (eLOG_ERR, eGID_AUDIO, "%s : hw:%d,%d lock timeout!\n", __func__, grp->hw, grp->ch);
+        return;
+    }
 
-    if ((fp = popen (cmd, "w")) != NULL)
-        pclose(fp);
+    snprintf (hw,   sizeof(hw),   "-Dhw:%d,%d", grp->hw, grp->ch);
+    snprintf (sec,  sizeof(sec),  "%d", grp->time);
 
-    AudioEnable = 0;    usleep (100 *1000);
+    // play time + margin (time 0 : whole file, no deadline)
+    if (subproc_spawn (&grp->aplay, argv, 0, grp->time ? (grp->time + AUDIO_APLAY_MARGIN) * 1000 : 0))
+        subproc_wait (&grp->aplay);
 
-    return arg;
+    res_lock_release (&set);
 }
 
 //------------------------------------------------------------------------------
-void audio_thread_stop (void)
+static void audio_thread_stop (struct audio_grp *grp)
 {
-    FILE *fp;
-    const char *cmd = "ps ax | grep aplay | awk '{print $1}' | xargs kill";
-
-    if ((fp = popen (cmd, "w")) != NULL)
-        pclose(fp);
+    // not started yet : dropped from the pool queue
+    if (worker_future_cancel (&grp->job))
+        return;
 
-    AudioEnable = 0;    usleep (100 *1000);
+    // aplay started by audio_thread_func only (may be spawned after the kill)
+    do {
+        subproc_kill (&grp->aplay);
+    } while (!worker_future_timedwait (&grp->job, AUDIO_STOP_WAIT));
 }
 
 //------------------------------------------------------------------------------
-int audio_data_check (int dev_id, int resp_i)
+int audio_data_check (struct dev_check_ctx *ctx, int dev_id, int resp_i)
 {
+    struct audio_grp *grp = dev_check_ctx_data (ctx, eGID_AUDIO);
     int status = 0, id = DEVICE_ID(dev_id);
     switch (id) {
         case eAUDIO_LEFT: case eAUDIO_RIGHT: case eAUDIO_SLEFT: case eAUDIO_SRIGHT:
             if (DEVICE_ACTION(dev_id))
-                status = (resp_i < DeviceAUDIO[id].min) ? 1 : 0;    // audio on (low)
+                status = (resp_i < grp->audio[id].min) ? 1 : 0;    // audio on (low)
             else
-                status = (resp_i > DeviceAUDIO[id].max) ? 1 : 0;    // audio off (high)
+                status = (resp_i > grp->audio[id].max) ? 1 : 0;    // audio off (high)
             break;
         default :
             status = 0;
@@ -129,75 +156,76 @@ int audio_data_check (int dev_id, int resp_i)
 }
 
 //------------------------------------------------------------------------------
-int audio_check (int dev_id, char *resp)
+int audio_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct audio_grp *grp = dev_check_ctx_data (ctx, eGID_AUDIO);
     int status = 1, id = DEVICE_ID(dev_id);
-    pthread_t audio_thread;
     char resp_data[DEVICE_RESP_SIZE -2];
 
     memset (resp_data, 0, sizeof(resp_data));
-    if (AudioEnable)    audio_thread_stop();
+    if (worker_future_busy (&grp->job))
+        audio_thread_stop (grp);
 
     switch (id) {
         case eAUDIO_LEFT:
         case eAUDIO_RIGHT:
         case eAUDIO_SLEFT:
         case eAUDIO_SRIGHT:
-            sprintf (resp_data, "%s-%d", DeviceAUDIO[id].cname,
-                DEVICE_ACTION(dev_id) ? DeviceAUDIO[id].max : DeviceAUDIO[id].min);
+            sprintf (resp_data, "%s-%d", grp->audio[id].cname,
+                DEVICE_ACTION(dev_id) ? grp->audio[id].max : grp->audio[id].min);
             break;
         /*
         case eAUDIO_LEFT:
-            sprintf (resp_data, "%s,%s", DeviceAUDIO[id].cname, DeviceAUDIO[eAUDIO_RIGHT].cname);   break;
+            sprintf (resp_data, "%s,%s", grp->audio[id].cname, grp->audio[eAUDIO_RIGHT].cname);   break;
         case eAUDIO_RIGHT:
-            sprintf (resp_data, "%s,%s", DeviceAUDIO[id].cname, DeviceAUDIO[eAUDIO_LEFT].cname);    break;
+            sprintf (resp_data, "%s,%s", grp->audio[id].cname, grp->audio[eAUDIO_LEFT].cname);    break;
         case eAUDIO_SLEFT:
-            sprintf (resp_data, "%s,%s", DeviceAUDIO[id].cname, DeviceAUDIO[eAUDIO_SRIGHT].cname);  break;
+            sprintf (resp_data, "%s,%s", grp->audio[id].cname, grp->audio[eAUDIO_SRIGHT].cname);  break;
         case eAUDIO_SRIGHT:
-            sprintf (resp_data, "%s,%s", DeviceAUDIO[id].cname, DeviceAUDIO[eAUDIO_SLEFT].cname);   break;
+            sprintf (resp_data, "%s,%s", grp->audio[id].cname, grp->audio[eAUDIO_SLEFT].cname);   break;
         */
         default :
             status = 0;
             break;
     }
     if (DEVICE_ACTION(dev_id) && status) {
-        if (pthread_create (&audio_thread, NULL, audio_thread_func, &DeviceAUDIO[id])) {
-            printf ("%s : pthread_create error!\n", __func__);
+        grp->play = &grp->audio[id];
+        if (!worker_future_submit (&grp->job, audio_thread_func, grp, WORKER_LONG))
             status = -1;
-        }
     }
 
     DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', resp_data);
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_AUDIO, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void audio_grp_init (char *cfg)
+void audio_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct audio_grp *grp = dev_check_ctx_data (ctx, eGID_AUDIO);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eAUDIO_LEFT: case eAUDIO_RIGHT: case eAUDIO_SLEFT: case eAUDIO_SRIGHT:
-                    if ((tok = strtok (NULL, ",")) != NULL) {
-                        strncpy (DeviceAUDIO[did].fname, tok, strlen(tok));
-                        find_file_path ((const char *)DeviceAUDIO[did].fname,
-                                        (char *)DeviceAUDIO[did].path);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
+                        strncpy (grp->audio[did].fname, tok, strlen(tok));
+                        find_file_path ((const char *)grp->audio[did].fname,
+                                        (char *)grp->audio[did].path);
                     }
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceAUDIO[did].cname, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (grp->audio[did].cname, tok, strlen(tok));
 
-                    if ((tok = strtok (NULL, ",")) != NULL) DeviceAUDIO[did].max = atoi(tok);
-                    if ((tok = strtok (NULL, ",")) != NULL) DeviceAUDIO[did].min = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) grp->audio[did].max = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) grp->audio[did].min = atoi(tok);
                     break;
                 case eAUDIO_CFG:
-                    if ((tok = strtok (NULL, ",")) != NULL) AudioHW   = atoi(tok);
-                    if ((tok = strtok (NULL, ",")) != NULL) AudioCH   = atoi(tok);
-                    if ((tok = strtok (NULL, ",")) != NULL) AudioTime = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) grp->hw   = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) grp->ch   = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) grp->time = atoi(tok);
 
                     break;
                 default :
@@ -208,5 +236,29 @@ void audio_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static int audio_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    pdata->status_i = audio_data_check (ctx, pdata->did, pdata->resp_i);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void audio_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct audio_grp *grp = dev_check_ctx_data (ctx, eGID_AUDIO);
+
+    if (worker_future_busy (&grp->job))
+        audio_thread_stop (grp);
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupAUDIO = {
+    "AUDIO", eGID_AUDIO, eGID_AUDIO, sizeof(DeviceAUDIO), &DeviceAUDIO,
+    audio_grp_init, audio_check, audio_resp_check, audio_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupAUDIO);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,45 +1,47 @@
-//------------------------------------------------------------------------------
-/**
- * @file audio.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-21
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __AUDIO_H__
-#define __AUDIO_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the AUDIO group.
-//------------------------------------------------------------------------------
-#define eAUDIO_CFG  -1
-
-enum {
-    eAUDIO_LEFT,
-    eAUDIO_RIGHT,
-    /* Speaker */
-    eAUDIO_SLEFT,
-    eAUDIO_SRIGHT,
-    eAUDIO_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  audio_data_check(int dev_id, int resp_i);
-extern int  audio_check     (int dev_id, char *resp);
-extern void audio_grp_init  (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __AUDIO_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file audio.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-21
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __AUDIO_H__
+#define __AUDIO_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the AUDIO group.
+//------------------------------------------------------------------------------
+#define eAUDIO_CFG  -1
+
+enum {
+    eAUDIO_LEFT,
+    eAUDIO_RIGHT,
+    /* Speaker */
+    eAUDIO_SLEFT,
+    eAUDIO_SRIGHT,
+    eAUDIO_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  audio_data_check(struct dev_check_ctx *ctx, int dev_id, int resp_i);
+extern int  audio_check     (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void audio_grp_init  (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __AUDIO_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
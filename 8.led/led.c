@@ -48,6 +48,11 @@ struct device_led {
     int max, min;
 };
 
+// ethtool speed change / link up, NVMe read (16 Mbytes x on_value, dd {count} {if} ...)
+#define LED_ETHTOOL_TIMEOUT 5000    // ms
+#define LINK_SETUP_TIMEOUT  10000   // ms
+#define NVME_DD_TIMEOUT     60000   // ms
+
 //------------------------------------------------------------------------------
 //
 // Configuration
@@ -55,74 +60,75 @@ struct device_led {
 //------------------------------------------------------------------------------
 /* define led devices */
 //------------------------------------------------------------------------------
-struct device_led DeviceLED [eLED_END] = {
-    // eLED_POWER
-    { { 0, }, 0, 0, { 0, }, 0, 0},
-    // eLED_ALIVE
-    { { 0, }, 0, 0, { 0, }, 0, 0},
-    // eLED_100M
-    { { 0, }, 0, 0, { 0, }, 0, 0},
-    // eLED_1G
-    { { 0, }, 0, 0, { 0, }, 0, 0},
-    // eLED_NVME
-    { { 0, }, 0, 0, { 0, }, 0, 0},
+struct led_grp {
+    struct device_led led[eLED_END];
+
+    // eLED_NVME read job (worker pool)
+    struct worker_future job;
+};
+
+// default state of every dev_check_ctx
+static const struct led_grp DeviceLED = {
+    {
+        // eLED_POWER
+        { { 0, }, 0, 0, { 0, }, 0, 0},
+        // eLED_ALIVE
+        { { 0, }, 0, 0, { 0, }, 0, 0},
+        // eLED_100M
+        { { 0, }, 0, 0, { 0, }, 0, 0},
+        // eLED_1G
+        { { 0, }, 0, 0, { 0, }, 0, 0},
+        // eLED_NVME
+        { { 0, }, 0, 0, { 0, }, 0, 0},
+    },
+    { 0, }
 };
 
 //------------------------------------------------------------------------------
-static int ethernet_link_speed (int id)
+static int ethernet_link_speed (struct led_grp *grp, int id)
 {
-    FILE *fp;
-    char cmd_line[STR_PATH_LENGTH];
+    char rdata[16];
 
-    if (access (DeviceLED[id].path, F_OK) != 0)
+    // link down : read error (EINVAL)
+    if (sysfs_attr_read (grp->led[id].path, rdata, sizeof(rdata)) <= 0)
         return 0;
 
-    memset (cmd_line, 0x00, sizeof(cmd_line));
-    if ((fp = fopen (DeviceLED[id].path, "r")) != NULL) {
-        memset (cmd_line, 0x00, sizeof(cmd_line));
-        if (NULL != fgets (cmd_line, sizeof(cmd_line), fp)) {
-            fclose (fp);
-            return atoi (cmd_line);
-        }
-    }
-    return 0;
+    return atoi (rdata);
 }
 
 //------------------------------------------------------------------------------
-static int ethernet_link_setup (int dev_id, int speed)
+static int ethernet_link_setup (struct led_grp *grp, int dev_id, int speed)
 {
-    FILE *fp;
-    char cmd_line[STR_PATH_LENGTH], retry = 10;
-
-    if (ethernet_link_speed (DEVICE_ID(dev_id)) != speed) {
-        memset (cmd_line, 0x00, sizeof(cmd_line));
-        sprintf(cmd_line,"ethtool -s eth0 speed %d duplex full 2>&1 && sync ", speed);
-        if ((fp = popen(cmd_line, "r")) != NULL)
-            pclose(fp);
-
-        // timeout 10 sec
-        while (retry--) {
-            sleep (1);
-            if (ethernet_link_speed(DEVICE_ID(dev_id)) == speed)
-                return 1;
-        }
+    char speed_str[16];
+    char *argv[] = { "ethtool", "-s", "eth0", "speed", speed_str, "duplex", "full", NULL };
+    struct res_lock_set set;
+    int ret = 1;
+
+    // not while an iperf3 test runs (ethernet group, client connected : the
+    // idle server waiting for the host holds no lock)
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "eth0");
+    if (!res_lock_acquire (&set, LINK_SETUP_TIMEOUT))
         return 0;
+
+    if (ethernet_link_speed (grp, DEVICE_ID(dev_id)) != speed) {
+        snprintf (speed_str, sizeof(speed_str), "%d", speed);
+        if (subproc_run (argv, LED_ETHTOOL_TIMEOUT) == 0)
+            sync ();
+
+        // speed attribute change (or the poll fallback)
+        ret = sysfs_notify_wait (grp->led[DEVICE_ID(dev_id)].path, speed_str, LINK_SETUP_TIMEOUT);
     }
-    return 1;
+    res_lock_release (&set);
+    return ret;
 }
 //------------------------------------------------------------------------------
 static int led_read (const char *path)
 {
     char rdata[16];
-    FILE *fp;
-
-    memset (rdata, 0, sizeof (rdata));
 
     // led value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fread (rdata, 1, sizeof(rdata), fp);
-        fclose(fp);
-    }
+    sysfs_attr_read (path, rdata, sizeof(rdata));
 
     return atoi(rdata);
 }
@@ -130,29 +136,25 @@ static int led_read (const char *path)
 //------------------------------------------------------------------------------
 static int led_write (const char *path, const char *wdata)
 {
-    FILE *fp;
-
     // led value set
-    if ((fp = fopen(path, "w")) != NULL) {
-        fwrite (wdata, 1, strlen(wdata), fp);
-        fclose(fp);
-    }
+    sysfs_attr_write (path, wdata);
 
     return atoi(wdata);
 }
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-int led_data_check (int dev_id, int resp_i)
+int led_data_check (struct dev_check_ctx *ctx, int dev_id, int resp_i)
 {
+    struct led_grp *grp = dev_check_ctx_data (ctx, eGID_LED);
     int status = 0, id = DEVICE_ID(dev_id);
     switch (id) {
         case eLED_ALIVE: case eLED_POWER:
         case eLED_100M:  case eLED_1G:  case eLED_NVME:
             if (DEVICE_ACTION(dev_id))
-                status = (resp_i > DeviceLED[id].max) ? 1 : 0;    // led on
+                status = (resp_i > grp->led[id].max) ? 1 : 0;    // led on
             else
-                status = (resp_i < DeviceLED[id].min) ? 1 : 0;    // led off
+                status = (resp_i < grp->led[id].min) ? 1 : 0;    // led off
             break;
         default :
             status = 0;
@@ -162,36 +164,39 @@ int led_data_check (int dev_id, int resp_i)
 }
 
 //------------------------------------------------------------------------------
-pthread_t thread_led;
-static volatile int ThreadRunning = 0;
-const char *NVME_READ_CHECK = "dd of=/dev/null bs=16M count=%d iflag=nocache,dsync oflag=nocache,dsync if=%s 2>&1 && sync";
-
-void *thread_func_led (void *arg)
+static void thread_func_led (void *arg)
 {
-    struct device_led *p_led = (struct device_led *)arg;
-    char cmd [STR_PATH_LENGTH*2];
-    FILE *fp;
-
-    memset  (cmd, 0, sizeof(cmd));
-
-    sprintf (cmd, NVME_READ_CHECK, p_led->on_value, p_led->path);
-
-    ThreadRunning = 1;
-
-    if ((fp = popen (cmd, "r")) != NULL)    pclose(fp);
-
-    ThreadRunning = 0;
-
-    return arg;
+    struct led_grp *grp = (struct led_grp *)arg;
+    struct device_led *p_led = &grp->led[eLED_NVME];
+    char dd_count[16], dd_if[PATH_MAX +4], buf[PATH_MAX];
+    char *argv[] = { "dd", dd_if, "of=/dev/null", "bs=16M", dd_count,
+                     "iflag=nocache,dsync", "oflag=nocache,dsync", NULL };
+    struct res_lock_set set;
+
+    // storage group dd speed on the same device
+    res_lock_set_init (&set);
+    res_lock_set_add  (&set, RES_LOCK_WRITE, "%s", p_led->path);
+    if (!res_lock_acquire (&set, NVME_DD_TIMEOUT))
+        return;
+
+    snprintf (dd_count, sizeof(dd_count), "count=%d", p_led->on_value);
+    snprintf (dd_if, sizeof(dd_if), "if=%s",
+                dev_root_path (p_led->path, buf, sizeof(buf)));
+
+    if (subproc_run (argv, NVME_DD_TIMEOUT) == 0)
+        sync ();
+
+    res_lock_release (&set);
 }
 
-int led_check (int dev_id, char *resp)
+int led_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct led_grp *grp = dev_check_ctx_data (ctx, eGID_LED);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case eLED_POWER: case eLED_ALIVE:
-            if (!strncmp (DeviceLED[id].path, "none", strlen("none"))) {
+            if (!strncmp (grp->led[id].path, "none", strlen("none"))) {
                 status = 1;
                 value  = DEVICE_ACTION(dev_id);
             } else {
@@ -199,23 +204,26 @@ int led_check (int dev_id, char *resp)
 
                 memset (w_value, 0, sizeof(w_value));
 
-                if (DEVICE_ACTION(dev_id) == 1) sprintf (w_value, "%d", DeviceLED[id].on_value);
-                else                            sprintf (w_value, "%d", DeviceLED[id].off_value);
+                if (DEVICE_ACTION(dev_id) == 1) sprintf (w_value, "%d", grp->led[id].on_value);
+                else                            sprintf (w_value, "%d", grp->led[id].off_value);
 
-                value  = led_write (DeviceLED[id].path, w_value);
-                status = (value == led_read (DeviceLED[id].path)) ? 1 : -1;
+                value  = led_write (grp->led[id].path, w_value);
+                status = (value == led_read (grp->led[id].path)) ? 1 : -1;
             }
             break;
 
         case eLED_100M: case eLED_1G:
-            value  = DEVICE_ACTION(dev_id) ? DeviceLED[id].on_value : DeviceLED[id].off_value;
-            status = ethernet_link_setup (dev_id, value) ? 1 : -1;
+            value  = DEVICE_ACTION(dev_id) ? grp->led[id].on_value : grp->led[id].off_value;
+            status = ethernet_link_setup (grp, dev_id, value) ? 1 : -1;
             break;
 
         case eLED_NVME:
-            while (ThreadRunning)   sleep (1);
-            if (access (DeviceLED[id].path, F_OK) == 0) {
-                if (DEVICE_ACTION(dev_id) == 1) pthread_create (&thread_led, NULL, thread_func_led, &DeviceLED[id]);
+            // previous read (activity) finished
+            worker_future_wait (&grp->job);
+            if (dev_root_access (grp->led[id].path, F_OK) == 0) {
+                // the led blinks while dd reads, the check does not wait
+                if (DEVICE_ACTION(dev_id) == 1)
+                    worker_future_submit (&grp->job, thread_func_led, grp, WORKER_LONG);
                 status =  1;
             }
             else
@@ -230,57 +238,58 @@ int led_check (int dev_id, char *resp)
         char resp_str[DEVICE_RESP_SIZE-2];
 
         memset  (resp_str, 0, sizeof(resp_str));
-        sprintf (resp_str, "%s-%d", DeviceLED[id].cname,
-            DEVICE_ACTION(dev_id) ? DeviceLED[id].max : DeviceLED[id].min);
+        sprintf (resp_str, "%s-%d", grp->led[id].cname,
+            DEVICE_ACTION(dev_id) ? grp->led[id].max : grp->led[id].min);
 
         DEVICE_RESP_FORM_STR (resp, 'C', resp_str);
 
     } else {
-        DEVICE_RESP_FORM_STR (resp, 'F', DeviceLED[id].cname);
+        DEVICE_RESP_FORM_STR (resp, 'F', grp->led[id].cname);
     }
 
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_LED, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void led_grp_init (char *cfg)
+void led_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct led_grp *grp = dev_check_ctx_data (ctx, eGID_LED);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case eLED_POWER: case eLED_ALIVE:
                 case eLED_100M: case eLED_1G: case eLED_NVME:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceLED[did].path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (grp->led[did].path, tok, strlen(tok));
 
                     // led on value
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceLED[did].on_value = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->led[did].on_value = atoi(tok);
 
                     // led off value
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceLED[did].off_value = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->led[did].off_value = atoi(tok);
 
                     // ADC port name
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DeviceLED[did].cname, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (grp->led[did].cname, tok, strlen(tok));
 
                     // led on ADC value
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceLED[did].max = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->led[did].max = atoi(tok);
 
                     // led off ADC value
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DeviceLED[did].min = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        grp->led[did].min = atoi(tok);
 
                     break;
                 case eLED_CFG:
-                    if ((tok = strtok (NULL, ",")) != NULL) {
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
                         char ctl_path [STR_PATH_LENGTH], ctl_str [STR_NAME_LENGTH];
 
                         memset (ctl_path, 0, sizeof(ctl_path));
@@ -288,9 +297,9 @@ void led_grp_init (char *cfg)
 
                         switch (atoi(tok)) {
                             case eLED_POWER: case eLED_ALIVE:
-                                if ((tok = strtok (NULL, ",")) != NULL)
+                                if ((tok = strtok_r (NULL, ",", &save)) != NULL)
                                     strncpy (ctl_path, tok, strlen(tok));
-                                if ((tok = strtok (NULL, ",")) != NULL)
+                                if ((tok = strtok_r (NULL, ",", &save)) != NULL)
                                     strncpy (ctl_str, tok, strlen(tok));
 
                                 led_write (ctl_path, ctl_str);
@@ -308,5 +317,29 @@ void led_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static int led_resp_check (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    pdata->status_i = led_data_check (ctx, pdata->did, pdata->resp_i);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void led_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct led_grp *grp = dev_check_ctx_data (ctx, eGID_LED);
+
+    // dd ends by itself (count blocks)
+    worker_future_wait (&grp->job);
+}
+
+//------------------------------------------------------------------------------
+static const struct dev_group GroupLED = {
+    "LED", eGID_LED, eGID_ETHERNET, sizeof(DeviceLED), &DeviceLED,
+    led_grp_init, led_check, led_resp_check, led_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupLED);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,45 +1,47 @@
-//------------------------------------------------------------------------------
-/**
- * @file led.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 2.0
- * @date 2024-11-21
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __LED_H__
-#define __LED_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the LED group.
-//------------------------------------------------------------------------------
-#define eLED_CFG    -1
-
-enum {
-    eLED_POWER,
-    eLED_ALIVE,
-    eLED_100M,  // ethrenet green
-    eLED_1G,    // ethrenet orange
-    eLED_NVME,  // NVME Active LED
-    eLED_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  led_data_check(int dev_id, int resp_i);
-extern int  led_check     (int dev_id, char *resp);
-extern void led_grp_init  (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __LED_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file led.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 2.0
+ * @date 2024-11-21
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __LED_H__
+#define __LED_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the LED group.
+//------------------------------------------------------------------------------
+#define eLED_CFG    -1
+
+enum {
+    eLED_POWER,
+    eLED_ALIVE,
+    eLED_100M,  // ethrenet green
+    eLED_1G,    // ethrenet orange
+    eLED_NVME,  // NVME Active LED
+    eLED_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  led_data_check(struct dev_check_ctx *ctx, int dev_id, int resp_i);
+extern int  led_check     (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void led_grp_init  (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __LED_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
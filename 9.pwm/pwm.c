@@ -51,7 +51,8 @@ struct device_pwm {
 // Configuration
 //
 //------------------------------------------------------------------------------
-struct device_pwm DevicePWM [ePWM_END] = {
+// default state of every dev_check_ctx
+static const struct device_pwm DevicePWM [ePWM_END] = {
     // PWM0
     { { 0, }, 0, 0, 0, { 0, }, 0, 0 },
     // PWM1
@@ -63,14 +64,8 @@ struct device_pwm DevicePWM [ePWM_END] = {
 static int pwm_read (const char *path)
 {
     char rdata[16];
-    FILE *fp;
 
-    memset (rdata, 0, sizeof (rdata));
-    // adc raw value get
-    if ((fp = fopen(path, "r")) != NULL) {
-        fread (rdata, 1, sizeof(rdata), fp);
-        fclose(fp);
-    }
+    sysfs_attr_read (path, rdata, sizeof(rdata));
 
     return atoi(rdata);
 }
@@ -78,13 +73,7 @@ static int pwm_read (const char *path)
 //------------------------------------------------------------------------------
 static int pwm_write (const char *path, const char *wdata)
 {
-    FILE *fp;
-
-    // adc raw value get
-    if ((fp = fopen(path, "w")) != NULL) {
-        fwrite (wdata, 1, strlen(wdata), fp);
-        fclose(fp);
-    }
+    sysfs_attr_write (path, wdata);
 
     return atoi(wdata);
 }
@@ -126,15 +115,16 @@ static void pwm_config (struct device_pwm *pwm)
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
-int pwm_data_check (int dev_id, int resp_i)
+int pwm_data_check (struct dev_check_ctx *ctx, int dev_id, int resp_i)
 {
+    struct device_pwm *pwm = dev_check_ctx_data (ctx, eGID_PWM);
     int status = 0, id = DEVICE_ID(dev_id);
     switch (id) {
         case ePWM_0: case ePWM_1:
             if (DEVICE_ACTION(dev_id))
-                status = (resp_i > DevicePWM[id].max) ? 1 : 0;    // pwm on
+                status = (resp_i > pwm[id].max) ? 1 : 0;    // pwm on
             else
-                status = (resp_i < DevicePWM[id].min) ? 1 : 0;    // pwm off
+                status = (resp_i < pwm[id].min) ? 1 : 0;    // pwm off
             break;
         default :
             status = 0;
@@ -144,61 +134,63 @@ int pwm_data_check (int dev_id, int resp_i)
 }
 
 //------------------------------------------------------------------------------
-int pwm_check (int dev_id, char *resp)
+int pwm_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
 {
+    struct device_pwm *pwm = dev_check_ctx_data (ctx, eGID_PWM);
     int value = 0, status = 0, id = DEVICE_ID(dev_id);
 
     switch (id) {
         case ePWM_0: case ePWM_1:
-            value  = pwm_enable (&DevicePWM[id], DEVICE_ACTION(dev_id) ? 1 : 0);
-            status = (value == pwm_read (DevicePWM[id].path)) ? 1 : -1;
+            value  = pwm_enable (&pwm[id], DEVICE_ACTION(dev_id) ? 1 : 0);
+            status = (value == pwm_read (pwm[id].path)) ? 1 : -1;
             break;
         default :
             break;
     }
-    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', DevicePWM[id].cname);
+    DEVICE_RESP_FORM_STR (resp, (status == 1) ? 'C' : 'F', pwm[id].cname);
 
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
+    DEV_LOG (eLOG_DEBUG, eGID_PWM, "%s : [size = %d] -> %s\n", __func__, (int)strlen(resp), resp);
     return status;
 }
 
 //------------------------------------------------------------------------------
-void pwm_grp_init (char *cfg)
+void pwm_grp_init (struct dev_check_ctx *ctx, char *cfg)
 {
-    char *tok;
+    struct device_pwm *pwm = dev_check_ctx_data (ctx, eGID_PWM);
+    char *tok, *save;
     int did;
 
-    if ((tok = strtok (cfg, ",")) != NULL) {
-        if ((tok = strtok (NULL, ",")) != NULL) {
+    if ((tok = strtok_r (cfg, ",", &save)) != NULL) {
+        if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
             did = atoi(tok);
             switch (did) {
                 case ePWM_0: case ePWM_1:
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DevicePWM[did].path, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (pwm[did].path, tok, strlen(tok));
 
                     // PWM Channel
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DevicePWM[did].pwm_ch = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        pwm[did].pwm_ch = atoi(tok);
 
                     // PWM Period
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DevicePWM[did].period = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        pwm[did].period = atoi(tok);
                     // PWM Duty
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DevicePWM[did].duty = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        pwm[did].duty = atoi(tok);
 
                     // ADC con name
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        strncpy (DevicePWM[did].cname, tok, strlen(tok));
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        strncpy (pwm[did].cname, tok, strlen(tok));
                     // ADC max
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DevicePWM[did].max = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        pwm[did].max = atoi(tok);
                     // ADC min
-                    if ((tok = strtok (NULL, ",")) != NULL)
-                        DevicePWM[did].min = atoi(tok);
+                    if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                        pwm[did].min = atoi(tok);
 
                     // pwm config (export pwm_ch, peroid, duty)
-                    pwm_config (&DevicePWM[did]);
+                    pwm_config (&pwm[did]);
                     break;
 
                 default :
@@ -209,5 +201,13 @@ void pwm_grp_init (char *cfg)
     }
 }
 
+//------------------------------------------------------------------------------
+static const struct dev_group GroupPWM = {
+    "PWM", eGID_PWM, eGID_PWM, sizeof(DevicePWM), DevicePWM,
+    pwm_grp_init, pwm_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupPWM);
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -1,42 +1,44 @@
-//------------------------------------------------------------------------------
-/**
- * @file pwm.h
- * @author charles-park (charles.park@hardkernel.com)
- * @brief Device Test library for ODROID-JIG.
- * @version 0.2
- * @date 2023-10-12
- *
- * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
- *
- * @copyright Copyright (c) 2022
- *
- */
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#ifndef __PWM_H__
-#define __PWM_H__
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-// Define the Device ID for the PWM group.
-//------------------------------------------------------------------------------
-enum {
-    // PWM0
-    ePWM_0,
-    // PWM1
-    ePWM_1,
-    ePWM_END
-};
-
-//------------------------------------------------------------------------------
-// function prototype
-//------------------------------------------------------------------------------
-extern int  pwm_data_check  (int dev_id, int resp_i);
-extern int  pwm_check       (int dev_id, char *resp);
-extern void pwm_grp_init    (char *cfg);
-
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-#endif  // #define __PWM_H__
-//------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/**
+ * @file pwm.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG.
+ * @version 0.2
+ * @date 2023-10-12
+ *
+ * @package apt install iperf3, nmap, ethtool, usbutils, alsa-utils
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __PWM_H__
+#define __PWM_H__
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// Define the Device ID for the PWM group.
+//------------------------------------------------------------------------------
+enum {
+    // PWM0
+    ePWM_0,
+    // PWM1
+    ePWM_1,
+    ePWM_END
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  pwm_data_check  (struct dev_check_ctx *ctx, int dev_id, int resp_i);
+extern int  pwm_check       (struct dev_check_ctx *ctx, int dev_id, char *resp);
+extern void pwm_grp_init    (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __PWM_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,315 @@
+//------------------------------------------------------------------------------
+/**
+ * @file lib_dev_bench.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (hot path microbenchmarks)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+
+//------------------------------------------------------------------------------
+// make bench : every benchmark prints one CSV line (fixed names and order)
+//
+//   name,iterations,ns_op
+//
+// ns_op is the best of BENCH_ROUNDS rounds. -b {old result} compares every
+// line with a saved run and exits 1 when one is slower than -t {percent}.
+//------------------------------------------------------------------------------
+#define BENCH_ROUNDS        5
+#define BENCH_THRESHOLD     20
+#define BENCH_NAME_MAX      32
+#define BENCH_ITEM_MAX      32
+
+// stub group (check returns at once) : dispatch cost only
+#define BENCH_GID           89
+
+struct bench_item {
+    const char *name;
+    long iters;
+    void (*func) (long n);
+};
+
+struct bench_result {
+    char name[BENCH_NAME_MAX];
+    double ns_op;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct dev_check_ctx *BenchCTX  = NULL;
+static struct dev_check_ctx *CachedCTX = NULL;
+
+// keeps results alive (no dead code elimination)
+static volatile int BenchSink = 0;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static int bench_stub_check (struct dev_check_ctx *ctx, int dev_id, char *resp)
+{
+    (void)ctx;
+    DEVICE_RESP_FORM_INT (resp, 'P', dev_id);
+    return 1;
+}
+
+static const struct dev_group GroupBENCH = {
+    "BENCH", BENCH_GID, BENCH_GID, 0, NULL,
+    NULL, bench_stub_check, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupBENCH);
+
+//------------------------------------------------------------------------------
+static long long bench_nsec (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static void bench_parse_frame (long n)
+{
+    parse_resp_data_t pdata;
+    long i;
+
+    for (i = 0; i < n; i++) {
+        BenchSink += device_resp_parse ("@,S,04,0001,P,                1358,#", &pdata);
+        BenchSink += pdata.resp_i;
+    }
+}
+
+//------------------------------------------------------------------------------
+static void bench_parse_resp (long n)
+{
+    parse_resp_data_t pdata;
+    long i;
+
+    for (i = 0; i < n; i++) {
+        BenchSink += device_resp_parse ("C,          P1_6.3-600", &pdata);
+        BenchSink += pdata.status_c;
+    }
+}
+
+//------------------------------------------------------------------------------
+static void bench_serial_form (long n)
+{
+    char buf[SERIAL_RESP_SIZE +1];
+    long i;
+
+    for (i = 0; i < n; i++) {
+        SERIAL_RESP_FORM (buf, RESP_CMD_STATUS, 4, (int)(i & 0xff), "P,                1358");
+        BenchSink += buf[SERIAL_RESP_SIZE -1];
+    }
+}
+
+//------------------------------------------------------------------------------
+static void bench_form_int (long n)
+{
+    char buf[DEVICE_RESP_SIZE +1];
+    long i;
+
+    for (i = 0; i < n; i++) {
+        DEVICE_RESP_FORM_INT (buf, 'P', (int)i);
+        BenchSink += buf[DEVICE_RESP_SIZE -1];
+    }
+}
+
+//------------------------------------------------------------------------------
+static void bench_form_str (long n)
+{
+    char buf[DEVICE_RESP_SIZE +1];
+    long i;
+
+    for (i = 0; i < n; i++) {
+        DEVICE_RESP_FORM_STR (buf, 'C', "P1_6.3-600");
+        BenchSink += buf[DEVICE_RESP_SIZE -1];
+    }
+}
+
+//------------------------------------------------------------------------------
+// header 40 pin pattern 1 (0,1,0,1 ...) : every pin pair reads '2'
+//------------------------------------------------------------------------------
+static void bench_header_data (long n)
+{
+    char resp_s[] = "22222222222222222222";
+    long i;
+
+    for (i = 0; i < n; i++)
+        BenchSink += header_data_check (BenchCTX, eHEADER_40 + 10, resp_s);
+}
+
+//------------------------------------------------------------------------------
+static void bench_dispatch (long n)
+{
+    char resp[DEVICE_RESP_SIZE +1];
+    long i;
+
+    for (i = 0; i < n; i++)
+        BenchSink += device_check_ctx (BenchCTX, BENCH_GID, (int)(i % 10), resp);
+}
+
+//------------------------------------------------------------------------------
+static void bench_dispatch_cached (long n)
+{
+    char resp[DEVICE_RESP_SIZE +1];
+    long i;
+
+    for (i = 0; i < n; i++)
+        BenchSink += device_check_ctx (CachedCTX, BENCH_GID, 0, resp);
+}
+
+//------------------------------------------------------------------------------
+static const struct bench_item BenchItem[] = {
+    { "resp_parse_frame",   1000000, bench_parse_frame      },
+    { "resp_parse_resp",    1000000, bench_parse_resp       },
+    { "serial_resp_form",   1000000, bench_serial_form      },
+    { "device_resp_form_int",1000000, bench_form_int        },
+    { "device_resp_form_str",1000000, bench_form_str        },
+    { "header_data_check",  1000000, bench_header_data      },
+    { "device_check",        200000, bench_dispatch         },
+    { "device_check_cached", 200000, bench_dispatch_cached  },
+    { NULL, 0, NULL },
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static double bench_run (const struct bench_item *item, long iters)
+{
+    long long start, ns, best = -1;
+    int round;
+
+    // warm up (caches, first lookups)
+    item->func (iters / 10 + 1);
+
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        start = bench_nsec ();
+        item->func (iters);
+        ns = bench_nsec () - start;
+        if ((best < 0) || (ns < best))
+            best = ns;
+    }
+    return (double)best / iters;
+}
+
+//------------------------------------------------------------------------------
+static int bench_load (const char *fname, struct bench_result *res)
+{
+    char line[STR_PATH_LENGTH], *tok, *save;
+    FILE *fp;
+    int cnt = 0;
+
+    if ((fp = fopen (fname, "r")) == NULL) {
+        printf ("%s : %s open error!\n", __func__, fname);
+        return -1;
+    }
+    while ((cnt < BENCH_ITEM_MAX) && (fgets (line, sizeof(line), fp) != NULL)) {
+        if ((line[0] == '#') || ((tok = strtok_r (line, ",", &save)) == NULL))
+            continue;
+        memset  (res[cnt].name, 0, sizeof(res[cnt].name));
+        strncpy (res[cnt].name, tok, sizeof(res[cnt].name) -1);
+        // iterations, ns_op
+        if (strtok_r (NULL, ",", &save) == NULL)
+            continue;
+        if ((tok = strtok_r (NULL, ",", &save)) == NULL)
+            continue;
+        res[cnt++].ns_op = atof (tok);
+    }
+    fclose (fp);
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+static void bench_setup (void)
+{
+    char cfg[] = "CACHE,89,-1,-,0,";
+
+    // DEV_LOG lines would go to stdout (the result)
+    dev_log_set_level (eLOG_ERR);
+
+    if (((BenchCTX = dev_check_ctx_alloc ()) == NULL) ||
+        ((CachedCTX = dev_check_ctx_alloc ()) == NULL)) {
+        printf ("%s : context alloc error!\n", __func__);
+        exit (1);
+    }
+    // result cache for the stub group (did 0)
+    check_cache_grp_init (CachedCTX, cfg);
+}
+
+//------------------------------------------------------------------------------
+static void print_usage (const char *prog)
+{
+    printf ("Usage: %s [-n:iterations] [-b:old result] [-t:percent]\n", prog);
+    puts ("\n"
+          "  -n    iterations of every benchmark (default : per benchmark)\n"
+          "  -b    compare with a saved result, exit 1 on a regression\n"
+          "  -t    regression threshold in percent (default 20)\n"
+          "\n"
+          "  e.g) make bench > bench.csv, then (later) make bench BENCH_OPT=\"-b bench.csv\"\n"
+    );
+    exit (1);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+    struct bench_result base[BENCH_ITEM_MAX];
+    const struct bench_item *item;
+    const char *base_fname = NULL;
+    int base_cnt = 0, threshold = BENCH_THRESHOLD, regress = 0, c, i;
+    long iters = 0;
+    double ns_op;
+
+    while ((c = getopt (argc, argv, "n:b:t:h")) != -1) {
+        switch (c) {
+            case 'n':   iters      = atol (optarg);  break;
+            case 'b':   base_fname = optarg;         break;
+            case 't':   threshold  = atoi (optarg);  break;
+            default :   print_usage (argv[0]);       break;
+        }
+    }
+    if ((base_fname != NULL) && ((base_cnt = bench_load (base_fname, base)) < 0))
+        return 1;
+
+    bench_setup ();
+
+    printf ("# lib_dev_bench : name,iterations,ns_op (best of %d)\n", BENCH_ROUNDS);
+    for (item = BenchItem; item->name != NULL; item++) {
+        long n = iters ? iters : item->iters;
+
+        ns_op = bench_run (item, n);
+        printf ("%s,%ld,%.1f\n", item->name, n, ns_op);
+        fflush (stdout);
+
+        for (i = 0; i < base_cnt; i++) {
+            if (strcmp (base[i].name, item->name) || (base[i].ns_op <= 0))
+                continue;
+            if (ns_op > base[i].ns_op * (100 + threshold) / 100) {
+                fprintf (stderr, "%s : regression %s %.1f -> %.1f ns/op (+%.0f%%)\n",
+                    __func__, item->name, base[i].ns_op, ns_op,
+                    (ns_op / base[i].ns_op - 1) * 100);
+                regress++;
+            }
+        }
+    }
+    return regress ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,363 @@
+//------------------------------------------------------------------------------
+/**
+ * @file cfg_cache.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (compiled config cache)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "cfg_cache.h"
+
+//------------------------------------------------------------------------------
+// image : header, records[rec_cnt], paths[path_cnt] (all 4 byte aligned)
+//------------------------------------------------------------------------------
+#define CFG_CACHE_ALIGN(x)  (((x) + 3u) & ~3u)
+
+struct cfg_cache_hdr {
+    char     magic[8];
+    uint32_t version;
+    uint32_t rec_cnt;
+    uint32_t path_cnt;
+    // image size (header included)
+    uint32_t size;
+
+    // source identity
+    int64_t  src_mtime_sec;
+    int64_t  src_mtime_nsec;
+    int64_t  src_size;
+    uint64_t src_hash;
+    char     src_path[PATH_MAX];
+};
+
+struct cfg_cache_rec {
+    uint32_t gid;
+    int32_t  did;
+    // line length (with '\0')
+    uint32_t len;
+    char     line[];
+};
+
+struct cfg_cache_path {
+    // path length (with '\0')
+    uint32_t len;
+    char     path[];
+};
+
+// records / paths collected while device_setup parses the text config
+// (dev_check_ctx.cfg_build, one per context)
+struct cfg_cache_build {
+    char    *buf;
+    uint32_t len, size;
+    uint32_t rec_cnt, path_cnt;
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static uint64_t file_hash (const char *path)
+{
+    uint64_t hash = DEV_FNV64_INIT;
+    unsigned char buf[4096];
+    ssize_t len;
+    int fd;
+
+    if ((fd = open (path, O_RDONLY)) < 0)
+        return 0;
+
+    while ((len = read (fd, buf, sizeof(buf))) > 0)
+        hash = dev_fnv64 (hash, buf, len);
+    close (fd);
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+// cache file in the working directory :
+//   path (has '/') : '{basename}.{FNV-1a of the real path}.cache', so configs
+//                    of the same name in other trees never share an image
+//   name           : '{name}.cache' (found by the file search)
+// real : real path of a path argument, "" for a name. return 0 : not found
+//------------------------------------------------------------------------------
+static int cache_name (const char *cfg_fname, char *real, char *name, int size)
+{
+    const char *base = strrchr (cfg_fname, '/');
+
+    real[0] = 0;
+    if (base == NULL) {
+        snprintf (name, size, "%s%s", cfg_fname, CFG_CACHE_SUFFIX);
+        return 1;
+    }
+    if (realpath (cfg_fname, real) == NULL)
+        return 0;
+
+    snprintf (name, size, "%s.%08x%s", base + 1,
+              dev_fnv32_str (DEV_FNV32_INIT, real), CFG_CACHE_SUFFIX);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int build_put (struct cfg_cache_build *b, const void *data, uint32_t len)
+{
+    uint32_t need = CFG_CACHE_ALIGN(b->len + len);
+
+    if (need > b->size) {
+        uint32_t size = b->size ? b->size : 4096;
+        char *buf;
+
+        while (size < need)
+            size *= 2;
+        if ((buf = realloc (b->buf, size)) == NULL)
+            return 0;
+
+        b->buf  = buf;
+        b->size = size;
+    }
+    memcpy (&b->buf[b->len], data, len);
+    // zero padding
+    memset (&b->buf[b->len + len], 0, need - b->len - len);
+    b->len = need;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void build_path (const char *path, void *arg)
+{
+    struct cfg_cache_build *b = (struct cfg_cache_build *)arg;
+    struct cfg_cache_path p;
+
+    p.len = strlen (path) + 1;
+    if (build_put (b, &p, sizeof(p)) && build_put (b, path, p.len))
+        b->path_cnt++;
+}
+
+//------------------------------------------------------------------------------
+// real : config real path ("" = a name, the image source must have that name)
+// return 1 : image matches the source and the registered groups
+//------------------------------------------------------------------------------
+static int image_valid (const char *img, uint32_t size, const char *cfg_fname, const char *real)
+{
+    const struct cfg_cache_hdr *hdr = (const struct cfg_cache_hdr *)img;
+    const struct dev_group *grp;
+    struct stat st;
+    uint32_t pos, i;
+
+    if ((size < sizeof(*hdr)) || memcmp (hdr->magic, CFG_CACHE_MAGIC, sizeof(hdr->magic)) ||
+        (hdr->version != CFG_CACHE_VERSION) || (hdr->size != size))
+        return 0;
+
+    if (memchr (hdr->src_path, 0, sizeof(hdr->src_path)) == NULL)
+        return 0;
+
+    // image of this config ? (not of another one with the same name)
+    if (real[0]) {
+        if (strcmp (hdr->src_path, real))
+            return 0;
+    } else {
+        const char *base = strrchr (hdr->src_path, '/');
+
+        if (strcmp (base ? base + 1 : hdr->src_path, cfg_fname))
+            return 0;
+    }
+
+    // source changed ? (same mtime/size : no need to read it)
+    if (stat (hdr->src_path, &st))
+        return 0;
+    if ((st.st_mtim.tv_sec != hdr->src_mtime_sec) || (st.st_mtim.tv_nsec != hdr->src_mtime_nsec) ||
+        (st.st_size != hdr->src_size)) {
+        if (file_hash (hdr->src_path) != hdr->src_hash)
+            return 0;
+    }
+
+    // records : in bounds, known gid, line starts with the group name
+    for (pos = sizeof(*hdr), i = 0; i < hdr->rec_cnt; i++) {
+        const struct cfg_cache_rec *rec = (const struct cfg_cache_rec *)&img[pos];
+
+        if ((pos + sizeof(*rec) > size) || (rec->len == 0) || (rec->len > STR_PATH_LENGTH) ||
+            (pos + sizeof(*rec) + rec->len > size) || rec->line[rec->len -1])
+            return 0;
+        if (((grp = device_group_find (rec->gid)) == NULL) ||
+            strncmp (rec->line, grp->name, strlen (grp->name)))
+            return 0;
+
+        pos += CFG_CACHE_ALIGN(sizeof(*rec) + rec->len);
+    }
+    for (i = 0; i < hdr->path_cnt; i++) {
+        const struct cfg_cache_path *p = (const struct cfg_cache_path *)&img[pos];
+
+        if ((pos + sizeof(*p) > size) || (p->len == 0) ||
+            (pos + sizeof(*p) + p->len > size) || p->path[p->len -1])
+            return 0;
+
+        pos = CFG_CACHE_ALIGN(pos + sizeof(*p) + p->len);
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//
+// return 1 : config lines queued from the cache, 0 : no (valid) cache
+//
+//------------------------------------------------------------------------------
+int cfg_cache_load (struct dev_check_ctx *ctx, const char *cfg_fname)
+{
+    const struct cfg_cache_hdr *hdr;
+    char name[PATH_MAX], real[PATH_MAX], *img;
+    struct stat st;
+    uint32_t pos, i;
+    int fd, ret = 0;
+
+    if (!cache_name (cfg_fname, real, name, sizeof(name)))
+        return 0;
+
+    if ((fd = open (name, O_RDONLY)) < 0)
+        return 0;
+    if (fstat (fd, &st) || (st.st_size < (off_t)sizeof(*hdr)) || (st.st_size > UINT32_MAX)) {
+        close (fd);
+        return 0;
+    }
+    img = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (img == MAP_FAILED)
+        return 0;
+
+    hdr = (const struct cfg_cache_hdr *)img;
+    if (!image_valid (img, (uint32_t)st.st_size, cfg_fname, real))
+        goto out;
+
+    // skip the records, seed the resolver with the paths found last time
+    for (pos = sizeof(*hdr), i = 0; i < hdr->rec_cnt; i++)
+        pos += CFG_CACHE_ALIGN(sizeof(struct cfg_cache_rec) +
+                               ((const struct cfg_cache_rec *)&img[pos])->len);
+
+    for (i = 0; i < hdr->path_cnt; i++) {
+        const struct cfg_cache_path *p = (const struct cfg_cache_path *)&img[pos];
+
+        // file moved or removed : rebuild from the text config
+        if (!file_path_seed (p->path))
+            goto out;
+        pos = CFG_CACHE_ALIGN(pos + sizeof(*p) + p->len);
+    }
+
+    // queue the lines, device_setup starts the group init
+    for (pos = sizeof(*hdr), i = 0; i < hdr->rec_cnt; i++) {
+        const struct cfg_cache_rec *rec = (const struct cfg_cache_rec *)&img[pos];
+
+        device_group_init_add (ctx, rec->gid, rec->line);
+        pos += CFG_CACHE_ALIGN(sizeof(*rec) + rec->len);
+    }
+    ret = 1;
+out:
+    munmap (img, st.st_size);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+void cfg_cache_begin (struct dev_check_ctx *ctx)
+{
+    struct cfg_cache_hdr hdr;
+
+    free (ctx->cfg_build ? ctx->cfg_build->buf : NULL);
+    free (ctx->cfg_build);
+    if ((ctx->cfg_build = calloc (1, sizeof(struct cfg_cache_build))) == NULL)
+        return;
+
+    // header is filled by cfg_cache_save
+    memset (&hdr, 0, sizeof(hdr));
+    build_put (ctx->cfg_build, &hdr, sizeof(hdr));
+}
+
+//------------------------------------------------------------------------------
+// one config line, before init (init modifies the line)
+//------------------------------------------------------------------------------
+void cfg_cache_add (struct dev_check_ctx *ctx, int gid, const char *line)
+{
+    struct cfg_cache_build *b = ctx->cfg_build;
+    struct cfg_cache_rec rec;
+    const char *ptr;
+
+    if ((b == NULL) || !b->len)
+        return;
+
+    rec.gid = gid;
+    rec.did = (ptr = strchr (line, ',')) != NULL ? atoi (ptr + 1) : -1;
+    rec.len = strlen (line) + 1;
+
+    // rec header is 4 byte aligned, line follows it directly
+    if ((rec.len > STR_PATH_LENGTH) || !build_put (b, &rec, sizeof(rec)))
+        return;
+    if (build_put (b, line, rec.len))
+        b->rec_cnt++;
+}
+
+//------------------------------------------------------------------------------
+//
+// write the image collected since cfg_cache_begin.
+// return 1 : cache saved, 0 : not saved (device_setup works without it)
+//
+//------------------------------------------------------------------------------
+int cfg_cache_save (struct dev_check_ctx *ctx, const char *cfg_fname, const char *src_path)
+{
+    struct cfg_cache_build *b = ctx->cfg_build;
+    struct cfg_cache_hdr *hdr;
+    char name[PATH_MAX], real[PATH_MAX], tmp[PATH_MAX + 8];
+    struct stat st;
+    int fd, ret = 0;
+
+    if ((b == NULL) || !b->len || (realpath (src_path, name) == NULL) || stat (name, &st))
+        goto out;
+
+    file_path_used (build_path, b);
+
+    hdr = (struct cfg_cache_hdr *)b->buf;
+    memcpy (hdr->magic, CFG_CACHE_MAGIC, sizeof(hdr->magic));
+    hdr->version        = CFG_CACHE_VERSION;
+    hdr->rec_cnt        = b->rec_cnt;
+    hdr->path_cnt       = b->path_cnt;
+    hdr->size           = b->len;
+    hdr->src_mtime_sec  = st.st_mtim.tv_sec;
+    hdr->src_mtime_nsec = st.st_mtim.tv_nsec;
+    hdr->src_size       = st.st_size;
+    hdr->src_hash       = file_hash (name);
+    strncpy (hdr->src_path, name, sizeof(hdr->src_path) -1);
+
+    // write + rename : a reader never sees a partial image
+    if (!cache_name (cfg_fname, real, name, sizeof(name)))
+        goto out;
+    snprintf (tmp, sizeof(tmp), "%s.tmp", name);
+
+    if ((fd = open (tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+        goto out;
+
+    if (write (fd, b->buf, b->len) == (ssize_t)b->len)
+        ret = 1;
+    close (fd);
+
+    if (!ret || rename (tmp, name)) {
+        unlink (tmp);
+        ret = 0;
+    }
+out:
+    if (b != NULL)
+        free (b->buf);
+    free (b);
+    ctx->cfg_build = NULL;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
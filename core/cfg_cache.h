@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------------
+/**
+ * @file cfg_cache.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (compiled config cache)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CFG_CACHE_H__
+#define __CFG_CACHE_H__
+
+//------------------------------------------------------------------------------
+// The first device_setup() compiles the config into '{cfg_fname}.cache'
+// ('{basename}.{path hash}.cache' for a path, see cache_name()) : one record
+// per valid config line (gid, did, line) and every file path the groups
+// resolved while parsing. The image is only used for the config it was
+// built from (real path, or the searched name). Later starts mmap the image, check it against
+// the source (mtime/size, then FNV-1a hash) and queue the group init straight
+// from the records. A changed source or a missing resolved file rebuilds it.
+//------------------------------------------------------------------------------
+#define CFG_CACHE_SUFFIX    ".cache"
+#define CFG_CACHE_MAGIC     "DEVCFG01"
+#define CFG_CACHE_VERSION   1
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  cfg_cache_load      (struct dev_check_ctx *ctx, const char *cfg_fname);
+extern void cfg_cache_begin     (struct dev_check_ctx *ctx);
+extern void cfg_cache_add       (struct dev_check_ctx *ctx, int gid, const char *line);
+extern int  cfg_cache_save      (struct dev_check_ctx *ctx, const char *cfg_fname, const char *src_path);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CFG_CACHE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
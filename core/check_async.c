@@ -0,0 +1,288 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_async.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (async submit/poll/complete)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "check_async.h"
+
+//------------------------------------------------------------------------------
+struct async_slot {
+    // 0 = free slot
+    int ticket;
+    int gid, did;
+
+    int done;
+    int status;
+    char resp[DEVICE_RESP_SIZE +1];
+};
+
+struct async_ctl {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    struct async_slot slot[ASYNC_SLOT_MAX];
+    int next_ticket;
+
+    // completion queue (finished tickets, oldest first)
+    int cq[ASYNC_SLOT_MAX];
+    int cq_head, cq_cnt;
+
+    // +1 per finished check (epoll / poll users), -1 = not created
+    int event_fd;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct async_ctl AsyncCTL;
+static pthread_once_t   AsyncOnce = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static void async_init (void)
+{
+    pthread_condattr_t attr;
+
+    memset (&AsyncCTL, 0, sizeof(AsyncCTL));
+    pthread_mutex_init (&AsyncCTL.mutex, NULL);
+
+    // timed wait must not jump with the wall clock
+    pthread_condattr_init     (&attr);
+    pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+    pthread_cond_init         (&AsyncCTL.cond, &attr);
+    pthread_condattr_destroy  (&attr);
+
+    if ((AsyncCTL.event_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+        printf ("%s : eventfd error!\n", __func__);
+}
+
+//------------------------------------------------------------------------------
+static struct async_slot *slot_find (int ticket)
+{
+    int i;
+
+    if (ticket <= 0)
+        return NULL;
+
+    for (i = 0; i < ASYNC_SLOT_MAX; i++)
+        if (AsyncCTL.slot[i].ticket == ticket)
+            return &AsyncCTL.slot[i];
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void cq_push (int ticket)
+{
+    // full : drop the oldest entry, its result is still kept in the slot
+    if (AsyncCTL.cq_cnt == ASYNC_SLOT_MAX) {
+        AsyncCTL.cq_head = (AsyncCTL.cq_head + 1) % ASYNC_SLOT_MAX;
+        AsyncCTL.cq_cnt--;
+    }
+    AsyncCTL.cq[(AsyncCTL.cq_head + AsyncCTL.cq_cnt) % ASYNC_SLOT_MAX] = ticket;
+    AsyncCTL.cq_cnt++;
+}
+
+//------------------------------------------------------------------------------
+// slot result -> caller, slot release. (mutex locked)
+//------------------------------------------------------------------------------
+static void slot_take (struct async_slot *slot, char *resp, int *status)
+{
+    if (resp)   memcpy (resp, slot->resp, DEVICE_RESP_SIZE +1);
+    if (status) *status = slot->status;
+
+    memset (slot, 0, sizeof(struct async_slot));
+}
+
+//------------------------------------------------------------------------------
+static void async_job (void *arg)
+{
+    struct async_slot *slot = (struct async_slot *)arg;
+    char resp[DEVICE_RESP_SIZE +1];
+    int gid, did, ticket, status;
+
+    pthread_mutex_lock   (&AsyncCTL.mutex);
+    gid = slot->gid;    did = slot->did;    ticket = slot->ticket;
+    pthread_mutex_unlock (&AsyncCTL.mutex);
+
+    memset (resp, 0, sizeof(resp));
+    status = device_check (gid, did, resp);
+
+    pthread_mutex_lock   (&AsyncCTL.mutex);
+    memcpy (slot->resp, resp, sizeof(resp));
+    slot->status = status;
+    slot->done   = 1;
+    cq_push (ticket);
+    pthread_cond_broadcast (&AsyncCTL.cond);
+    pthread_mutex_unlock   (&AsyncCTL.mutex);
+
+    if (AsyncCTL.event_fd >= 0) {
+        unsigned long long one = 1;
+
+        if (write (AsyncCTL.event_fd, &one, sizeof(one)) != sizeof(one))
+            printf ("%s : eventfd write error!\n", __func__);
+    }
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+int device_check_submit (int gid, int did)
+{
+    struct async_slot *slot = NULL;
+    int i, ticket;
+
+    pthread_once (&AsyncOnce, async_init);
+
+    pthread_mutex_lock (&AsyncCTL.mutex);
+    for (i = 0; i < ASYNC_SLOT_MAX; i++) {
+        if (!AsyncCTL.slot[i].ticket) {
+            slot = &AsyncCTL.slot[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        pthread_mutex_unlock (&AsyncCTL.mutex);
+        printf ("%s : error! no free slot (gid = %d, did = %d)\n", __func__, gid, did);
+        return 0;
+    }
+
+    if (AsyncCTL.next_ticket == INT_MAX)
+        AsyncCTL.next_ticket = 0;
+    ticket = ++AsyncCTL.next_ticket;
+
+    memset (slot, 0, sizeof(struct async_slot));
+    slot->ticket = ticket;
+    slot->gid    = gid;
+    slot->did    = did;
+    pthread_mutex_unlock (&AsyncCTL.mutex);
+
+    if (!worker_submit (async_job, slot)) {
+        pthread_mutex_lock   (&AsyncCTL.mutex);
+        memset (slot, 0, sizeof(struct async_slot));
+        pthread_mutex_unlock (&AsyncCTL.mutex);
+        return 0;
+    }
+    return ticket;
+}
+
+//------------------------------------------------------------------------------
+int device_check_poll (int ticket, char *resp, int *status)
+{
+    return device_check_wait (ticket, resp, status, 0);
+}
+
+//------------------------------------------------------------------------------
+int device_check_wait (int ticket, char *resp, int *status, int timeout_ms)
+{
+    struct async_slot *slot;
+    struct timespec ts;
+    int ret = -1;
+
+    pthread_once (&AsyncOnce, async_init);
+
+    if (timeout_ms > 0)
+        dev_abs_timeout (&ts, timeout_ms);
+
+    pthread_mutex_lock (&AsyncCTL.mutex);
+    while ((slot = slot_find (ticket)) != NULL) {
+        if (slot->done) {
+            slot_take (slot, resp, status);
+            ret = 1;
+            break;
+        }
+        ret = 0;
+        if (!timeout_ms)
+            break;
+
+        if (timeout_ms < 0)
+            pthread_cond_wait (&AsyncCTL.cond, &AsyncCTL.mutex);
+        else if (pthread_cond_timedwait (&AsyncCTL.cond, &AsyncCTL.mutex, &ts))
+            break;
+    }
+    pthread_mutex_unlock (&AsyncCTL.mutex);
+
+    if (!ret) {
+        if (resp)   DEVICE_RESP_FORM_STR (resp, 'W', "");
+        if (status) *status = 0;
+    }
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//
+// return : finished ticket (resp, status = result), 0 = nothing finished
+//
+//------------------------------------------------------------------------------
+int device_check_complete (char *resp, int *status, int timeout_ms)
+{
+    struct async_slot *slot;
+    struct timespec ts;
+    int ticket = 0;
+
+    pthread_once (&AsyncOnce, async_init);
+
+    if (timeout_ms > 0)
+        dev_abs_timeout (&ts, timeout_ms);
+
+    pthread_mutex_lock (&AsyncCTL.mutex);
+    while (1) {
+        while (AsyncCTL.cq_cnt) {
+            int t = AsyncCTL.cq[AsyncCTL.cq_head];
+
+            AsyncCTL.cq_head = (AsyncCTL.cq_head + 1) % ASYNC_SLOT_MAX;
+            AsyncCTL.cq_cnt--;
+
+            // skip tickets already read with poll/wait
+            if (((slot = slot_find (t)) != NULL) && slot->done) {
+                slot_take (slot, resp, status);
+                ticket = t;
+                break;
+            }
+        }
+        if (ticket || !timeout_ms)
+            break;
+
+        if (timeout_ms < 0)
+            pthread_cond_wait (&AsyncCTL.cond, &AsyncCTL.mutex);
+        else if (pthread_cond_timedwait (&AsyncCTL.cond, &AsyncCTL.mutex, &ts))
+            break;
+    }
+    pthread_mutex_unlock (&AsyncCTL.mutex);
+
+    return ticket;
+}
+
+//------------------------------------------------------------------------------
+//
+// readable (counter > 0) after a check finished. The reader clears it with
+// read() and drains device_check_complete(..., 0). return : fd, -1 = error
+//
+//------------------------------------------------------------------------------
+int device_check_event_fd (void)
+{
+    pthread_once (&AsyncOnce, async_init);
+
+    return AsyncCTL.event_fd;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
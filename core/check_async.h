@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_async.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (async submit/poll/complete)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CHECK_ASYNC_H__
+#define __CHECK_ASYNC_H__
+
+//------------------------------------------------------------------------------
+// device_check_submit() runs device_check() on the worker pool and returns a
+// ticket (> 0). The result stays in its slot until it is read once with
+// device_check_poll(), device_check_wait() or device_check_complete().
+//
+// poll / wait return : 1 = done (resp, status = device_check result),
+//                      0 = running (resp = 'W' status),
+//                     -1 = unknown ticket
+//
+// device_check_event_fd() is an eventfd for an event loop, it becomes
+// readable when a check finished.
+//------------------------------------------------------------------------------
+#define ASYNC_SLOT_MAX      64
+
+// timeout_ms value for wait forever
+#define ASYNC_WAIT_FOREVER  -1
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  device_check_submit     (int gid, int did);
+extern int  device_check_poll       (int ticket, char *resp, int *status);
+extern int  device_check_wait       (int ticket, char *resp, int *status, int timeout_ms);
+extern int  device_check_complete   (char *resp, int *status, int timeout_ms);
+extern int  device_check_event_fd   (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CHECK_ASYNC_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,386 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_cache.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (check result cache)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "check_cache.h"
+
+//------------------------------------------------------------------------------
+struct cache_entry {
+    int did;
+    int valid;
+    int status;
+    // CLOCK_MONOTONIC ms, 0 = no expire
+    long long expire;
+    char resp[DEVICE_RESP_SIZE +1];
+};
+
+struct cache_grp {
+    // 0 = no cache
+    int ttl_ms;
+    int event;
+    // bumped by every invalidate (drops a result computed before it)
+    unsigned int gen;
+
+    int cnt;
+    struct cache_entry entry[CHECK_CACHE_DID_MAX];
+};
+
+// CACHE group state of a dev_check_ctx
+struct check_cache {
+    pthread_mutex_t mutex;
+    struct cache_grp grp[DEVICE_GROUP_MAX];
+
+    // event list link (cache with an invalidate event)
+    struct check_cache *next;
+    int listed;
+};
+
+// caches the netlink events invalidate (every context, event loop)
+struct cache_event {
+    pthread_mutex_t mutex;
+    struct check_cache *head;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// dev_check_ctx_alloc copies it into every context
+static const struct check_cache CheckCache = {
+    PTHREAD_MUTEX_INITIALIZER, { { 0, }, }, NULL, 0
+};
+static struct cache_event CacheEvent     = { PTHREAD_MUTEX_INITIALIZER, NULL };
+static pthread_once_t     CacheEventOnce = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static struct cache_entry *entry_find (struct check_cache *cache, int gid, int did)
+{
+    struct cache_grp *grp;
+    int i;
+
+    if ((gid < 0) || (gid >= DEVICE_GROUP_MAX) || !(grp = &cache->grp[gid])->ttl_ms)
+        return NULL;
+
+    for (i = 0; i < grp->cnt; i++)
+        if (grp->entry[i].did == did)
+            return &grp->entry[i];
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static void grp_invalidate (struct check_cache *cache, int gid, int did)
+{
+    struct cache_grp *grp = &cache->grp[gid];
+    int i;
+
+    for (i = 0; i < grp->cnt; i++)
+        if ((did < 0) || (grp->entry[i].did == did))
+            grp->entry[i].valid = 0;
+
+    grp->gen++;
+}
+
+//------------------------------------------------------------------------------
+static void event_invalidate (int event)
+{
+    struct check_cache *cache;
+    int gid;
+
+    pthread_mutex_lock (&CacheEvent.mutex);
+    for (cache = CacheEvent.head; cache != NULL; cache = cache->next) {
+        pthread_mutex_lock   (&cache->mutex);
+        for (gid = 0; gid < DEVICE_GROUP_MAX; gid++)
+            if (cache->grp[gid].event & event)
+                grp_invalidate (cache, gid, -1);
+        pthread_mutex_unlock (&cache->mutex);
+    }
+    pthread_mutex_unlock (&CacheEvent.mutex);
+}
+
+//------------------------------------------------------------------------------
+static void event_list (struct check_cache *cache, int add)
+{
+    struct check_cache **pp;
+
+    pthread_mutex_lock (&CacheEvent.mutex);
+    if (add && !cache->listed) {
+        cache->next     = CacheEvent.head;
+        CacheEvent.head = cache;
+        cache->listed   = 1;
+    }
+    if (!add && cache->listed) {
+        for (pp = &CacheEvent.head; *pp != NULL; pp = &(*pp)->next)
+            if (*pp == cache) {
+                *pp = cache->next;
+                break;
+            }
+        cache->listed = 0;
+    }
+    pthread_mutex_unlock (&CacheEvent.mutex);
+}
+
+//------------------------------------------------------------------------------
+static int netlink_open (int proto, unsigned int groups)
+{
+    struct sockaddr_nl addr;
+    int fd;
+
+    if ((fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, proto)) < 0)
+        return -1;
+
+    memset (&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = groups;
+    if (bind (fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close (fd);
+        return -1;
+    }
+    return fd;
+}
+
+//------------------------------------------------------------------------------
+// kernel uevent "ACTION@devpath" : device added, removed or changed
+//------------------------------------------------------------------------------
+static int uevent_hotplug (const char *msg, int len)
+{
+    if (len <= 0)
+        return 0;
+
+    return  !strncmp (msg, "add@",    4) ||
+            !strncmp (msg, "remove@", 7) ||
+            !strncmp (msg, "change@", 7);
+}
+
+//------------------------------------------------------------------------------
+static int rtnl_changed (const char *msg, int len)
+{
+    const struct nlmsghdr *nh;
+
+    for (nh = (const struct nlmsghdr *)msg; NLMSG_OK (nh, (unsigned int)len); nh = NLMSG_NEXT (nh, len)) {
+        switch (nh->nlmsg_type) {
+            case RTM_NEWLINK: case RTM_DELLINK:
+            case RTM_NEWADDR: case RTM_DELADDR:
+                return 1;
+            default :
+                break;
+        }
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// event loop callback : uevent (arg 0) / rtnetlink (arg 1) socket
+//------------------------------------------------------------------------------
+static void event_func (void *arg, int fd, unsigned int events)
+{
+    char buf[8192];
+    int len;
+
+    (void)events;
+    // every queued message (level triggered)
+    while ((len = recv (fd, buf, sizeof(buf) -1, MSG_DONTWAIT)) > 0) {
+        buf[len] = 0;
+        if (arg == NULL) {
+            if (uevent_hotplug (buf, len))
+                event_invalidate (CHECK_CACHE_EV_UEVENT);
+        } else {
+            if (rtnl_changed (buf, len))
+                event_invalidate (CHECK_CACHE_EV_NETLINK);
+        }
+    }
+    // socket buffer overrun : events lost
+    if ((len < 0) && (errno == ENOBUFS))
+        event_invalidate ((arg == NULL) ? CHECK_CACHE_EV_UEVENT : CHECK_CACHE_EV_NETLINK);
+}
+
+//------------------------------------------------------------------------------
+static void event_start (void)
+{
+    int fd;
+
+    if ((fd = netlink_open (NETLINK_KOBJECT_UEVENT, 1)) < 0)
+        printf ("%s : uevent socket error! (%s)\n" , __func__, strerror(errno));
+    else if (!event_loop_add (fd, EPOLLIN, event_func, NULL))
+        close (fd);
+
+    if ((fd = netlink_open (NETLINK_ROUTE,
+                            RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR)) < 0)
+        printf ("%s : netlink socket error! (%s)\n", __func__, strerror(errno));
+    else if (!event_loop_add (fd, EPOLLIN, event_func, (void *)1))
+        close (fd);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// return 1 : cache hit (resp, status), 0 : run the check, then check_cache_put
+//
+//------------------------------------------------------------------------------
+int check_cache_get (struct dev_check_ctx *ctx, int gid, int did,
+                     char *resp, int *status, unsigned int *gen)
+{
+    struct check_cache *cache = dev_check_ctx_data (ctx, eGID_CFG_CACHE);
+    struct cache_entry *e;
+    int ret = 0;
+
+    if (cache == NULL)
+        return 0;
+
+    pthread_mutex_lock (&cache->mutex);
+    if ((e = entry_find (cache, gid, did)) != NULL) {
+        if (e->valid && e->expire && (e->expire <= dev_time_ms ()))
+            e->valid = 0;
+
+        if (e->valid) {
+            memcpy (resp, e->resp, DEVICE_RESP_SIZE +1);
+            *status = e->status;
+            ret = 1;
+        }
+        *gen = cache->grp[gid].gen;
+    }
+    pthread_mutex_unlock (&cache->mutex);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+// gen : check_cache_get value (invalidated while the check ran -> not stored)
+//------------------------------------------------------------------------------
+void check_cache_put (struct dev_check_ctx *ctx, int gid, int did,
+                      const char *resp, int status, unsigned int gen)
+{
+    struct check_cache *cache = dev_check_ctx_data (ctx, eGID_CFG_CACHE);
+    struct cache_entry *e;
+
+    // keep pass results only, a fail has to be checked again
+    if ((status != 1) || (cache == NULL))
+        return;
+
+    pthread_mutex_lock (&cache->mutex);
+    if (((e = entry_find (cache, gid, did)) != NULL) && (cache->grp[gid].gen == gen)) {
+        strncpy (e->resp, resp, DEVICE_RESP_SIZE);
+        e->resp[DEVICE_RESP_SIZE] = 0;
+        e->status = status;
+        e->expire = (cache->grp[gid].ttl_ms > 0) ? dev_time_ms () + cache->grp[gid].ttl_ms : 0;
+        e->valid  = 1;
+    }
+    pthread_mutex_unlock (&cache->mutex);
+}
+
+//------------------------------------------------------------------------------
+// gid < 0 : all groups, did < 0 : all devices of the group
+//------------------------------------------------------------------------------
+void check_cache_invalidate (struct dev_check_ctx *ctx, int gid, int did)
+{
+    struct check_cache *cache = dev_check_ctx_data (ctx, eGID_CFG_CACHE);
+    int i;
+
+    if (cache == NULL)
+        return;
+
+    pthread_mutex_lock (&cache->mutex);
+    if (gid < 0) {
+        for (i = 0; i < DEVICE_GROUP_MAX; i++)
+            grp_invalidate (cache, i, -1);
+    }
+    else if (gid < DEVICE_GROUP_MAX)
+        grp_invalidate (cache, gid, did);
+    pthread_mutex_unlock (&cache->mutex);
+}
+
+//------------------------------------------------------------------------------
+// CACHE, gid, ttl(ms), event, did, did, ...
+//------------------------------------------------------------------------------
+void check_cache_grp_init (struct dev_check_ctx *ctx, char *cfg)
+{
+    struct check_cache *cache = dev_check_ctx_data (ctx, eGID_CFG_CACHE);
+    struct cache_grp *grp;
+    char *tok, *save;
+    int gid, ttl, event = 0;
+
+    if ((tok = strtok_r (cfg, ",", &save)) == NULL)
+        return;
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)
+        return;
+
+    if (((gid = atoi (tok)) < 0) || (gid >= DEVICE_GROUP_MAX)) {
+        printf ("%s : error! gid = %d\n", __func__, gid);
+        return;
+    }
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)
+        return;
+    ttl = atoi (tok);
+
+    if ((tok = strtok_r (NULL, ",", &save)) != NULL) {
+        if (strchr (tok, 'u'))  event |= CHECK_CACHE_EV_UEVENT;
+        if (strchr (tok, 'n'))  event |= CHECK_CACHE_EV_NETLINK;
+    }
+
+    pthread_mutex_lock (&cache->mutex);
+    grp = &cache->grp[gid];
+    memset (grp, 0, sizeof(struct cache_grp));
+    grp->ttl_ms = ttl;
+    grp->event  = event;
+
+    while (((tok = strtok_r (NULL, ",", &save)) != NULL) && (grp->cnt < CHECK_CACHE_DID_MAX)) {
+        // skip the line end
+        if ((*tok < '0') || (*tok > '9'))
+            continue;
+        grp->entry[grp->cnt++].did = atoi (tok);
+    }
+    pthread_mutex_unlock (&cache->mutex);
+
+    if (ttl && event) {
+        event_list (cache, 1);
+        pthread_once (&CacheEventOnce, event_start);
+    }
+}
+
+//------------------------------------------------------------------------------
+// context destroy : off the event list
+//------------------------------------------------------------------------------
+static void check_cache_grp_exit (struct dev_check_ctx *ctx)
+{
+    event_list (dev_check_ctx_data (ctx, eGID_CFG_CACHE), 0);
+}
+
+//------------------------------------------------------------------------------
+// config only group (no check)
+//------------------------------------------------------------------------------
+static const struct dev_group GroupCACHE = {
+    "CACHE", eGID_CFG_CACHE, eGID_CFG_CACHE, sizeof(struct check_cache), &CheckCache,
+    check_cache_grp_init, NULL, NULL, check_cache_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupCACHE);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_cache.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (check result cache)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CHECK_CACHE_H__
+#define __CHECK_CACHE_H__
+
+//------------------------------------------------------------------------------
+// Results of static device facts (memory size, fb geometry, EDID, MAC, ...)
+// are kept by device_check() keyed by (gid, did). Only passed results are
+// cached. The policy comes from the config :
+//
+//   CACHE, gid, ttl(ms), event, did, did, ...
+//
+//   ttl   : 0 = no cache, -1 = until invalidated
+//   event : 'u' = hotplug (uevent), 'n' = link/address change (rtnetlink),
+//           'un' = both, '-' = ttl only
+//   did   : cached device ids (max CHECK_CACHE_DID_MAX)
+//
+// The cache belongs to a dev_check_ctx (CACHE group state), hotplug / link
+// events invalidate the caches of every context.
+//
+// e.g) CACHE,0,-1,-,0,1,2,3,   system mem, fb x/y/size
+//      CACHE,5,-1,n,0,1,       ethernet ip/mac until link/address change
+//------------------------------------------------------------------------------
+#define CHECK_CACHE_DID_MAX     16
+#define CHECK_CACHE_FOREVER     -1
+
+// invalidate event
+#define CHECK_CACHE_EV_UEVENT   0x01
+#define CHECK_CACHE_EV_NETLINK  0x02
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern int  check_cache_get         (struct dev_check_ctx *ctx, int gid, int did,
+                                     char *resp, int *status, unsigned int *gen);
+extern void check_cache_put         (struct dev_check_ctx *ctx, int gid, int did,
+                                     const char *resp, int status, unsigned int gen);
+extern void check_cache_invalidate  (struct dev_check_ctx *ctx, int gid, int did);
+extern void check_cache_grp_init    (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CHECK_CACHE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
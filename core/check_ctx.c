@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_ctx.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (library context)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "check_ctx.h"
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// device_setup / device_check context (created on first use, never freed)
+static struct dev_check_ctx *DefaultCTX = NULL;
+static pthread_once_t        DefaultOnce = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static void default_alloc (void)
+{
+    if ((DefaultCTX = dev_check_ctx_alloc ()) == NULL) {
+        printf ("%s : default context alloc error!\n", __func__);
+        exit (1);
+    }
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// new context, every group state at its default (no config)
+//
+//------------------------------------------------------------------------------
+struct dev_check_ctx *dev_check_ctx_alloc (void)
+{
+    struct dev_check_ctx *ctx;
+    const struct dev_group *grp;
+    int gid;
+
+    if ((ctx = calloc (1, sizeof(struct dev_check_ctx))) == NULL)
+        return NULL;
+
+    for (gid = 0; gid < DEVICE_GROUP_MAX; gid++) {
+        if (((grp = device_group_find (gid)) == NULL) || !grp->data_size)
+            continue;
+
+        if ((ctx->data[gid] = calloc (1, grp->data_size)) == NULL)
+            goto err;
+        if (grp->data_def != NULL)
+            memcpy (ctx->data[gid], grp->data_def, grp->data_size);
+    }
+    if ((ctx->init = device_group_init_alloc (ctx)) == NULL)
+        goto err;
+
+    return ctx;
+err:
+    printf ("%s : alloc error!\n", __func__);
+    dev_check_ctx_destroy (ctx);
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+//
+// context from a config file. return NULL : config error
+//
+//------------------------------------------------------------------------------
+struct dev_check_ctx *dev_check_ctx_create (const char *cfg_fname)
+{
+    struct dev_check_ctx *ctx;
+
+    if ((ctx = dev_check_ctx_alloc ()) == NULL)
+        return NULL;
+
+    if (!device_setup_ctx (ctx, cfg_fname)) {
+        dev_check_ctx_destroy (ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+//------------------------------------------------------------------------------
+//
+// no check of the context may be running. Waits for the group init, stops the
+// group threads (dev_group.exit, config groups first) and frees the group state.
+//
+//------------------------------------------------------------------------------
+void dev_check_ctx_destroy (struct dev_check_ctx *ctx)
+{
+    const struct dev_group *grp;
+    int gid;
+
+    if ((ctx == NULL) || (ctx == DefaultCTX))
+        return;
+
+    if (ctx->init != NULL)
+        device_group_init_wait (ctx);
+
+    // config groups first (checks still running in the background use every
+    // group state), nothing is freed before all exit hooks returned
+    for (gid = DEVICE_GROUP_MAX -1; gid >= 0; gid--) {
+        if (ctx->data[gid] == NULL)
+            continue;
+
+        if (((grp = device_group_find (gid)) != NULL) && (grp->exit != NULL))
+            grp->exit (ctx);
+    }
+    for (gid = 0; gid < DEVICE_GROUP_MAX; gid++)
+        free (ctx->data[gid]);
+    device_group_init_free (ctx->init);
+    free (ctx->setup);
+    free (ctx);
+}
+
+//------------------------------------------------------------------------------
+struct dev_check_ctx *dev_check_ctx_default (void)
+{
+    pthread_once (&DefaultOnce, default_alloc);
+
+    return DefaultCTX;
+}
+
+//------------------------------------------------------------------------------
+// group state of the context (NULL : unknown gid or no state)
+//------------------------------------------------------------------------------
+void *dev_check_ctx_data (struct dev_check_ctx *ctx, int gid)
+{
+    if ((gid < 0) || (gid >= DEVICE_GROUP_MAX))
+        return NULL;
+
+    return ctx->data[gid];
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_ctx.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (library context)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CHECK_CTX_H__
+#define __CHECK_CTX_H__
+
+//------------------------------------------------------------------------------
+// A dev_check_ctx owns everything one config describes : the state of every
+// group (dev_group.data_size bytes, copied from dev_group.data_def), the group
+// init queue and the config cache being built. Group init / check / data_check
+// get the context and take their state with dev_check_ctx_data().
+//
+// Contexts are independent, any number may live in one process (simulation,
+// benchmark). Process wide : lane locks (same hardware), worker pool, check
+// latency statistics, log filter, the file path index and the device root
+// (core/dev_root.h).
+//
+// device_setup(), device_check(), device_resp_check() ... use the default
+// context (dev_check_ctx_default()).
+//------------------------------------------------------------------------------
+struct init_ctl;
+struct cfg_cache_build;
+struct setup_ctl;
+
+struct dev_check_ctx {
+    // group state (NULL : group without state)
+    void *data[DEVICE_GROUP_MAX];
+
+    // group init queue / readiness (core/group_init.c)
+    struct init_ctl *init;
+    // config image built while the text config is parsed (core/cfg_cache.c)
+    struct cfg_cache_build *cfg_build;
+    // config file of device_setup_ctx (lib_dev_check.c)
+    struct setup_ctl *setup;
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern struct dev_check_ctx *dev_check_ctx_alloc    (void);
+extern struct dev_check_ctx *dev_check_ctx_create   (const char *cfg_fname);
+extern void                  dev_check_ctx_destroy  (struct dev_check_ctx *ctx);
+extern struct dev_check_ctx *dev_check_ctx_default  (void);
+extern void                 *dev_check_ctx_data     (struct dev_check_ctx *ctx, int gid);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CHECK_CTX_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,273 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_deadline.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (per check deadline budget)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "check_deadline.h"
+
+//------------------------------------------------------------------------------
+struct deadline_rule {
+    int gid;
+    // -1 : every did of the group
+    int did;
+    int budget_ms;
+};
+
+struct deadline_job {
+    // 0 = free
+    int used;
+    int gid, did;
+    struct dev_check_ctx *ctx;
+    check_deadline_func_t func;
+
+    int done;
+    int status;
+    // CLOCK_MONOTONIC ms of the finish (CHECK_DEADLINE_KEEP_MS)
+    long long done_ms;
+    char resp[DEVICE_RESP_SIZE +1];
+};
+
+// DEADLINE group state of a dev_check_ctx
+struct check_deadline {
+    pthread_mutex_t mutex;
+    // cond initialized (first DEADLINE line)
+    int ready;
+    pthread_cond_t  cond;
+
+    int rule_cnt;
+    struct deadline_rule rule[CHECK_DEADLINE_RULE_MAX];
+
+    // jobs on the worker pool (context destroy waits for them)
+    int running;
+    struct deadline_job job[CHECK_DEADLINE_JOB_MAX];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// dev_check_ctx_alloc copies it into every context
+static const struct check_deadline CheckDeadline = {
+    PTHREAD_MUTEX_INITIALIZER, 0, PTHREAD_COND_INITIALIZER, 0, { { 0, }, }, 0, { { 0, }, }
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// return : budget ms, 0 = no budget (mutex locked)
+//------------------------------------------------------------------------------
+static int rule_find (struct check_deadline *dl, int gid, int did)
+{
+    int i;
+
+    for (i = 0; i < dl->rule_cnt; i++) {
+        if (dl->rule[i].gid != gid)
+            continue;
+        if ((dl->rule[i].did < 0) || (dl->rule[i].did == did))
+            return dl->rule[i].budget_ms;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// running or unread job of (gid, did), old unread results are dropped.
+// (mutex locked)
+//------------------------------------------------------------------------------
+static struct deadline_job *job_find (struct check_deadline *dl, int gid, int did)
+{
+    struct deadline_job *job, *found = NULL;
+    long long now = dev_time_ms ();
+    int i;
+
+    for (i = 0; i < CHECK_DEADLINE_JOB_MAX; i++) {
+        job = &dl->job[i];
+        if (!job->used)
+            continue;
+        if (job->done && (now - job->done_ms > CHECK_DEADLINE_KEEP_MS)) {
+            memset (job, 0, sizeof(struct deadline_job));
+            continue;
+        }
+        if ((job->gid == gid) && (job->did == did))
+            found = job;
+    }
+    return found;
+}
+
+//------------------------------------------------------------------------------
+static void deadline_job (void *arg)
+{
+    struct deadline_job *job = (struct deadline_job *)arg;
+    struct check_deadline *dl = dev_check_ctx_data (job->ctx, eGID_CFG_DEADLINE);
+    char resp[DEVICE_RESP_SIZE +1];
+    int status;
+
+    // gid, did, ctx, func are not changed while the job runs
+    memset (resp, 0, sizeof(resp));
+    status = job->func (job->ctx, job->gid, job->did, resp);
+
+    pthread_mutex_lock (&dl->mutex);
+    memcpy (job->resp, resp, sizeof(resp));
+    job->status  = status;
+    job->done_ms = dev_time_ms ();
+    job->done    = 1;
+    dl->running--;
+    pthread_cond_broadcast (&dl->cond);
+    pthread_mutex_unlock   (&dl->mutex);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// return 0 : no budget for (gid, did), run the check in place.
+// return 1 : resp, status = check result, or 'W' (status 0) after the budget
+//
+//------------------------------------------------------------------------------
+int check_deadline_run (struct dev_check_ctx *ctx, int gid, int did,
+                        char *resp, int *status, check_deadline_func_t func)
+{
+    struct check_deadline *dl = dev_check_ctx_data (ctx, eGID_CFG_DEADLINE);
+    struct deadline_job *job;
+    struct timespec ts;
+    int budget, i;
+
+    if (dl == NULL)
+        return 0;
+
+    pthread_mutex_lock (&dl->mutex);
+    if (!dl->ready || ((budget = rule_find (dl, gid, did)) <= 0)) {
+        pthread_mutex_unlock (&dl->mutex);
+        return 0;
+    }
+
+    if ((job = job_find (dl, gid, did)) == NULL) {
+        for (i = 0; i < CHECK_DEADLINE_JOB_MAX; i++) {
+            if (!dl->job[i].used) {
+                job = &dl->job[i];
+                break;
+            }
+        }
+        // no free job : no budget for this one
+        if (job == NULL) {
+            pthread_mutex_unlock (&dl->mutex);
+            DEV_LOG (eLOG_WARN, gid, "%s : no free job (gid = %d, did = %d)\n", __func__, gid, did);
+            return 0;
+        }
+        memset (job, 0, sizeof(struct deadline_job));
+        job->used = 1;
+        job->gid  = gid;    job->did  = did;
+        job->ctx  = ctx;    job->func = func;
+        dl->running++;
+        pthread_mutex_unlock (&dl->mutex);
+
+        // WORKER_LONG : the pool adds a thread for it, a pool full of
+        // callers retrying on 'W' would never start a queued job
+        if (!worker_future_submit (NULL, deadline_job, job, WORKER_LONG)) {
+            pthread_mutex_lock   (&dl->mutex);
+            memset (job, 0, sizeof(struct deadline_job));
+            dl->running--;
+            pthread_mutex_unlock (&dl->mutex);
+            return 0;
+        }
+        pthread_mutex_lock (&dl->mutex);
+    }
+
+    dev_abs_timeout (&ts, budget);
+    // another caller may take the result while this one waits
+    while (job->used && (job->gid == gid) && (job->did == did) && !job->done) {
+        if (pthread_cond_timedwait (&dl->cond, &dl->mutex, &ts))
+            break;
+    }
+
+    if (job->used && (job->gid == gid) && (job->did == did) && job->done) {
+        memcpy (resp, job->resp, DEVICE_RESP_SIZE +1);
+        *status = job->status;
+        memset (job, 0, sizeof(struct deadline_job));
+    } else {
+        DEVICE_RESP_FORM_STR (resp, 'W', "");
+        *status = 0;
+    }
+    pthread_mutex_unlock (&dl->mutex);
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// DEADLINE, gid, did, budget(ms),
+//------------------------------------------------------------------------------
+void check_deadline_grp_init (struct dev_check_ctx *ctx, char *cfg)
+{
+    struct check_deadline *dl = dev_check_ctx_data (ctx, eGID_CFG_DEADLINE);
+    pthread_condattr_t attr;
+    struct deadline_rule rule;
+    char *tok, *save;
+
+    if ((tok = strtok_r (cfg, ",", &save)) == NULL)
+        return;
+
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)    return;
+    rule.gid = atoi (tok);
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)    return;
+    rule.did = atoi (tok);
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)    return;
+    rule.budget_ms = atoi (tok);
+
+    if ((rule.gid < 0) || (rule.gid >= DEVICE_GROUP_CFG) || (rule.budget_ms < 0)) {
+        printf ("%s : error! gid = %d, budget = %d\n", __func__, rule.gid, rule.budget_ms);
+        return;
+    }
+
+    pthread_mutex_lock (&dl->mutex);
+    if (!dl->ready) {
+        // timed wait must not jump with the wall clock
+        pthread_condattr_init     (&attr);
+        pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+        pthread_cond_init         (&dl->cond, &attr);
+        pthread_condattr_destroy  (&attr);
+        dl->ready = 1;
+    }
+    if (dl->rule_cnt < CHECK_DEADLINE_RULE_MAX)
+        dl->rule[dl->rule_cnt++] = rule;
+    else
+        printf ("%s : error! rule max = %d\n", __func__, CHECK_DEADLINE_RULE_MAX);
+    pthread_mutex_unlock (&dl->mutex);
+}
+
+//------------------------------------------------------------------------------
+// context destroy : checks still running in the background use the context
+//------------------------------------------------------------------------------
+static void check_deadline_grp_exit (struct dev_check_ctx *ctx)
+{
+    struct check_deadline *dl = dev_check_ctx_data (ctx, eGID_CFG_DEADLINE);
+
+    pthread_mutex_lock (&dl->mutex);
+    while (dl->running)
+        pthread_cond_wait (&dl->cond, &dl->mutex);
+    pthread_mutex_unlock (&dl->mutex);
+}
+
+//------------------------------------------------------------------------------
+// config only group (no check)
+//------------------------------------------------------------------------------
+static const struct dev_group GroupDEADLINE = {
+    "DEADLINE", eGID_CFG_DEADLINE, eGID_CFG_DEADLINE, sizeof(struct check_deadline), &CheckDeadline,
+    check_deadline_grp_init, NULL, NULL, check_deadline_grp_exit
+};
+
+DEVICE_GROUP_REGISTER (GroupDEADLINE);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_deadline.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (per check deadline budget)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CHECK_DEADLINE_H__
+#define __CHECK_DEADLINE_H__
+
+//------------------------------------------------------------------------------
+// A check with a budget runs on the worker pool. device_check() waits for it
+// at most budget ms, then returns a 'W' status (status 0) and the check keeps
+// running. The next device_check() of the same (gid, did) returns the result
+// (or waits the budget again while it is still running).
+// The check is a WORKER_LONG job : the pool adds a thread for it, so callers
+// retrying on 'W' from pool threads never keep it queued.
+//
+//   DEADLINE, gid, did, budget(ms),      did -1 = every did of the group
+//
+// A result not read within CHECK_DEADLINE_KEEP_MS is dropped, the next
+// device_check() starts a new check.
+//
+// e.g) DEADLINE,2,-1,3000,     usb read / write
+//      DEADLINE,5,4,1000,      ethernet iperf server ip (nmap)
+//------------------------------------------------------------------------------
+#define CHECK_DEADLINE_RULE_MAX     32
+#define CHECK_DEADLINE_JOB_MAX      16
+#define CHECK_DEADLINE_KEEP_MS      30000
+
+struct dev_check_ctx;
+
+// the check itself (device_check without the budget)
+typedef int (*check_deadline_func_t) (struct dev_check_ctx *ctx, int gid, int did, char *resp);
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  check_deadline_run      (struct dev_check_ctx *ctx, int gid, int did,
+                                     char *resp, int *status, check_deadline_func_t func);
+extern void check_deadline_grp_init (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CHECK_DEADLINE_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,525 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_journal.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (check result journal)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "check_journal.h"
+
+_Static_assert (sizeof(struct journal_rec) == JOURNAL_REC_SIZE, "journal record size");
+_Static_assert (sizeof(struct journal_hdr) <= JOURNAL_HDR_SIZE, "journal header size");
+
+//------------------------------------------------------------------------------
+struct check_journal {
+    // open / sync / board identity
+    pthread_mutex_t mutex;
+    char path[PATH_MAX];
+    int fd;
+    char *map;
+    size_t size;
+
+    struct journal_rec *rec;
+    unsigned int rec_cnt;
+    // next record (atomic), records synced to the file, records of the
+    // previous runs (before this start)
+    unsigned int next, synced, start;
+    // records lost on a full journal (atomic)
+    unsigned int dropped;
+};
+
+enum {
+    eJOURNAL_ID_UNKNOWN = 0,
+    eJOURNAL_ID_VALID,
+    eJOURNAL_ID_NONE,
+};
+
+// board identity of a context (JOURNAL group state)
+struct journal_id {
+    // eJOURNAL_ID_xxx (atomic), mac / uuid fixed once valid
+    int state;
+    char mac [JOURNAL_MAC_SIZE];
+    char uuid[JOURNAL_UUID_SIZE];
+};
+
+struct resume_item {
+    int gid, did, status;
+    // served once (after that the check runs)
+    int served;
+    long long time_us;
+    char resp[JOURNAL_RESP_SIZE];
+};
+
+struct journal_resume {
+    // RESUME config : window (sec, 0 = off), gids (none = all)
+    int window;
+    int all;
+    char gid[DEVICE_GROUP_MAX];
+
+    // item table built (mutex locked)
+    int built;
+    int cnt;
+    struct resume_item item[JOURNAL_RESUME_MAX];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct check_journal CheckJournal = {
+    PTHREAD_MUTEX_INITIALIZER, { 0, }, -1, NULL, 0, NULL, 0, 0, 0, 0, 0
+};
+
+static struct journal_id JournalId = { eJOURNAL_ID_UNKNOWN, { 0, }, { 0, } };
+
+// RESUME group state : config, passed items of the previous runs of the
+// context board (built on the first check)
+static struct journal_resume CheckResume;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// board MAC / eFuse uuid of the context, once its ethernet init (eFuse read)
+// is done : valid or none, not read again for every record
+//------------------------------------------------------------------------------
+static int journal_identity (struct dev_check_ctx *ctx, struct journal_id *id)
+{
+    char *mac, *uuid;
+    int state;
+
+    // no wait : records of the checks before it have no identity
+    if (!device_group_ready (ctx, eGID_ETHERNET, 0))
+        return eJOURNAL_ID_UNKNOWN;
+
+    pthread_mutex_lock (&CheckJournal.mutex);
+    if ((state = id->state) != eJOURNAL_ID_VALID) {
+        if ((mac = get_mac_addr_ctx (ctx)) != NULL) {
+            strncpy (id->mac, mac, JOURNAL_MAC_SIZE -1);
+            if ((uuid = get_efuse_uuid_ctx (ctx)) != NULL)
+                strncpy (id->uuid, uuid, JOURNAL_UUID_SIZE -1);
+            state = eJOURNAL_ID_VALID;
+        } else
+            state = eJOURNAL_ID_NONE;
+        __atomic_store_n (&id->state, state, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock (&CheckJournal.mutex);
+
+    return state;
+}
+
+//------------------------------------------------------------------------------
+static int journal_valid (const struct journal_rec *rec)
+{
+    return (__atomic_load_n (&rec->magic, __ATOMIC_ACQUIRE) == JOURNAL_REC_MAGIC) &&
+           (rec->hash == check_journal_hash (rec));
+}
+
+//------------------------------------------------------------------------------
+// new file : header, records zero filled (ftruncate)
+//------------------------------------------------------------------------------
+static int journal_create (int fd, unsigned int rec_cnt)
+{
+    struct journal_hdr hdr;
+
+    memset (&hdr, 0, sizeof(hdr));
+    memcpy (hdr.magic, JOURNAL_MAGIC, sizeof(hdr.magic));
+    hdr.version  = JOURNAL_VERSION;
+    hdr.rec_size = JOURNAL_REC_SIZE;
+    hdr.rec_cnt  = rec_cnt;
+    hdr.created  = dev_time_real_usec ();
+
+    if (ftruncate (fd, JOURNAL_HDR_SIZE + (off_t)rec_cnt * JOURNAL_REC_SIZE))
+        return 0;
+    if (pwrite (fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr))
+        return 0;
+    return !fsync (fd);
+}
+
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static int journal_open (const char *path, unsigned int rec_cnt)
+{
+    const struct journal_hdr *hdr;
+    struct journal_rec *rec;
+    struct stat st;
+    unsigned int i, next = 0;
+    int fd;
+
+    if ((fd = open (path, O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0)
+        return 0;
+
+    if (fstat (fd, &st) || (!st.st_size && !journal_create (fd, rec_cnt)) || fstat (fd, &st))
+        goto err;
+
+    CheckJournal.map = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (CheckJournal.map == MAP_FAILED) {
+        CheckJournal.map = NULL;
+        goto err;
+    }
+    hdr = (const struct journal_hdr *)CheckJournal.map;
+
+    // not a journal of this version : left as it is
+    if ((st.st_size < JOURNAL_HDR_SIZE) ||
+        memcmp (hdr->magic, JOURNAL_MAGIC, sizeof(hdr->magic)) ||
+        (hdr->version != JOURNAL_VERSION) || (hdr->rec_size != JOURNAL_REC_SIZE) ||
+        (st.st_size < JOURNAL_HDR_SIZE + (off_t)hdr->rec_cnt * JOURNAL_REC_SIZE)) {
+        munmap (CheckJournal.map, st.st_size);
+        CheckJournal.map = NULL;
+        goto err;
+    }
+    rec = (struct journal_rec *)(CheckJournal.map + JOURNAL_HDR_SIZE);
+
+    // append after the last valid record (a torn one is skipped)
+    for (i = 0; i < hdr->rec_cnt; i++) {
+        if (journal_valid (&rec[i]))
+            next = i + 1;
+    }
+    CheckJournal.fd      = fd;
+    CheckJournal.size    = st.st_size;
+    CheckJournal.rec_cnt = hdr->rec_cnt;
+    CheckJournal.next    = next;
+    CheckJournal.synced  = next;
+    CheckJournal.start   = next;
+    strncpy (CheckJournal.path, path, sizeof(CheckJournal.path) -1);
+
+    // check_journal_add starts here
+    __atomic_store_n (&CheckJournal.rec, rec, __ATOMIC_RELEASE);
+    return 1;
+err:
+    close (fd);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+static void *thread_func_sync (void *arg)
+{
+    struct timespec ts = { JOURNAL_SYNC_MS / 1000, (JOURNAL_SYNC_MS % 1000) * 1000000L };
+
+    while (1) {
+        nanosleep (&ts, NULL);
+        check_journal_sync ();
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+// time_us : record time (a resumed result keeps the time of its check)
+//------------------------------------------------------------------------------
+static void journal_append (struct dev_check_ctx *ctx, int gid, int did, int status,
+                            const char *resp, long long wall_us, long long time_us)
+{
+    struct journal_id *id = dev_check_ctx_data (ctx, eGID_CFG_JOURNAL);
+    struct journal_rec rec, *dst;
+    unsigned int idx;
+    int state;
+
+    if ((state = __atomic_load_n (&id->state, __ATOMIC_ACQUIRE)) == eJOURNAL_ID_UNKNOWN)
+        state = journal_identity (ctx, id);
+
+    // the MAC check writes a blank eFuse : read it again after an ethernet check
+    if ((state == eJOURNAL_ID_NONE) && (gid == eGID_ETHERNET))
+        __atomic_store_n (&id->state, eJOURNAL_ID_UNKNOWN, __ATOMIC_RELAXED);
+
+    idx = __atomic_fetch_add (&CheckJournal.next, 1, __ATOMIC_RELAXED);
+    if (idx >= CheckJournal.rec_cnt) {
+        // stays past the end (no wrap)
+        __atomic_store_n (&CheckJournal.next, CheckJournal.rec_cnt, __ATOMIC_RELAXED);
+        if (!__atomic_fetch_add (&CheckJournal.dropped, 1, __ATOMIC_RELAXED))
+            DEV_LOG (eLOG_WARN, DEV_LOG_GID_NONE, "%s : %s full!\n", __func__, CheckJournal.path);
+        return;
+    }
+
+    memset (&rec, 0, sizeof(rec));
+    rec.time_us = time_us;
+    rec.wall_us = wall_us;
+    rec.gid     = gid;
+    rec.did     = did;
+    rec.status  = status;
+    // "P,      1234" : value of an integer response, else 0
+    rec.value   = ((resp[0] != 0) && (resp[1] == ',')) ? atoi (&resp[2]) : 0;
+    strncpy (rec.resp, resp, JOURNAL_RESP_SIZE -1);
+    if (state == eJOURNAL_ID_VALID) {
+        memcpy (rec.mac,  id->mac,  JOURNAL_MAC_SIZE);
+        memcpy (rec.uuid, id->uuid, JOURNAL_UUID_SIZE);
+    }
+    rec.hash    = check_journal_hash (&rec);
+
+    // magic last : a reader never takes a half written record
+    dst = &CheckJournal.rec[idx];
+    memcpy (&dst->hash, &rec.hash, sizeof(rec) - sizeof(rec.magic));
+    __atomic_store_n (&dst->magic, JOURNAL_REC_MAGIC, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// device_check result (hot path : no lock, no syscall once the board
+// identity is known)
+//
+//------------------------------------------------------------------------------
+void check_journal_add (struct dev_check_ctx *ctx, int gid, int did, int status,
+                        const char *resp, long long wall_us)
+{
+    if (__atomic_load_n (&CheckJournal.rec, __ATOMIC_ACQUIRE) == NULL)
+        return;
+
+    journal_append (ctx, gid, did, status, resp, wall_us, dev_time_real_usec ());
+}
+
+//------------------------------------------------------------------------------
+// msync the records written since the last call (up to the first one still
+// being written)
+//------------------------------------------------------------------------------
+void check_journal_sync (void)
+{
+    unsigned int end, dropped;
+    long page = sysconf (_SC_PAGESIZE);
+    size_t from, to;
+
+    pthread_mutex_lock (&CheckJournal.mutex);
+    if (CheckJournal.rec == NULL) {
+        pthread_mutex_unlock (&CheckJournal.mutex);
+        return;
+    }
+    end = __atomic_load_n (&CheckJournal.next, __ATOMIC_RELAXED);
+    if (end > CheckJournal.rec_cnt)
+        end = CheckJournal.rec_cnt;
+
+    for (to = CheckJournal.synced; to < end; to++) {
+        if (__atomic_load_n (&CheckJournal.rec[to].magic, __ATOMIC_ACQUIRE) != JOURNAL_REC_MAGIC)
+            break;
+    }
+    if (to > CheckJournal.synced) {
+        from = (JOURNAL_HDR_SIZE + CheckJournal.synced * JOURNAL_REC_SIZE) & ~(size_t)(page -1);
+        if (msync (CheckJournal.map + from, JOURNAL_HDR_SIZE + to * JOURNAL_REC_SIZE - from, MS_SYNC))
+            printf ("%s : %s msync error!\n", __func__, CheckJournal.path);
+        CheckJournal.synced = to;
+    }
+    pthread_mutex_unlock (&CheckJournal.mutex);
+
+    if ((dropped = __atomic_exchange_n (&CheckJournal.dropped, 0, __ATOMIC_RELAXED)) != 0)
+        printf ("%s : %u records dropped (journal full)\n", __func__, dropped);
+}
+
+//------------------------------------------------------------------------------
+// last record of every (gid, did) of this board within the window, records of
+// the previous runs only (mutex locked)
+//------------------------------------------------------------------------------
+static void resume_build (const struct journal_id *id, struct journal_resume *res)
+{
+    const struct journal_rec *rec;
+    struct resume_item *item;
+    long long from = dev_time_real_usec () - (long long)res->window * 1000000;
+    unsigned int i;
+    int j, pass = 0;
+
+    res->built = 1;
+    if (id->state != eJOURNAL_ID_VALID) {
+        printf ("%s : board identity unknown, no resume\n", __func__);
+        return;
+    }
+    for (i = 0; i < CheckJournal.start; i++) {
+        rec = &CheckJournal.rec[i];
+        if (!journal_valid (rec) || (rec->time_us < from))
+            continue;
+        if (memcmp (rec->mac,  id->mac,  JOURNAL_MAC_SIZE) ||
+            memcmp (rec->uuid, id->uuid, JOURNAL_UUID_SIZE))
+            continue;
+        if (!res->all &&
+            ((rec->gid < 0) || (rec->gid >= DEVICE_GROUP_MAX) || !res->gid[rec->gid]))
+            continue;
+
+        for (j = 0, item = NULL; j < res->cnt; j++) {
+            if ((res->item[j].gid == rec->gid) && (res->item[j].did == rec->did)) {
+                item = &res->item[j];
+                break;
+            }
+        }
+        if (item == NULL) {
+            if (res->cnt >= JOURNAL_RESUME_MAX)
+                continue;
+            item = &res->item[res->cnt++];
+            item->gid = rec->gid;
+            item->did = rec->did;
+        } else if (item->time_us > rec->time_us)
+            continue;
+
+        item->status  = rec->status;
+        item->time_us = rec->time_us;
+        memcpy (item->resp, rec->resp, JOURNAL_RESP_SIZE);
+    }
+    for (j = 0; j < res->cnt; j++)
+        pass += (res->item[j].status == 1);
+
+    DEV_LOG (eLOG_INFO, DEV_LOG_GID_NONE, "%s : %s, %d passed / %d items\n",
+             __func__, id->mac, pass, res->cnt);
+}
+
+//------------------------------------------------------------------------------
+//
+// passed result of a previous run (RESUME config), once per item.
+// return : 1 = resp, status set (the check is not run)
+//
+//------------------------------------------------------------------------------
+int check_journal_resume (struct dev_check_ctx *ctx, int gid, int did, char *resp, int *status)
+{
+    struct journal_id *id = dev_check_ctx_data (ctx, eGID_CFG_JOURNAL);
+    struct journal_resume *res = dev_check_ctx_data (ctx, eGID_CFG_RESUME);
+    struct resume_item *item = NULL;
+    int i;
+
+    if (!res->window || (__atomic_load_n (&CheckJournal.rec, __ATOMIC_ACQUIRE) == NULL))
+        return 0;
+    if (!res->all && ((gid < 0) || (gid >= DEVICE_GROUP_MAX) || !res->gid[gid]))
+        return 0;
+
+    // board identity : the ethernet group reads the eFuse
+    if (__atomic_load_n (&id->state, __ATOMIC_ACQUIRE) != eJOURNAL_ID_VALID) {
+        device_group_ready (ctx, eGID_ETHERNET, GROUP_WAIT_FOREVER);
+        journal_identity (ctx, id);
+    }
+
+    pthread_mutex_lock (&CheckJournal.mutex);
+    if (!res->built)
+        resume_build (id, res);
+    for (i = 0; i < res->cnt; i++) {
+        if ((res->item[i].gid == gid) && (res->item[i].did == did)) {
+            item = &res->item[i];
+            break;
+        }
+    }
+    if ((item != NULL) && (item->status == 1) && !item->served) {
+        item->served = 1;
+        memcpy (resp, item->resp, DEVICE_RESP_SIZE);
+        resp[DEVICE_RESP_SIZE] = 0;
+        *status = 1;
+    } else
+        item = NULL;
+    pthread_mutex_unlock (&CheckJournal.mutex);
+
+    if (item == NULL)
+        return 0;
+
+    // journaled again with the time of its check (wall 0) : the window of a
+    // next resume still starts at the first run
+    journal_append (ctx, gid, did, 1, resp, 0, item->time_us);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// JOURNAL, file, records,      (journal is process wide, ctx not used)
+//------------------------------------------------------------------------------
+void check_journal_grp_init (struct dev_check_ctx *ctx, char *cfg)
+{
+    char *tok, *save, path[PATH_MAX];
+    unsigned int rec_cnt = JOURNAL_REC_DEFAULT;
+    pthread_t thread;
+    int ret;
+
+    (void)ctx;
+
+    if ((tok = strtok_r (cfg, ",", &save)) == NULL)
+        return;
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)
+        return;
+
+    memset (path, 0, sizeof(path));
+    strncpy (path, tok + strspn (tok, " "), sizeof(path) -1);
+    path[strcspn (path, " \r\n")] = 0;
+
+    if (((tok = strtok_r (NULL, ",", &save)) != NULL) && (atoi (tok) > 0))
+        rec_cnt = atoi (tok);
+
+    pthread_mutex_lock (&CheckJournal.mutex);
+    if (CheckJournal.rec != NULL) {
+        // the same config again (device_setup of another context)
+        if (strcmp (CheckJournal.path, path))
+            printf ("%s : %s already open, skip %s\n", __func__, CheckJournal.path, path);
+        pthread_mutex_unlock (&CheckJournal.mutex);
+        return;
+    }
+    ret = journal_open (path, rec_cnt);
+    pthread_mutex_unlock (&CheckJournal.mutex);
+
+    if (!ret) {
+        printf ("%s : %s open error!\n", __func__, path);
+        return;
+    }
+    if (pthread_create (&thread, NULL, thread_func_sync, NULL))
+        printf ("%s : pthread_create error!\n", __func__);
+    else
+        pthread_detach (thread);
+
+    // records of the last period at exit()
+    atexit (check_journal_sync);
+
+    DEV_LOG (eLOG_INFO, DEV_LOG_GID_NONE, "%s : %s, %u / %u records\n",
+             __func__, path, CheckJournal.next, CheckJournal.rec_cnt);
+}
+
+//------------------------------------------------------------------------------
+// RESUME, window(sec), gid, gid, ...       (no gid = all groups)
+//------------------------------------------------------------------------------
+void check_resume_grp_init (struct dev_check_ctx *ctx, char *cfg)
+{
+    struct journal_resume *res = dev_check_ctx_data (ctx, eGID_CFG_RESUME);
+    char *tok, *save;
+    int gid;
+
+    if ((tok = strtok_r (cfg, ",", &save)) == NULL)
+        return;
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)
+        return;
+
+    pthread_mutex_lock (&CheckJournal.mutex);
+    res->window = (atoi (tok) > 0) ? atoi (tok) : 0;
+    res->all    = 1;
+    while ((tok = strtok_r (NULL, ",", &save)) != NULL) {
+        // skip the line end
+        if ((*tok < '0') || (*tok > '9'))
+            continue;
+        gid = atoi (tok);
+        if ((gid >= 0) && (gid < DEVICE_GROUP_MAX)) {
+            res->gid[gid] = 1;
+            res->all = 0;
+        }
+    }
+    pthread_mutex_unlock (&CheckJournal.mutex);
+}
+
+//------------------------------------------------------------------------------
+// config only group (no check)
+//------------------------------------------------------------------------------
+static const struct dev_group GroupJOURNAL = {
+    "JOURNAL", eGID_CFG_JOURNAL, eGID_CFG_JOURNAL, sizeof(struct journal_id), &JournalId,
+    check_journal_grp_init, NULL, NULL, NULL
+};
+
+static const struct dev_group GroupRESUME = {
+    "RESUME", eGID_CFG_RESUME, eGID_CFG_RESUME, sizeof(struct journal_resume), &CheckResume,
+    check_resume_grp_init, NULL, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupJOURNAL);
+DEVICE_GROUP_REGISTER (GroupRESUME);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_journal.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (check result journal)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CHECK_JOURNAL_H__
+#define __CHECK_JOURNAL_H__
+
+#include <stdint.h>
+#include "dev_util.h"
+
+//------------------------------------------------------------------------------
+// Every device_check() result is appended to a binary journal file :
+//
+//   JOURNAL, {file}, {records},     (records default JOURNAL_REC_DEFAULT)
+//
+// The file (header page + fixed size records) is mmap'd. A check claims the
+// next record (atomic add), copies it into the mapping and sets the magic
+// last. A thread msyncs the new records every JOURNAL_SYNC_MS, so a process
+// crash loses nothing and a reset / power loss at most the last period.
+// A record never spans a page, a torn one fails its FNV-1a hash.
+// Records are keyed by the board MAC and eFuse uuid of the checking context
+// (get_mac_addr_ctx / get_efuse_uuid_ctx), read once its ethernet init is
+// done. Empty before that and on a blank eFuse (read again after an ethernet
+// check, the MAC check writes it).
+//
+// Append only : a full journal drops the new records (counted). The next
+// start continues after the last valid record of the file.
+// tools/dev_journal.c (make journal) exports journals to CSV.
+//
+// Resume after a reset / hang of the board :
+//
+//   RESUME, {window sec}, {gid}, {gid}, ...     (no gid = all groups)
+//
+// On the first check of a listed group, the last record of every (gid, did)
+// of the context board (MAC and eFuse uuid) from the previous runs, not older
+// than the window, is read. A passed item answers its first request from that
+// record (journaled again with its first time, wall 0), failed, waiting or
+// unrecorded items are checked. The window keeps a finished cycle of the
+// same board (retest) from being resumed.
+// The RESUME config and the items read are kept per context.
+//------------------------------------------------------------------------------
+#define JOURNAL_MAGIC       "DEVJNL01"
+#define JOURNAL_VERSION     1
+#define JOURNAL_REC_MAGIC   0x4a524543u     // "JREC"
+
+#define JOURNAL_HDR_SIZE    4096
+#define JOURNAL_REC_SIZE    128
+#define JOURNAL_REC_DEFAULT 65536
+
+#define JOURNAL_SYNC_MS     1000
+
+#define JOURNAL_RESP_SIZE   24
+#define JOURNAL_MAC_SIZE    24
+#define JOURNAL_UUID_SIZE   40
+
+// resumed (gid, did) items
+#define JOURNAL_RESUME_MAX  256
+
+struct journal_hdr {
+    char     magic[8];
+    uint32_t version;
+    uint32_t rec_size;
+    uint32_t rec_cnt;
+    uint32_t reserved;
+    // CLOCK_REALTIME usec of the file creation
+    int64_t  created;
+};
+
+struct journal_rec {
+    // JOURNAL_REC_MAGIC : record complete (written last)
+    uint32_t magic;
+    // FNV-1a of the record from time_us
+    uint32_t hash;
+    // CLOCK_REALTIME usec (check end), check wall time usec
+    int64_t  time_us;
+    int64_t  wall_us;
+    // did = device_check did (id + action * 10)
+    int32_t  gid, did;
+    // 1 = pass, -1 = fail, 0 = wait
+    int32_t  status, value;
+    char     resp[JOURNAL_RESP_SIZE];
+    char     mac [JOURNAL_MAC_SIZE];
+    char     uuid[JOURNAL_UUID_SIZE];
+};
+
+//------------------------------------------------------------------------------
+// record hash (also used by tools/dev_journal.c, no library objects)
+//------------------------------------------------------------------------------
+static inline uint32_t check_journal_hash (const struct journal_rec *rec)
+{
+    // FNV-1a
+    return dev_fnv32 (DEV_FNV32_INIT, &rec->time_us, sizeof(struct journal_rec) - 8);
+}
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern void check_journal_add       (struct dev_check_ctx *ctx, int gid, int did, int status,
+                                     const char *resp, long long wall_us);
+extern void check_journal_sync      (void);
+extern int  check_journal_resume    (struct dev_check_ctx *ctx, int gid, int did,
+                                     char *resp, int *status);
+extern void check_journal_grp_init  (struct dev_check_ctx *ctx, char *cfg);
+extern void check_resume_grp_init   (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CHECK_JOURNAL_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
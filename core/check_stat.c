@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_stat.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (check latency statistics)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "check_stat.h"
+
+//------------------------------------------------------------------------------
+struct stat_hist {
+    int gid, did;
+    long long count, min, max;
+    unsigned int bucket[CHECK_STAT_BUCKETS];
+};
+
+struct check_stat {
+    pthread_mutex_t mutex;
+    // open addressing by (gid, did), NULL = empty
+    struct stat_hist *key[CHECK_STAT_KEY_MAX];
+    int cnt;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct check_stat CheckStat = { PTHREAD_MUTEX_INITIALIZER, { NULL, }, 0 };
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static int msb (unsigned long long v)
+{
+    return 63 - __builtin_clzll (v);
+}
+
+//------------------------------------------------------------------------------
+// value < 16 : linear, else 16 sub buckets per power of 2
+//------------------------------------------------------------------------------
+static int bucket_index (long long usec)
+{
+    int m;
+
+    if (usec < CHECK_STAT_SUB_CNT)
+        return (usec < 0) ? 0 : (int)usec;
+
+    if ((m = msb ((unsigned long long)usec)) > CHECK_STAT_MAG_MAX)
+        return CHECK_STAT_BUCKETS -1;
+
+    return CHECK_STAT_SUB_CNT * (m - CHECK_STAT_SUB_BITS + 1) +
+           (int)((usec >> (m - CHECK_STAT_SUB_BITS)) - CHECK_STAT_SUB_CNT);
+}
+
+//------------------------------------------------------------------------------
+// highest value of a bucket
+//------------------------------------------------------------------------------
+static long long bucket_value (int idx)
+{
+    int m, sub;
+
+    if (idx < CHECK_STAT_SUB_CNT)
+        return idx;
+
+    m   = idx / CHECK_STAT_SUB_CNT + CHECK_STAT_SUB_BITS - 1;
+    sub = idx % CHECK_STAT_SUB_CNT;
+
+    return (((long long)(CHECK_STAT_SUB_CNT + sub) + 1) << (m - CHECK_STAT_SUB_BITS)) - 1;
+}
+
+//------------------------------------------------------------------------------
+static long long hist_percentile (const struct stat_hist *h, int percent)
+{
+    long long want, sum = 0, value;
+    int i;
+
+    if (!h->count)
+        return 0;
+
+    // ceil (count * percent / 100), at least 1
+    if ((want = (h->count * percent + 99) / 100) < 1)
+        want = 1;
+
+    for (i = 0; i < CHECK_STAT_BUCKETS; i++) {
+        if ((sum += h->bucket[i]) >= want)
+            break;
+    }
+    value = bucket_value (i);
+
+    // bucket edge -> real range
+    if (value > h->max) value = h->max;
+    if (value < h->min) value = h->min;
+    return value;
+}
+
+//------------------------------------------------------------------------------
+// (mutex locked) create : 1 = add a new key
+//------------------------------------------------------------------------------
+static struct stat_hist *hist_find (int gid, int did, int create)
+{
+    unsigned int pos = (unsigned int)(gid * 10000 + did) * 2654435761u;
+    struct stat_hist *h;
+    int i;
+
+    for (i = 0; i < CHECK_STAT_KEY_MAX; i++, pos++) {
+        if ((h = CheckStat.key[pos % CHECK_STAT_KEY_MAX]) == NULL)
+            break;
+        if ((h->gid == gid) && (h->did == did))
+            return h;
+    }
+    // table full (keep the last slot free to end the search)
+    if (!create || (i == CHECK_STAT_KEY_MAX) || (CheckStat.cnt >= CHECK_STAT_KEY_MAX -1))
+        return NULL;
+
+    if ((h = calloc (1, sizeof(struct stat_hist))) == NULL)
+        return NULL;
+
+    h->gid = gid;   h->did = did;
+    h->min = LLONG_MAX;
+    CheckStat.key[pos % CHECK_STAT_KEY_MAX] = h;
+    CheckStat.cnt++;
+    return h;
+}
+
+//------------------------------------------------------------------------------
+static void hist_info (const struct stat_hist *h, struct check_stat_info *info)
+{
+    info->gid = h->gid;
+    info->did = h->did;
+    info->value[eSTAT_COUNT] = h->count;
+    info->value[eSTAT_MIN]   = h->count ? h->min : 0;
+    info->value[eSTAT_P50]   = hist_percentile (h, 50);
+    info->value[eSTAT_P99]   = hist_percentile (h, 99);
+    info->value[eSTAT_MAX]   = h->max;
+}
+
+//------------------------------------------------------------------------------
+static int info_cmp (const void *a, const void *b)
+{
+    const struct check_stat_info *p = a, *q = b;
+
+    if (p->gid != q->gid)
+        return p->gid - q->gid;
+    return p->did - q->did;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+void check_stat_add (int gid, int did, long long usec)
+{
+    struct stat_hist *h;
+
+    pthread_mutex_lock (&CheckStat.mutex);
+    if ((h = hist_find (gid, did, 1)) != NULL) {
+        h->bucket[bucket_index (usec)]++;
+        h->count++;
+        if (usec < h->min)  h->min = usec;
+        if (usec > h->max)  h->max = usec;
+    }
+    pthread_mutex_unlock (&CheckStat.mutex);
+}
+
+//------------------------------------------------------------------------------
+// return 1 : info filled, 0 : no sample for (gid, did)
+//------------------------------------------------------------------------------
+int check_stat_get (int gid, int did, struct check_stat_info *info)
+{
+    struct stat_hist *h;
+
+    memset (info, 0, sizeof(struct check_stat_info));
+    info->gid = gid;    info->did = did;
+
+    pthread_mutex_lock (&CheckStat.mutex);
+    if ((h = hist_find (gid, did, 0)) != NULL)
+        hist_info (h, info);
+    pthread_mutex_unlock (&CheckStat.mutex);
+
+    return (h != NULL);
+}
+
+//------------------------------------------------------------------------------
+//
+// serial response of the 'T' command : eSTAT_END frames, '\r\n' each.
+// msg size : CHECK_STAT_FRAME_SIZE, return : msg length
+//
+//------------------------------------------------------------------------------
+int check_stat_frame (int gid, int did, char *msg)
+{
+    struct check_stat_info info;
+    char resp[DEVICE_RESP_SIZE +1];
+    int i, len = 0;
+
+    check_stat_get (gid, did, &info);
+
+    for (i = 0; i < eSTAT_END; i++) {
+        long long v = info.value[i];
+
+        DEVICE_RESP_FORM_INT (resp, '0' + i, (v > INT_MAX) ? INT_MAX : (int)v);
+        len += SERIAL_RESP_FORM (&msg[len], RESP_CMD_STAT, gid, did, resp);
+        msg[len++] = '\r';  msg[len++] = '\n';
+    }
+    msg[len] = 0;
+    return len;
+}
+
+//------------------------------------------------------------------------------
+void check_stat_dump (void)
+{
+    struct check_stat_info info[CHECK_STAT_KEY_MAX];
+    int i, cnt = 0;
+
+    pthread_mutex_lock (&CheckStat.mutex);
+    for (i = 0; i < CHECK_STAT_KEY_MAX; i++)
+        if (CheckStat.key[i] != NULL)
+            hist_info (CheckStat.key[i], &info[cnt++]);
+    pthread_mutex_unlock (&CheckStat.mutex);
+
+    qsort (info, cnt, sizeof(info[0]), info_cmp);
+
+    printf ("\n%-4s %-6s %8s %12s %12s %12s %12s  (usec)\n",
+            "GID", "DID", "count", "min", "p50", "p99", "max");
+    for (i = 0; i < cnt; i++)
+        printf ("%-4d %-6d %8lld %12lld %12lld %12lld %12lld\n",
+                info[i].gid, info[i].did,
+                info[i].value[eSTAT_COUNT], info[i].value[eSTAT_MIN],
+                info[i].value[eSTAT_P50]  , info[i].value[eSTAT_P99],
+                info[i].value[eSTAT_MAX]);
+}
+
+//------------------------------------------------------------------------------
+void check_stat_reset (void)
+{
+    int i;
+
+    pthread_mutex_lock (&CheckStat.mutex);
+    for (i = 0; i < CHECK_STAT_KEY_MAX; i++) {
+        free (CheckStat.key[i]);
+        CheckStat.key[i] = NULL;
+    }
+    CheckStat.cnt = 0;
+    pthread_mutex_unlock (&CheckStat.mutex);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+/**
+ * @file check_stat.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (check latency statistics)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __CHECK_STAT_H__
+#define __CHECK_STAT_H__
+
+//------------------------------------------------------------------------------
+// Every device_check() is timed (CLOCK_MONOTONIC, usec) per (gid, did), did
+// includes the action. Latencies go into a log-linear (HDR style) histogram :
+// 16 sub buckets per power of 2, so a percentile is within 1/16 (6.25%).
+//
+// Serial : host '@,T,GID,DID,#' -> 5 frames '@,T,GID,DID,{item},{value},#'
+//          item 0 = count, 1 = min, 2 = p50, 3 = p99, 4 = max (usec)
+//------------------------------------------------------------------------------
+#define CHECK_STAT_SUB_BITS     4
+#define CHECK_STAT_SUB_CNT      (1 << CHECK_STAT_SUB_BITS)
+// 1 usec ~ 2^40 usec (12 days)
+#define CHECK_STAT_MAG_MAX      40
+#define CHECK_STAT_BUCKETS      (CHECK_STAT_SUB_CNT * (CHECK_STAT_MAG_MAX - CHECK_STAT_SUB_BITS + 2))
+
+// (gid, did) keys kept
+#define CHECK_STAT_KEY_MAX      256
+
+// check_stat_frame msg size (eSTAT_END frames + '\r\n')
+#define CHECK_STAT_FRAME_SIZE   ((SERIAL_RESP_SIZE + 2) * eSTAT_END + 1)
+
+enum {
+    eSTAT_COUNT = 0,
+    eSTAT_MIN,
+    eSTAT_P50,
+    eSTAT_P99,
+    eSTAT_MAX,
+    eSTAT_END
+};
+
+struct check_stat_info {
+    int gid, did;
+    long long value[eSTAT_END];
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern void check_stat_add      (int gid, int did, long long usec);
+extern int  check_stat_get      (int gid, int did, struct check_stat_info *info);
+extern int  check_stat_frame    (int gid, int did, char *msg);
+extern void check_stat_dump     (void);
+extern void check_stat_reset    (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __CHECK_STAT_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,283 @@
+//------------------------------------------------------------------------------
+/**
+ * @file dev_log.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (ring buffer logger)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "dev_log.h"
+
+//------------------------------------------------------------------------------
+#define SLOT_MASK   (DEV_LOG_SLOT_CNT -1)
+
+//------------------------------------------------------------------------------
+// seq (relative to the slot index, so a zeroed ring is ready to use)
+//   lap * SLOT_CNT      : free for the producer of position lap * SLOT_CNT + idx
+//   lap * SLOT_CNT + 1  : written, ready for the flusher
+//------------------------------------------------------------------------------
+struct log_slot {
+    unsigned int seq;
+    int level, gid;
+    long long usec;
+    char msg[DEV_LOG_MSG_SIZE];
+};
+
+struct dev_log {
+    // producer position (atomic)
+    unsigned int head;
+    // flusher position (mutex_flush)
+    unsigned int tail;
+    // lines lost on a full ring (atomic)
+    unsigned int dropped;
+    // flusher sleeps on the empty ring (atomic, futex word)
+    int sleep;
+
+    struct log_slot slot[DEV_LOG_SLOT_CNT];
+};
+
+// runtime filter
+struct log_filter {
+    int level;
+    unsigned char group_off[DEVICE_GROUP_MAX];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// zero filled ring (bss)
+static struct dev_log    DevLog;
+static struct log_filter LogFilter = { eLOG_INFO, { 0, } };
+
+// one consumer at a time (flusher thread or dev_log_flush)
+static pthread_mutex_t mutex_flush = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  DevLogOnce  = PTHREAD_ONCE_INIT;
+
+static const char LogLevelChar[eLOG_END] = { 'E', 'W', 'I', 'D' };
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// drain the ring to stdout. return : written line count
+//------------------------------------------------------------------------------
+static int log_drain (void)
+{
+    struct log_slot *s;
+    unsigned int dropped;
+    int cnt = 0;
+
+    pthread_mutex_lock (&mutex_flush);
+    while (1) {
+        s = &DevLog.slot[DevLog.tail & SLOT_MASK];
+        if (__atomic_load_n (&s->seq, __ATOMIC_ACQUIRE) != (DevLog.tail & ~SLOT_MASK) + 1)
+            break;
+
+        if (s->gid < 0)
+            fprintf (stdout, "[%5lld.%06lld] %c -- %s",
+                     s->usec / 1000000, s->usec % 1000000, LogLevelChar[s->level], s->msg);
+        else
+            fprintf (stdout, "[%5lld.%06lld] %c %02d %s",
+                     s->usec / 1000000, s->usec % 1000000, LogLevelChar[s->level], s->gid, s->msg);
+
+        // slot free for the next lap
+        __atomic_store_n (&s->seq, (DevLog.tail & ~SLOT_MASK) + DEV_LOG_SLOT_CNT, __ATOMIC_RELEASE);
+        DevLog.tail++;
+        cnt++;
+    }
+    if ((dropped = __atomic_exchange_n (&DevLog.dropped, 0, __ATOMIC_RELAXED)) != 0)
+        fprintf (stdout, "%s : %u lines dropped (ring full)\n", __func__, dropped);
+
+    if (cnt || dropped)
+        fflush (stdout);
+    pthread_mutex_unlock (&mutex_flush);
+
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+// line published at the flusher position (no lock : a hint for the flusher)
+//------------------------------------------------------------------------------
+static int log_pending (void)
+{
+    unsigned int tail = __atomic_load_n (&DevLog.tail, __ATOMIC_RELAXED);
+
+    return __atomic_load_n (&DevLog.slot[tail & SLOT_MASK].seq, __ATOMIC_ACQUIRE) ==
+           (tail & ~SLOT_MASK) + 1;
+}
+
+//------------------------------------------------------------------------------
+static void *thread_func_flush (void *arg)
+{
+    struct timespec ts = { DEV_LOG_FLUSH_MS / 1000, (DEV_LOG_FLUSH_MS % 1000) * 1000000L };
+
+    while (1) {
+        if (log_drain ())
+            continue;
+
+        // flag first, then the ring again : a producer publishing in between
+        // either is seen here or sees the flag (and wakes the futex)
+        __atomic_store_n (&DevLog.sleep, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);
+        if (!log_pending ())
+            syscall (SYS_futex, &DevLog.sleep, FUTEX_WAIT_PRIVATE, 1, &ts, NULL, 0);
+        __atomic_store_n (&DevLog.sleep, 0, __ATOMIC_RELAXED);
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+static void log_start (void)
+{
+    pthread_t thread;
+
+    if (pthread_create (&thread, NULL, thread_func_flush, NULL))
+        printf ("%s : pthread_create error!\n", __func__);
+    else
+        pthread_detach (thread);
+
+    // lines still in the ring at exit()
+    atexit (dev_log_flush);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+void dev_log_write (int level, int gid, const char *fmt, ...)
+{
+    struct log_slot *s;
+    unsigned int pos, seq;
+    va_list ap;
+    int len;
+
+    // runtime filter (before anything else)
+    if (level > __atomic_load_n (&LogFilter.level, __ATOMIC_RELAXED))
+        return;
+    if ((gid >= 0) && (gid < DEVICE_GROUP_MAX) && LogFilter.group_off[gid])
+        return;
+
+    pthread_once (&DevLogOnce, log_start);
+
+    // claim a slot
+    pos = __atomic_load_n (&DevLog.head, __ATOMIC_RELAXED);
+    while (1) {
+        s   = &DevLog.slot[pos & SLOT_MASK];
+        seq = __atomic_load_n (&s->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == (pos & ~SLOT_MASK)) {
+            if (__atomic_compare_exchange_n (&DevLog.head, &pos, pos + 1, 1,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        // slot not flushed yet : ring full
+        else if ((int)(seq - (pos & ~SLOT_MASK)) < 0) {
+            __atomic_fetch_add (&DevLog.dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        else
+            pos = __atomic_load_n (&DevLog.head, __ATOMIC_RELAXED);
+    }
+
+    s->level = level;
+    s->gid   = gid;
+    s->usec  = dev_time_usec ();
+
+    va_start (ap, fmt);
+    len = vsnprintf (s->msg, sizeof(s->msg), fmt, ap);
+    va_end (ap);
+
+    // truncated line keeps its line end
+    if (len >= (int)sizeof(s->msg))
+        s->msg[sizeof(s->msg) -2] = '\n';
+
+    __atomic_store_n (&s->seq, (pos & ~SLOT_MASK) + 1, __ATOMIC_RELEASE);
+
+    // flusher asleep on the empty ring : wake it (first line only)
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    if (__atomic_load_n (&DevLog.sleep, __ATOMIC_RELAXED) &&
+        __atomic_exchange_n (&DevLog.sleep, 0, __ATOMIC_RELAXED))
+        syscall (SYS_futex, &DevLog.sleep, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+//------------------------------------------------------------------------------
+void dev_log_flush (void)
+{
+    log_drain ();
+}
+
+//------------------------------------------------------------------------------
+void dev_log_set_level (int level)
+{
+    if (level < eLOG_ERR)   level = eLOG_ERR;
+    if (level > eLOG_DEBUG) level = eLOG_DEBUG;
+
+    __atomic_store_n (&LogFilter.level, level, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+// gid < 0 : all groups
+//------------------------------------------------------------------------------
+void dev_log_set_group (int gid, int enable)
+{
+    int i;
+
+    if (gid >= DEVICE_GROUP_MAX)
+        return;
+
+    for (i = (gid < 0) ? 0 : gid; i < ((gid < 0) ? DEVICE_GROUP_MAX : gid + 1); i++)
+        LogFilter.group_off[i] = enable ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+// LOG, level, gid, gid, ...    (filter is process wide, ctx not used)
+//------------------------------------------------------------------------------
+void dev_log_grp_init (struct dev_check_ctx *ctx, char *cfg)
+{
+    char *tok, *save;
+    int grp_cnt = 0;
+
+    (void)ctx;
+
+    if ((tok = strtok_r (cfg, ",", &save)) == NULL)
+        return;
+    if ((tok = strtok_r (NULL, ",", &save)) == NULL)
+        return;
+
+    dev_log_set_level (atoi (tok));
+
+    while ((tok = strtok_r (NULL, ",", &save)) != NULL) {
+        // skip the line end
+        if ((*tok < '0') || (*tok > '9'))
+            continue;
+        // first gid : only the listed groups
+        if (!grp_cnt++)
+            dev_log_set_group (-1, 0);
+        dev_log_set_group (atoi (tok), 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+// config only group (no check)
+//------------------------------------------------------------------------------
+static const struct dev_group GroupLOG = {
+    "LOG", eGID_CFG_LOG, eGID_CFG_LOG, 0, NULL, dev_log_grp_init, NULL, NULL, NULL
+};
+
+DEVICE_GROUP_REGISTER (GroupLOG);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
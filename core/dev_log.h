@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+/**
+ * @file dev_log.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (ring buffer logger)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __DEV_LOG_H__
+#define __DEV_LOG_H__
+
+//------------------------------------------------------------------------------
+// DEV_LOG() formats into a slot of a lock-free ring (any thread, no lock, no
+// syscall unless the flusher sleeps on an empty ring) and returns. A flusher
+// thread writes the lines to stdout :
+//
+//   [   12.345678] I 05 ethernet_check : [size = 22] -> P,  192.168.0.10
+//   (CLOCK_MONOTONIC sec.usec, level, gid)
+//
+// Ring full : the line is dropped and counted, a check never waits for the
+// console.
+//
+// Filter
+//   compile time : -DDEV_LOG_LEVEL=eLOG_INFO, -D'DEV_LOG_GROUP(gid)=((gid)==5)'
+//                  (filtered calls are removed by the compiler)
+//   runtime      : dev_log_set_level(), dev_log_set_group() or the config
+//                  LOG, level, gid, gid, ...   (no gid : all groups)
+//------------------------------------------------------------------------------
+enum {
+    eLOG_ERR = 0,
+    eLOG_WARN,
+    eLOG_INFO,
+    eLOG_DEBUG,
+    eLOG_END
+};
+
+// gid of lines that belong to no group (never filtered by group)
+#define DEV_LOG_GID_NONE    -1
+
+// ring slot count (power of 2), line size
+#define DEV_LOG_SLOT_CNT    1024
+#define DEV_LOG_MSG_SIZE    128
+
+// flusher sleep on an empty ring : the first line after it wakes the flusher
+// (futex, no syscall while it runs), this period is only a backstop
+#define DEV_LOG_FLUSH_MS    1000
+
+#ifndef DEV_LOG_LEVEL
+#define DEV_LOG_LEVEL       eLOG_DEBUG
+#endif
+
+#ifndef DEV_LOG_GROUP
+#define DEV_LOG_GROUP(gid)  1
+#endif
+
+#define DEV_LOG(level, gid, fmt, ...)                                       \
+    do {                                                                    \
+        if (((level) <= DEV_LOG_LEVEL) && DEV_LOG_GROUP(gid))               \
+            dev_log_write ((level), (gid), fmt, ##__VA_ARGS__);             \
+    } while (0)
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct dev_check_ctx;
+
+extern void dev_log_write       (int level, int gid, const char *fmt, ...)
+                                 __attribute__((format(printf, 3, 4)));
+extern void dev_log_flush       (void);
+extern void dev_log_set_level   (int level);
+extern void dev_log_set_group   (int gid, int enable);
+extern void dev_log_grp_init    (struct dev_check_ctx *ctx, char *cfg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __DEV_LOG_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
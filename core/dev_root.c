@@ -0,0 +1,229 @@
+//------------------------------------------------------------------------------
+/**
+ * @file dev_root.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (device tree root remapping)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "dev_root.h"
+
+//------------------------------------------------------------------------------
+struct root_latency {
+    char path[STR_PATH_LENGTH];
+    int  len;
+    unsigned int usec;
+};
+
+struct dev_root {
+    // "" : real device tree
+    char root[PATH_MAX];
+    struct root_latency latency[DEV_ROOT_LATENCY_MAX];
+    int latency_cnt;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct dev_root DevRoot = { { 0, }, { { { 0, }, 0, 0 }, }, 0 };
+
+static pthread_once_t  RootOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t mutex_dev_root = PTHREAD_MUTEX_INITIALIZER;
+
+// remapped path prefixes
+static const char *RootPrefix[] = { "/sys/", "/dev/", "/proc/", NULL };
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static void latency_load (void)
+{
+    char fname[PATH_MAX + sizeof(DEV_ROOT_LATENCY) + 1], line[STR_PATH_LENGTH *2];
+    struct root_latency *p;
+    char *tok, *save;
+    FILE *fp;
+
+    DevRoot.latency_cnt = 0;
+    snprintf (fname, sizeof(fname), "%s/%s", DevRoot.root, DEV_ROOT_LATENCY);
+    if ((fp = fopen (fname, "r")) == NULL)
+        return;
+
+    while (fgets (line, sizeof(line), fp) != NULL) {
+        if ((line[0] != '/') || (DevRoot.latency_cnt >= DEV_ROOT_LATENCY_MAX))
+            continue;
+
+        p = &DevRoot.latency[DevRoot.latency_cnt];
+        if ((tok = strtok_r (line, " \t", &save)) == NULL)
+            continue;
+        memset  (p->path, 0, sizeof(p->path));
+        strncpy (p->path, tok, sizeof(p->path) -1);
+        p->len  = strlen (p->path);
+        if ((tok = strtok_r (NULL, " \t\r\n", &save)) == NULL)
+            continue;
+        p->usec = strtoul (tok, NULL, 10);
+        DevRoot.latency_cnt++;
+    }
+    fclose (fp);
+}
+
+//------------------------------------------------------------------------------
+static int root_load (const char *root)
+{
+    char real[PATH_MAX];
+
+    if ((root == NULL) || !root[0]) {
+        memset (DevRoot.root, 0, sizeof(DevRoot.root));
+        DevRoot.latency_cnt = 0;
+        return 1;
+    }
+    if (realpath (root, real) == NULL) {
+        printf ("%s : error! %s (%s)\n", __func__, root, strerror(errno));
+        return 0;
+    }
+    // "/" is the real tree
+    if (!strcmp (real, "/"))
+        real[0] = 0;
+
+    strncpy (DevRoot.root, real, sizeof(DevRoot.root) -1);
+    latency_load ();
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void root_env (void)
+{
+    char *env;
+
+    if ((env = getenv (DEV_ROOT_ENV)) != NULL)
+        root_load (env);
+}
+
+//------------------------------------------------------------------------------
+static int root_remap (const char *path)
+{
+    int i;
+
+    if (!DevRoot.root[0])
+        return 0;
+
+    for (i = 0; RootPrefix[i] != NULL; i++)
+        if (!strncmp (path, RootPrefix[i], strlen (RootPrefix[i])))
+            return 1;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+static void latency_wait (const char *path)
+{
+    int i;
+
+    for (i = 0; i < DevRoot.latency_cnt; i++) {
+        if (!strncmp (path, DevRoot.latency[i].path, DevRoot.latency[i].len)) {
+            usleep (DevRoot.latency[i].usec);
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// root : fake tree directory, NULL or "" = real device tree
+//
+//------------------------------------------------------------------------------
+int dev_root_set (const char *root)
+{
+    int ret;
+
+    pthread_once (&RootOnce, root_env);
+
+    pthread_mutex_lock   (&mutex_dev_root);
+    ret = root_load (root);
+    pthread_mutex_unlock (&mutex_dev_root);
+
+    // attribute fds of the previous root
+    sysfs_attr_close ();
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+// return : root directory, NULL = real device tree
+//------------------------------------------------------------------------------
+const char *dev_root_get (void)
+{
+    pthread_once (&RootOnce, root_env);
+
+    return DevRoot.root[0] ? DevRoot.root : NULL;
+}
+
+//------------------------------------------------------------------------------
+// return : path to access (path itself, or buf holding the remapped path)
+//------------------------------------------------------------------------------
+const char *dev_root_path (const char *path, char *buf, int size)
+{
+    pthread_once (&RootOnce, root_env);
+
+    if (!root_remap (path))
+        return path;
+
+    snprintf (buf, size, "%s%s", DevRoot.root, path);
+    return buf;
+}
+
+//------------------------------------------------------------------------------
+FILE *dev_root_fopen (const char *path, const char *mode)
+{
+    char buf[PATH_MAX];
+    const char *rpath = dev_root_path (path, buf, sizeof(buf));
+
+    if (rpath != path)
+        latency_wait (path);
+
+    return fopen (rpath, mode);
+}
+
+//------------------------------------------------------------------------------
+int dev_root_open (const char *path, int flags)
+{
+    char buf[PATH_MAX];
+    const char *rpath = dev_root_path (path, buf, sizeof(buf));
+    struct stat st;
+
+    if (rpath != path) {
+        latency_wait (path);
+        // fake event node (fifo) : open r/w, never blocks and never sees EOF
+        if (!stat (rpath, &st) && S_ISFIFO(st.st_mode))
+            flags = (flags & ~O_ACCMODE) | O_RDWR;
+    }
+    return open (rpath, flags);
+}
+
+//------------------------------------------------------------------------------
+int dev_root_access (const char *path, int mode)
+{
+    char buf[PATH_MAX];
+
+    return access (dev_root_path (path, buf, sizeof(buf)), mode);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
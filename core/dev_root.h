@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+/**
+ * @file dev_root.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (device tree root remapping)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __DEV_ROOT_H__
+#define __DEV_ROOT_H__
+
+#include <stdio.h>
+
+//------------------------------------------------------------------------------
+// Every /sys, /dev and /proc access of the checks goes through dev_root_path()
+// (or the open helpers). With a root set (DEV_CHECK_ROOT environment variable
+// or dev_root_set()) those paths are looked up below the root, so the whole
+// library runs against a fake tree (tools/dev_fixture.sh) off-target.
+// Other paths (config, audio files, /tmp) are never remapped.
+//
+// Root latency file (DEV_ROOT_LATENCY in the root) : "{path} {usec}" per line.
+// Opening a path that starts with {path} sleeps {usec} first (slow sysfs
+// nodes, slow block devices). First matching line wins.
+//
+// Process wide, set it before device_setup().
+//------------------------------------------------------------------------------
+#define DEV_ROOT_ENV            "DEV_CHECK_ROOT"
+#define DEV_ROOT_LATENCY        ".latency"
+#define DEV_ROOT_LATENCY_MAX    64
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int          dev_root_set    (const char *root);
+extern const char  *dev_root_get    (void);
+extern const char  *dev_root_path   (const char *path, char *buf, int size);
+extern FILE        *dev_root_fopen  (const char *path, const char *mode);
+extern int          dev_root_open   (const char *path, int flags);
+extern int          dev_root_access (const char *path, int mode);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __DEV_ROOT_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
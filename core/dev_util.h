@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+/**
+ * @file dev_util.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (clock, timeout, hash helpers)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __DEV_UTIL_H__
+#define __DEV_UTIL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Helpers shared by the core modules and the groups. Header only (static
+// inline) : tools/ and bench/ use them without the library objects.
+//
+//   dev_time_ms / dev_time_usec : CLOCK_MONOTONIC (latency, ttl, deadline)
+//   dev_time_real_usec          : CLOCK_REALTIME (journal records)
+//   dev_abs_timeout             : CLOCK_MONOTONIC deadline of a timed wait
+//                                 (condattr / clock*lock with CLOCK_MONOTONIC)
+//   dev_fnv32 / dev_fnv64       : FNV-1a, chained through the seed
+//                                 (DEV_FNV32_INIT / DEV_FNV64_INIT first)
+//------------------------------------------------------------------------------
+#define DEV_FNV32_INIT      2166136261u
+#define DEV_FNV32_PRIME     16777619u
+#define DEV_FNV64_INIT      14695981039346656037ull
+#define DEV_FNV64_PRIME     1099511628211ull
+
+//------------------------------------------------------------------------------
+static inline long long dev_time_ms (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+static inline long long dev_time_usec (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static inline long long dev_time_real_usec (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static inline void dev_abs_timeout (struct timespec *ts, int timeout_ms)
+{
+    clock_gettime (CLOCK_MONOTONIC, ts);
+
+    ts->tv_sec  += timeout_ms / 1000;
+    ts->tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t dev_fnv32 (uint32_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+
+    while (len--)
+        hash = (hash ^ *p++) * DEV_FNV32_PRIME;
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t dev_fnv32_str (uint32_t hash, const char *str)
+{
+    while (*str)
+        hash = (hash ^ (unsigned char)*str++) * DEV_FNV32_PRIME;
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t dev_fnv64 (uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+
+    while (len--)
+        hash = (hash ^ *p++) * DEV_FNV64_PRIME;
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __DEV_UTIL_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,331 @@
+//------------------------------------------------------------------------------
+/**
+ * @file event_loop.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (single event loop thread)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+//------------------------------------------------------------------------------
+#include "event_loop.h"
+#include "dev_util.h"
+
+//------------------------------------------------------------------------------
+struct event_src {
+    // 0 = free entry (ids are not reused, epoll data)
+    int id;
+    int fd;
+    // fd added to the epoll set
+    int polled;
+    unsigned int events;
+    // CLOCK_MONOTONIC ms of the timer, 0 = no timer
+    long long due_ms;
+
+    event_loop_func_t func;
+    void *arg;
+};
+
+struct event_loop {
+    pthread_mutex_t mutex;
+    // callback finished (event_loop_del waits for it)
+    pthread_cond_t  cond;
+    pthread_t thread;
+    int started;
+    int epoll_fd;
+    // timer changed by another thread (epoll data 0)
+    int wake_fd;
+
+    int next_id;
+    // id of the running callback
+    int busy_id;
+    struct event_src src[EVENT_LOOP_MAX];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct event_loop EventLoop = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, -1, -1, 0, 0, { { 0, }, }
+};
+static pthread_once_t EventLoopOnce = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static struct event_src *src_find (int id)
+{
+    int i;
+
+    if (id <= 0)
+        return NULL;
+
+    for (i = 0; i < EVENT_LOOP_MAX; i++) {
+        if (EventLoop.src[i].id == id)
+            return &EventLoop.src[i];
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static void src_poll (struct event_src *s, int fd)
+{
+    struct epoll_event ev;
+
+    if (s->polled)
+        epoll_ctl (EventLoop.epoll_fd, EPOLL_CTL_DEL, s->fd, NULL);
+
+    s->fd     = fd;
+    s->polled = 0;
+    if (fd < 0)
+        return;
+
+    memset (&ev, 0, sizeof(ev));
+    ev.events   = s->events;
+    ev.data.u64 = (unsigned int)s->id;
+    // EPERM : regular file (fake device tree), timer only
+    s->polled = (epoll_ctl (EventLoop.epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0);
+}
+
+//------------------------------------------------------------------------------
+static void loop_wake (void)
+{
+    unsigned long long v = 1;
+
+    if (event_loop_self ())
+        return;
+    if ((EventLoop.wake_fd >= 0) && (write (EventLoop.wake_fd, &v, sizeof(v)) != sizeof(v)))
+        printf ("%s : eventfd write error!\n", __func__);
+}
+
+//------------------------------------------------------------------------------
+static void loop_dispatch (int id, unsigned int events)
+{
+    struct event_src *s;
+    event_loop_func_t func;
+    void *arg;
+    int fd;
+
+    pthread_mutex_lock (&EventLoop.mutex);
+    if ((s = src_find (id)) == NULL) {
+        pthread_mutex_unlock (&EventLoop.mutex);
+        return;
+    }
+    fd   = s->fd;
+    func = s->func;     arg = s->arg;
+    EventLoop.busy_id = id;
+    pthread_mutex_unlock (&EventLoop.mutex);
+
+    func (arg, fd, events);
+
+    pthread_mutex_lock (&EventLoop.mutex);
+    EventLoop.busy_id = 0;
+    pthread_cond_broadcast (&EventLoop.cond);
+    pthread_mutex_unlock   (&EventLoop.mutex);
+}
+
+//------------------------------------------------------------------------------
+static void *thread_func_loop (void *arg)
+{
+    struct epoll_event ev[EVENT_LOOP_MAX];
+    int due[EVENT_LOOP_MAX];
+    unsigned long long v;
+    long long now, left;
+    int i, n, cnt, timeout;
+
+    while (1) {
+        timeout = -1;
+        pthread_mutex_lock (&EventLoop.mutex);
+        now = dev_time_ms ();
+        for (i = 0; i < EVENT_LOOP_MAX; i++) {
+            if (!EventLoop.src[i].id || !EventLoop.src[i].due_ms)
+                continue;
+            left = EventLoop.src[i].due_ms - now;
+            left = (left > 0) ? left : 0;
+            if ((timeout < 0) || (left < timeout))
+                timeout = (int)left;
+        }
+        pthread_mutex_unlock (&EventLoop.mutex);
+
+        if ((n = epoll_wait (EventLoop.epoll_fd, ev, EVENT_LOOP_MAX, timeout)) < 0) {
+            if (errno == EINTR)
+                continue;
+            printf ("%s : epoll_wait error! (%s)\n", __func__, strerror(errno));
+            break;
+        }
+        for (i = 0; i < n; i++) {
+            if (ev[i].data.u64 == 0) {
+                if (read (EventLoop.wake_fd, &v, sizeof(v)) < 0)
+                    printf ("%s : eventfd read error!\n", __func__);
+                continue;
+            }
+            loop_dispatch ((int)ev[i].data.u64, ev[i].events);
+        }
+
+        // expired timers (one-shot)
+        pthread_mutex_lock (&EventLoop.mutex);
+        now = dev_time_ms ();
+        for (i = 0, cnt = 0; i < EVENT_LOOP_MAX; i++) {
+            if (!EventLoop.src[i].id || !EventLoop.src[i].due_ms)
+                continue;
+            if (EventLoop.src[i].due_ms <= now) {
+                EventLoop.src[i].due_ms = 0;
+                due[cnt++] = EventLoop.src[i].id;
+            }
+        }
+        pthread_mutex_unlock (&EventLoop.mutex);
+
+        for (i = 0; i < cnt; i++)
+            loop_dispatch (due[i], EVENT_LOOP_TIMER);
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+static void loop_start (void)
+{
+    struct epoll_event ev;
+
+    if ((EventLoop.epoll_fd = epoll_create1 (EPOLL_CLOEXEC)) < 0) {
+        printf ("%s : epoll_create error! (%s)\n", __func__, strerror(errno));
+        return;
+    }
+    if ((EventLoop.wake_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+        printf ("%s : eventfd error!\n", __func__);
+        return;
+    }
+    memset (&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN;
+    ev.data.u64 = 0;
+    epoll_ctl (EventLoop.epoll_fd, EPOLL_CTL_ADD, EventLoop.wake_fd, &ev);
+
+    if (pthread_create (&EventLoop.thread, NULL, thread_func_loop, NULL)) {
+        printf ("%s : pthread_create error!\n", __func__);
+        return;
+    }
+    pthread_detach (EventLoop.thread);
+    EventLoop.started = 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// return : source id, 0 = error
+//
+//------------------------------------------------------------------------------
+int event_loop_add (int fd, unsigned int events, event_loop_func_t func, void *arg)
+{
+    struct event_src *s = NULL;
+    int i, id = 0;
+
+    if (func == NULL)
+        return 0;
+
+    pthread_once (&EventLoopOnce, loop_start);
+    if (!EventLoop.started)
+        return 0;
+
+    pthread_mutex_lock (&EventLoop.mutex);
+    for (i = 0; i < EVENT_LOOP_MAX; i++) {
+        if (!EventLoop.src[i].id) {
+            s = &EventLoop.src[i];
+            break;
+        }
+    }
+    if (s != NULL) {
+        memset (s, 0, sizeof(struct event_src));
+        id = s->id = ++EventLoop.next_id;
+        s->events  = events;
+        s->func    = func;
+        s->arg     = arg;
+        src_poll (s, fd);
+    }
+    pthread_mutex_unlock (&EventLoop.mutex);
+
+    if (!id)
+        printf ("%s : error! (source max = %d)\n", __func__, EVENT_LOOP_MAX);
+
+    return id;
+}
+
+//------------------------------------------------------------------------------
+// the callback is not running / called any more once it returns.
+//------------------------------------------------------------------------------
+void event_loop_del (int id)
+{
+    struct event_src *s;
+
+    pthread_mutex_lock (&EventLoop.mutex);
+    // the loop thread may remove its own source
+    while (id && (EventLoop.busy_id == id) && !event_loop_self ())
+        pthread_cond_wait (&EventLoop.cond, &EventLoop.mutex);
+
+    if ((s = src_find (id)) != NULL) {
+        src_poll (s, -1);
+        memset (s, 0, sizeof(struct event_src));
+    }
+    pthread_mutex_unlock (&EventLoop.mutex);
+}
+
+//------------------------------------------------------------------------------
+// replace the fd of a source (opened again), the caller closes the old one
+// after it. return : 1 = fd polled, 0 = timer only
+//------------------------------------------------------------------------------
+int event_loop_fd (int id, int fd)
+{
+    struct event_src *s;
+    int polled = 0;
+
+    pthread_mutex_lock (&EventLoop.mutex);
+    if ((s = src_find (id)) != NULL) {
+        src_poll (s, fd);
+        polled = s->polled;
+    }
+    pthread_mutex_unlock (&EventLoop.mutex);
+
+    return polled;
+}
+
+//------------------------------------------------------------------------------
+// one-shot timer of a source (callback events = EVENT_LOOP_TIMER).
+// timeout_ms < 0 : stop the timer
+//------------------------------------------------------------------------------
+void event_loop_timer (int id, int timeout_ms)
+{
+    struct event_src *s;
+
+    pthread_mutex_lock (&EventLoop.mutex);
+    if ((s = src_find (id)) != NULL)
+        s->due_ms = (timeout_ms < 0) ? 0 : dev_time_ms () + timeout_ms;
+    pthread_mutex_unlock (&EventLoop.mutex);
+
+    // the loop thread sleeps with the old timeout
+    if (s != NULL)
+        loop_wake ();
+}
+
+//------------------------------------------------------------------------------
+int event_loop_self (void)
+{
+    return EventLoop.started && pthread_equal (pthread_self (), EventLoop.thread);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+//------------------------------------------------------------------------------
+/**
+ * @file event_loop.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (single event loop thread)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __EVENT_LOOP_H__
+#define __EVENT_LOOP_H__
+
+//------------------------------------------------------------------------------
+// One epoll thread for the long lived watches of the library (input event
+// nodes, sysfs attribute notify, uevent / rtnetlink sockets). A source is an
+// fd (EPOLLIN, EPOLLPRI ... level triggered) and / or a one-shot timer, the
+// callback runs on the loop thread and must not block.
+//
+// fd -1 or an fd epoll does not take (regular file) : timer only source.
+// event_loop_del() returns once the callback is not running any more
+// (the caller closes the fd after it). Blocking work (udevadm, dd ...) goes
+// to the worker pool.
+//------------------------------------------------------------------------------
+#define EVENT_LOOP_MAX      64
+
+// callback events : the timer of the source expired
+#define EVENT_LOOP_TIMER    0x80000000u
+
+typedef void (*event_loop_func_t) (void *arg, int fd, unsigned int events);
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  event_loop_add      (int fd, unsigned int events, event_loop_func_t func, void *arg);
+extern void event_loop_del      (int id);
+extern int  event_loop_fd       (int id, int fd);
+extern void event_loop_timer    (int id, int timeout_ms);
+extern int  event_loop_self     (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __EVENT_LOOP_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,322 @@
+//------------------------------------------------------------------------------
+/**
+ * @file file_path.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (in-process file resolver)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "file_path.h"
+
+//------------------------------------------------------------------------------
+#define FILE_PATH_HASH_SIZE 256
+
+struct file_entry {
+    struct file_entry *next;
+    unsigned int hash;
+    // returned by a lookup (config cache keeps these)
+    int used;
+    // basename (points into path)
+    const char *name;
+    char path[];
+};
+
+struct file_index {
+    char    roots[FILE_PATH_ROOT_MAX][PATH_MAX];
+    int     root_cnt;
+    int     depth;
+    // index is built once, on the first lookup
+    int     scanned;
+    struct file_entry *bucket[FILE_PATH_HASH_SIZE];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct file_index FileIndex = {
+    { { 0, }, }, 0, FILE_PATH_DEPTH_DEFAULT, 0, { NULL, }
+};
+
+static pthread_mutex_t mutex_file_path = PTHREAD_MUTEX_INITIALIZER;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static unsigned int name_hash (const char *name)
+{
+    return dev_fnv32_str (DEV_FNV32_INIT, name);
+}
+
+//------------------------------------------------------------------------------
+static struct file_entry *index_find (const char *name)
+{
+    unsigned int hash = name_hash (name);
+    struct file_entry *p = FileIndex.bucket[hash % FILE_PATH_HASH_SIZE];
+
+    for (; p != NULL; p = p->next)
+        if ((p->hash == hash) && !strcmp (p->name, name))
+            return p;
+
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void index_add (const char *path, int base)
+{
+    struct file_entry *p;
+    int len = strlen (path);
+
+    // keep the first match (same as the old 'find | head -1')
+    if (index_find (&path[base]) != NULL)
+        return;
+
+    if ((p = malloc (sizeof(struct file_entry) + len + 1)) == NULL)
+        return;
+
+    memcpy (p->path, path, len + 1);
+    p->used = 0;
+    p->name = &p->path[base];
+    p->hash = name_hash (p->name);
+    p->next = FileIndex.bucket[p->hash % FILE_PATH_HASH_SIZE];
+    FileIndex.bucket[p->hash % FILE_PATH_HASH_SIZE] = p;
+}
+
+//------------------------------------------------------------------------------
+static void index_clear (void)
+{
+    struct file_entry *p, *next;
+    int i;
+
+    for (i = 0; i < FILE_PATH_HASH_SIZE; i++) {
+        for (p = FileIndex.bucket[i]; p != NULL; p = next) {
+            next = p->next;
+            free (p);
+        }
+        FileIndex.bucket[i] = NULL;
+    }
+    FileIndex.scanned = 0;
+}
+
+//------------------------------------------------------------------------------
+static int scan_func (const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    (void)st;
+
+    switch (type) {
+        case FTW_F: case FTW_SL:
+            index_add (path, ftw->base);
+            break;
+        case FTW_D:
+            // skip hidden directories (.git ...) and anything below the depth limit
+            if (ftw->level && (path[ftw->base] == '.'))
+                return FTW_SKIP_SUBTREE;
+            if (ftw->level >= FileIndex.depth)
+                return FTW_SKIP_SUBTREE;
+            break;
+        default :
+            break;
+    }
+    return FTW_CONTINUE;
+}
+
+//------------------------------------------------------------------------------
+static int root_add (const char *root)
+{
+    char real[PATH_MAX];
+    int i;
+
+    if (FileIndex.root_cnt >= FILE_PATH_ROOT_MAX) {
+        printf ("%s : error! root table full (%s)\n", __func__, root);
+        return 0;
+    }
+    if (realpath (root, real) == NULL) {
+        printf ("%s : error! %s (%s)\n", __func__, root, strerror(errno));
+        return 0;
+    }
+    for (i = 0; i < FileIndex.root_cnt; i++)
+        if (!strcmp (FileIndex.roots[i], real))
+            return 1;
+
+    strncpy (FileIndex.roots[FileIndex.root_cnt++], real, PATH_MAX -1);
+    // new root, index must be rebuilt
+    index_clear ();
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void root_default (void)
+{
+    char *env, *tok, *save;
+
+    if (FileIndex.root_cnt)
+        return;
+
+    // same search start as the old 'pwd' + 'find'
+    root_add (".");
+
+    if ((env = getenv (FILE_PATH_ENV)) != NULL) {
+        char roots[PATH_MAX];
+
+        memset  (roots, 0, sizeof(roots));
+        strncpy (roots, env, sizeof(roots) -1);
+        for (tok = strtok_r (roots, ":", &save); tok != NULL; tok = strtok_r (NULL, ":", &save))
+            root_add (tok);
+    }
+}
+
+//------------------------------------------------------------------------------
+static int index_scan (void)
+{
+    int i;
+
+    root_default ();
+    index_clear  ();
+
+    for (i = 0; i < FileIndex.root_cnt; i++) {
+        if (nftw (FileIndex.roots[i], scan_func, 16, FTW_PHYS | FTW_ACTIONRETVAL) < 0)
+            printf ("%s : %s scan error!\n", __func__, FileIndex.roots[i]);
+    }
+    FileIndex.scanned = 1;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+int file_path_add_root (const char *root)
+{
+    int ret;
+
+    pthread_mutex_lock   (&mutex_file_path);
+    root_default ();
+    ret = root_add (root);
+    pthread_mutex_unlock (&mutex_file_path);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+void file_path_set_depth (int depth)
+{
+    pthread_mutex_lock   (&mutex_file_path);
+    if (FileIndex.depth != depth) {
+        FileIndex.depth = (depth > 0) ? depth : FILE_PATH_DEPTH_DEFAULT;
+        index_clear ();
+    }
+    pthread_mutex_unlock (&mutex_file_path);
+}
+
+//------------------------------------------------------------------------------
+int file_path_scan (void)
+{
+    int ret;
+
+    pthread_mutex_lock   (&mutex_file_path);
+    ret = index_scan ();
+    pthread_mutex_unlock (&mutex_file_path);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+// return 1 : find success, 0 : not found or the path does not fit (size)
+//------------------------------------------------------------------------------
+int file_path_lookup (const char *fname, char *file_path, int size)
+{
+    struct file_entry *p;
+    int ret = 0;
+
+    // already a path (absolute or relative), nothing to search
+    if (strchr (fname, '/') != NULL) {
+        char real[PATH_MAX];
+
+        if (realpath (fname, real) == NULL)
+            return 0;
+        if ((int)strlen (real) >= size) {
+            printf ("%s : %s path too long (max %d)!\n", __func__, real, size -1);
+            return 0;
+        }
+
+        memcpy (file_path, real, strlen (real) +1);
+        return 1;
+    }
+
+    pthread_mutex_lock   (&mutex_file_path);
+    // seeded entries (file_path_seed) are used without a tree scan
+    if (((p = index_find (fname)) == NULL) && !FileIndex.scanned) {
+        index_scan ();
+        p = index_find (fname);
+    }
+    if (p != NULL) {
+        // a cut path would open another file
+        if ((int)strlen (p->path) < size) {
+            memcpy (file_path, p->path, strlen (p->path) +1);
+            p->used = 1;
+            ret = 1;
+        } else
+            printf ("%s : %s path too long (max %d)!\n", __func__, p->path, size -1);
+    }
+    pthread_mutex_unlock (&mutex_file_path);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+// add a known name -> path (e.g. from the config cache) without scanning
+//------------------------------------------------------------------------------
+int file_path_seed (const char *path)
+{
+    const char *base = strrchr (path, '/');
+
+    if ((base == NULL) || (path[0] != '/') || access (path, F_OK))
+        return 0;
+
+    pthread_mutex_lock   (&mutex_file_path);
+    root_default ();
+    index_add (path, (int)(base - path) + 1);
+    pthread_mutex_unlock (&mutex_file_path);
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// call func for every path returned by a lookup. return : used path count
+//------------------------------------------------------------------------------
+int file_path_used (void (*func)(const char *path, void *arg), void *arg)
+{
+    struct file_entry *p;
+    int i, cnt = 0;
+
+    pthread_mutex_lock   (&mutex_file_path);
+    for (i = 0; i < FILE_PATH_HASH_SIZE; i++) {
+        for (p = FileIndex.bucket[i]; p != NULL; p = p->next) {
+            if (!p->used)
+                continue;
+            func (p->path, arg);
+            cnt++;
+        }
+    }
+    pthread_mutex_unlock (&mutex_file_path);
+
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
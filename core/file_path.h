@@ -0,0 +1,39 @@
+//------------------------------------------------------------------------------
+/**
+ * @file file_path.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (in-process file resolver)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __FILE_PATH_H__
+#define __FILE_PATH_H__
+
+//------------------------------------------------------------------------------
+// Search roots are scanned once (nftw) on the first lookup and every file name
+// found is kept in a name -> full path index. Default root is the current
+// working directory, extra roots can be added with the DEV_CHECK_PATH
+// environment variable (':' separated) or file_path_add_root().
+//------------------------------------------------------------------------------
+#define FILE_PATH_ROOT_MAX      8
+#define FILE_PATH_DEPTH_DEFAULT 8
+#define FILE_PATH_ENV           "DEV_CHECK_PATH"
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  file_path_add_root  (const char *root);
+extern void file_path_set_depth (int depth);
+extern int  file_path_scan      (void);
+extern int  file_path_lookup    (const char *fname, char *file_path, int size);
+extern int  file_path_seed      (const char *path);
+extern int  file_path_used      (void (*func)(const char *path, void *arg), void *arg);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __FILE_PATH_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
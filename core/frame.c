@@ -0,0 +1,352 @@
+//------------------------------------------------------------------------------
+/**
+ * @file frame.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (serial frame codec)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "frame.h"
+
+//------------------------------------------------------------------------------
+#define RING_MASK           (FRAME_RING_SIZE -1)
+
+// '@', cmd, gid, did, status, value, '#'
+#define FRAME_FIELD_MAX     8
+
+// field position in a ring (or in a linear buffer with mask = ~0)
+struct frame_field {
+    unsigned int pos, len;
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static inline char at (const char *buf, unsigned int mask, unsigned int pos)
+{
+    return buf[pos & mask];
+}
+
+//------------------------------------------------------------------------------
+// atoi() of a field (leading space, sign, digits)
+//------------------------------------------------------------------------------
+static int field_int (const char *buf, unsigned int mask, const struct frame_field *f)
+{
+    unsigned int i = f->pos, end = f->pos + f->len;
+    int value = 0, neg = 0;
+
+    while ((i < end) && (at (buf, mask, i) == ' '))  i++;
+
+    if (i < end) {
+        if      (at (buf, mask, i) == '-')  { neg = 1;  i++; }
+        else if (at (buf, mask, i) == '+')  {           i++; }
+    }
+    for (; i < end; i++) {
+        char c = at (buf, mask, i);
+        if ((c < '0') || (c > '9'))
+            break;
+        value = value * 10 + (c - '0');
+    }
+    return neg ? -value : value;
+}
+
+//------------------------------------------------------------------------------
+// status, value fields -> pdata (status_c, status_i, resp_s, resp_i)
+//------------------------------------------------------------------------------
+static void field_resp (const char *buf, unsigned int mask,
+                        const struct frame_field *status, const struct frame_field *value,
+                        parse_resp_data_t *pdata)
+{
+    unsigned int i;
+    int pos = 0;
+
+    if (status && status->len) {
+        pdata->status_c = at (buf, mask, status->pos);
+        pdata->status_i = (pdata->status_c == 'P') ? 1 : 0;
+    }
+    if (value) {
+        // resp str without padding space
+        for (i = 0; (i < value->len) && (pos < DEVICE_RESP_SIZE); i++) {
+            char c = at (buf, mask, value->pos + i);
+            if ((c != 0x20) && (c != 0x00))
+                pdata->resp_s[pos++] = c;
+        }
+        pdata->resp_i = field_int (buf, mask, value);
+    }
+}
+
+//------------------------------------------------------------------------------
+// split [pos, pos + len) at ','. return field count
+//------------------------------------------------------------------------------
+static int field_split (const char *buf, unsigned int mask, unsigned int pos, unsigned int len,
+                        struct frame_field *f)
+{
+    unsigned int i, start = pos;
+    int cnt = 0;
+
+    for (i = pos; i < pos + len; i++) {
+        if (at (buf, mask, i) == FRAME_SEP) {
+            if (cnt == FRAME_FIELD_MAX)
+                return cnt;
+            f[cnt].pos = start; f[cnt].len = i - start; cnt++;
+            start = i + 1;
+        }
+    }
+    if (cnt < FRAME_FIELD_MAX) {
+        f[cnt].pos = start; f[cnt].len = i - start; cnt++;
+    }
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+// '@,cmd,gid,did[,status,value],#' at [pos, pos + len). return 1 : decode ok
+//------------------------------------------------------------------------------
+static int decode_frame (const char *buf, unsigned int mask, unsigned int pos, unsigned int len,
+                         parse_resp_data_t *pdata)
+{
+    struct frame_field f[FRAME_FIELD_MAX];
+    int cnt;
+
+    if ((len < 2) || (at (buf, mask, pos) != FRAME_START) || (at (buf, mask, pos + len -1) != FRAME_END))
+        return 0;
+
+    cnt = field_split (buf, mask, pos, len, f);
+    // '@', cmd, gid, did, '#'
+    if ((cnt < 5) || (f[1].len != 1))
+        return 0;
+
+    memset (pdata, 0, sizeof(parse_resp_data_t));
+
+    pdata->cmd = at (buf, mask, f[1].pos);
+    pdata->gid = field_int (buf, mask, &f[2]);
+    pdata->did = field_int (buf, mask, &f[3]);
+
+    if (cnt >= 7)
+        field_resp (buf, mask, &f[4], &f[5], pdata);
+    else if (cnt == 6)
+        field_resp (buf, mask, &f[4], NULL, pdata);
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+void frame_ring_init (struct frame_ring *r)
+{
+    r->head = r->tail = 0;
+}
+
+//------------------------------------------------------------------------------
+// return : stored bytes (ring full -> less than len)
+//------------------------------------------------------------------------------
+int frame_ring_write (struct frame_ring *r, const char *data, int len)
+{
+    char *wptr;
+    int size, done = 0;
+
+    while ((done < len) && (size = frame_ring_space (r, &wptr)) > 0) {
+        if (size > len - done)
+            size = len - done;
+
+        memcpy (wptr, &data[done], size);
+        frame_ring_commit (r, size);
+        done += size;
+    }
+    return done;
+}
+
+//------------------------------------------------------------------------------
+// contiguous free area for read(fd, wptr, size) without a bounce buffer
+//------------------------------------------------------------------------------
+int frame_ring_space (struct frame_ring *r, char **wptr)
+{
+    unsigned int used = r->head - r->tail;
+    unsigned int off  = r->head & RING_MASK;
+    unsigned int size = FRAME_RING_SIZE - used;
+
+    if (size > FRAME_RING_SIZE - off)
+        size = FRAME_RING_SIZE - off;
+
+    *wptr = &r->buf[off];
+    return (int)size;
+}
+
+//------------------------------------------------------------------------------
+void frame_ring_commit (struct frame_ring *r, int len)
+{
+    r->head += len;
+}
+
+//------------------------------------------------------------------------------
+//
+// return : 1 = one frame decoded into pdata, 0 = need more data
+//
+//------------------------------------------------------------------------------
+int frame_ring_next (struct frame_ring *r, parse_resp_data_t *pdata)
+{
+    unsigned int i;
+
+    while (r->tail != r->head) {
+        // drop everything before the frame start
+        if (at (r->buf, RING_MASK, r->tail) != FRAME_START) {
+            r->tail++;
+            continue;
+        }
+
+        for (i = r->tail + 1; i != r->head; i++) {
+            char c = at (r->buf, RING_MASK, i);
+
+            if ((c == FRAME_END) || (c == FRAME_START) || (i - r->tail >= FRAME_SIZE_MAX))
+                break;
+        }
+
+        // partial frame, wait for the rest
+        if (i == r->head) {
+            if (i - r->tail < FRAME_SIZE_MAX)
+                return 0;
+        }
+        else if (at (r->buf, RING_MASK, i) == FRAME_END) {
+            unsigned int pos = r->tail, len = i - r->tail + 1;
+
+            r->tail = i + 1;
+            if (decode_frame (r->buf, RING_MASK, pos, len, pdata))
+                return 1;
+            continue;
+        }
+        // new '@' before '#' or frame too long : resync after this '@'
+        r->tail++;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// one serial frame in a linear buffer
+//------------------------------------------------------------------------------
+int frame_decode (const char *msg, int len, parse_resp_data_t *pdata)
+{
+    const char *end;
+
+    if ((len <= 0) || (msg[0] != FRAME_START))
+        return 0;
+    if ((end = memchr (msg, FRAME_END, len)) == NULL)
+        return 0;
+
+    return decode_frame (msg, ~0u, 0, (unsigned int)(end - msg) + 1, pdata);
+}
+
+//------------------------------------------------------------------------------
+// device resp 'status,value' (DEVICE_RESP_FORM_INT/STR output)
+//------------------------------------------------------------------------------
+int frame_decode_resp (const char *msg, int len, parse_resp_data_t *pdata)
+{
+    struct frame_field f[FRAME_FIELD_MAX];
+    int cnt;
+
+    if (len <= 0)
+        return 0;
+
+    cnt = field_split (msg, ~0u, 0, (unsigned int)len, f);
+
+    memset (pdata, 0, sizeof(parse_resp_data_t));
+    field_resp (msg, ~0u, &f[0], (cnt > 1) ? &f[1] : NULL, pdata);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//
+// Encoder (same bytes as the printf forms in lib_dev_check.h)
+//
+//------------------------------------------------------------------------------
+// "%0{width}d"
+//------------------------------------------------------------------------------
+static int put_int (char *p, int value, int width, char pad)
+{
+    char digit[12];
+    unsigned int u = (value < 0) ? -(unsigned int)value : (unsigned int)value;
+    int n = 0, len = 0;
+
+    do {
+        digit[n++] = '0' + (u % 10);
+        u /= 10;
+    } while (u);
+
+    if (pad == '0') {
+        if (value < 0)  { p[len++] = '-';   width--; }
+        while (width-- > n)     p[len++] = '0';
+    } else {
+        while (width-- > n + (value < 0))   p[len++] = ' ';
+        if (value < 0)  p[len++] = '-';
+    }
+    while (n)   p[len++] = digit[--n];
+
+    return len;
+}
+
+//------------------------------------------------------------------------------
+// "%{width}s"
+//------------------------------------------------------------------------------
+static int put_str (char *p, const char *str, int width)
+{
+    int slen = strlen (str), len = 0;
+
+    while (width-- > slen)  p[len++] = ' ';
+
+    memcpy (&p[len], str, slen);
+    return len + slen;
+}
+
+//------------------------------------------------------------------------------
+// SERIAL_RESP_FORM : "@,%c,%02d,%04d,%22s,#"
+//------------------------------------------------------------------------------
+int frame_encode (char *buf, char cmd, int gid, int did, const char *resp)
+{
+    char *p = buf;
+
+    *p++ = FRAME_START;  *p++ = FRAME_SEP;
+    *p++ = cmd;          *p++ = FRAME_SEP;
+    p += put_int (p, gid, DEVICE_GID_SIZE, '0');    *p++ = FRAME_SEP;
+    p += put_int (p, did, DEVICE_DID_SIZE, '0');    *p++ = FRAME_SEP;
+    p += put_str (p, resp, DEVICE_RESP_SIZE);       *p++ = FRAME_SEP;
+    *p++ = FRAME_END;    *p   = 0;
+
+    return (int)(p - buf);
+}
+
+//------------------------------------------------------------------------------
+// DEVICE_RESP_FORM_INT : "%c,%20d"
+//------------------------------------------------------------------------------
+int frame_encode_int (char *buf, char status, int value)
+{
+    char *p = buf;
+
+    *p++ = status;  *p++ = FRAME_SEP;
+    p += put_int (p, value, DEVICE_RESP_SIZE -2, ' ');
+    *p = 0;
+
+    return (int)(p - buf);
+}
+
+//------------------------------------------------------------------------------
+// DEVICE_RESP_FORM_STR : "%c,%20s"
+//------------------------------------------------------------------------------
+int frame_encode_str (char *buf, char status, const char *value)
+{
+    char *p = buf;
+
+    *p++ = status;  *p++ = FRAME_SEP;
+    p += put_str (p, value, DEVICE_RESP_SIZE -2);
+    *p = 0;
+
+    return (int)(p - buf);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+/**
+ * @file frame.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (serial frame codec)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __FRAME_H__
+#define __FRAME_H__
+
+//------------------------------------------------------------------------------
+// Streaming decoder : raw serial bytes are written into a frame_ring, every
+// '@ ... #' frame is decoded in place (no copy, no strtok) into
+// parse_resp_data_t. Partial frames stay in the ring until the rest arrives,
+// garbage between frames is dropped.
+//------------------------------------------------------------------------------
+// ring size must be a power of 2
+#define FRAME_RING_SIZE     4096
+// longest accepted frame ('@' ... '#'), longer data is resynced
+#define FRAME_SIZE_MAX      64
+
+#define FRAME_START         '@'
+#define FRAME_END           '#'
+#define FRAME_SEP           ','
+
+struct frame_ring {
+    // free running write / read index
+    unsigned int head, tail;
+    char buf[FRAME_RING_SIZE];
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct parse_resp_data__t;
+
+extern void frame_ring_init     (struct frame_ring *r);
+extern int  frame_ring_write    (struct frame_ring *r, const char *data, int len);
+extern int  frame_ring_space    (struct frame_ring *r, char **wptr);
+extern void frame_ring_commit   (struct frame_ring *r, int len);
+extern int  frame_ring_next     (struct frame_ring *r, struct parse_resp_data__t *pdata);
+
+extern int  frame_decode        (const char *msg, int len, struct parse_resp_data__t *pdata);
+extern int  frame_decode_resp   (const char *msg, int len, struct parse_resp_data__t *pdata);
+
+extern int  frame_encode        (char *buf, char cmd, int gid, int did, const char *resp);
+extern int  frame_encode_int    (char *buf, char status, int value);
+extern int  frame_encode_str    (char *buf, char status, const char *value);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __FRAME_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+/**
+ * @file group.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (device group registry)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "group.h"
+
+//------------------------------------------------------------------------------
+// name hash (open addressing, power of 2, > DEVICE_GROUP_MAX)
+#define GROUP_HASH_SIZE     256
+#define GROUP_HASH_MASK     (GROUP_HASH_SIZE -1)
+
+struct group_table {
+    // gid -> group
+    const struct dev_group *gid[DEVICE_GROUP_MAX];
+    // name -> group
+    const struct dev_group *name[GROUP_HASH_SIZE];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// filled by the module constructors, before main()
+static struct group_table GroupTable;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static unsigned int name_hash (const char *name, int len)
+{
+    return dev_fnv32 (DEV_FNV32_INIT, name, len);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+int device_group_register (const struct dev_group *grp)
+{
+    unsigned int pos;
+    int len = strlen (grp->name);
+
+    if ((grp->gid < 0) || (grp->gid >= DEVICE_GROUP_MAX) || GroupTable.gid[grp->gid]) {
+        printf ("%s : error! %s gid = %d\n", __func__, grp->name, grp->gid);
+        return 0;
+    }
+    if (device_group_lookup (grp->name, len) != NULL) {
+        printf ("%s : error! %s already registered\n", __func__, grp->name);
+        return 0;
+    }
+
+    for (pos = name_hash (grp->name, len); GroupTable.name[pos & GROUP_HASH_MASK]; pos++)
+        ;
+    GroupTable.name[pos & GROUP_HASH_MASK] = grp;
+    GroupTable.gid [grp->gid] = grp;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+const struct dev_group *device_group_find (int gid)
+{
+    if ((gid < 0) || (gid >= DEVICE_GROUP_MAX))
+        return NULL;
+
+    return GroupTable.gid[gid];
+}
+
+//------------------------------------------------------------------------------
+// lane of a gid (DEVICE_LANE_UNKNOWN : unknown gid / bad lane)
+//------------------------------------------------------------------------------
+int device_group_lane (int gid)
+{
+    const struct dev_group *grp = device_group_find (gid);
+
+    if ((grp == NULL) || (grp->lane < 0) || (grp->lane >= DEVICE_GROUP_MAX))
+        return DEVICE_LANE_UNKNOWN;
+
+    return grp->lane;
+}
+
+//------------------------------------------------------------------------------
+// name : not null terminated (config line token), len : name length
+//------------------------------------------------------------------------------
+const struct dev_group *device_group_lookup (const char *name, int len)
+{
+    const struct dev_group *grp;
+    unsigned int pos;
+
+    for (pos = name_hash (name, len); (grp = GroupTable.name[pos & GROUP_HASH_MASK]) != NULL; pos++) {
+        if (!strncmp (grp->name, name, len) && (grp->name[len] == 0))
+            return grp;
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------------
+/**
+ * @file group.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (device group registry)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __GROUP_H__
+#define __GROUP_H__
+
+//------------------------------------------------------------------------------
+// Every group (0.system ... 13.misc, or a board specific one) describes itself
+// with a dev_group and registers it with DEVICE_GROUP_REGISTER(). device_setup,
+// device_check and device_resp_check dispatch through this table :
+//   config line -> exact first token (name) lookup, check -> gid lookup.
+//------------------------------------------------------------------------------
+// GID is 2 digits in the serial protocol
+#define DEVICE_GROUP_MAX    100
+// 90 ~ 99 : config only groups (library settings, check = NULL)
+#define DEVICE_GROUP_CFG    90
+// lane of the unknown gid (lane arrays : DEVICE_LANE_UNKNOWN +1 entries)
+#define DEVICE_LANE_UNKNOWN DEVICE_GROUP_MAX
+
+struct parse_resp_data__t;
+struct dev_check_ctx;
+
+struct dev_group {
+    // config line first token
+    const char *name;
+    int gid;
+    // groups sharing hardware use the same lane (gid of the owner group)
+    int lane;
+
+    // group state in every dev_check_ctx (0 : none), copy of data_def (NULL : zero)
+    size_t data_size;
+    const void *data_def;
+
+    void (*init)       (struct dev_check_ctx *ctx, char *cfg);
+    // NULL : config only group
+    int  (*check)      (struct dev_check_ctx *ctx, int dev_id, char *resp);
+    // device_resp_check (NULL : not implement, status_i = 0)
+    int  (*data_check) (struct dev_check_ctx *ctx, struct parse_resp_data__t *pdata);
+    // context destroy : stop the threads using the group state (NULL : none)
+    void (*exit)       (struct dev_check_ctx *ctx);
+};
+
+#define DEVICE_GROUP_REGISTER(grp)                                          \
+    static void __attribute__((constructor)) grp##_register (void)         \
+    {                                                                       \
+        device_group_register (&grp);                                       \
+    }
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  device_group_register  (const struct dev_group *grp);
+extern const struct dev_group *device_group_find   (int gid);
+extern const struct dev_group *device_group_lookup (const char *name, int len);
+extern int  device_group_lane      (int gid);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __GROUP_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
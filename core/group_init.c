@@ -0,0 +1,358 @@
+//------------------------------------------------------------------------------
+/**
+ * @file group_init.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (parallel group init)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "group_init.h"
+
+//------------------------------------------------------------------------------
+enum {
+    // no config line : nothing to wait for
+    eINIT_NONE = 0,
+    // lines queued, waiting for the lane owner
+    eINIT_WAIT,
+    // submitted to the worker pool
+    eINIT_RUN,
+    eINIT_READY,
+};
+
+struct init_line {
+    struct init_line *next;
+    char line[STR_PATH_LENGTH];
+};
+
+struct init_ctl;
+
+struct init_grp {
+    int state;
+    struct init_line *head, *tail;
+
+    // init_job argument
+    struct init_ctl *ctl;
+    int gid;
+    // queued / running init_job (device_group_ready runs it in place)
+    struct worker_future future;
+};
+
+struct init_ctl {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    struct dev_check_ctx *ctx;
+    struct init_grp grp[DEVICE_GROUP_MAX];
+
+    // groups not ready yet, done() is called when it drops to 0
+    int remain;
+    // done() running (device_group_init_wait)
+    int busy;
+    void (*done)(void *arg);
+    void *arg;
+};
+
+//------------------------------------------------------------------------------
+// lane owner gid this group has to wait for, -1 : none
+// (only a group that owns its own lane can be a dependency, so no cycle)
+//------------------------------------------------------------------------------
+static int init_depend (int gid)
+{
+    const struct dev_group *grp = device_group_find (gid), *owner;
+
+    if ((grp == NULL) || (grp->lane == gid))
+        return -1;
+    if (((owner = device_group_find (grp->lane)) == NULL) || (owner->lane != owner->gid))
+        return -1;
+
+    return owner->gid;
+}
+
+//------------------------------------------------------------------------------
+static void init_job (void *arg);
+
+// (mutex locked)
+static void init_submit (struct init_ctl *ctl, int gid)
+{
+    ctl->grp[gid].state = eINIT_RUN;
+
+    if (!worker_future_submit (&ctl->grp[gid].future, init_job, &ctl->grp[gid], 0)) {
+        // no worker : run it here
+        pthread_mutex_unlock (&ctl->mutex);
+        init_job (&ctl->grp[gid]);
+        pthread_mutex_lock   (&ctl->mutex);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void init_job (void *arg)
+{
+    struct init_ctl *ctl = ((struct init_grp *)arg)->ctl;
+    int gid = ((struct init_grp *)arg)->gid, i, dep;
+    const struct dev_group *grp = device_group_find (gid);
+    struct init_line *p, *next;
+    void (*done)(void *arg) = NULL;
+    void *done_arg = NULL;
+
+    pthread_mutex_lock   (&ctl->mutex);
+    p = ctl->grp[gid].head;
+    ctl->grp[gid].head = ctl->grp[gid].tail = NULL;
+    pthread_mutex_unlock (&ctl->mutex);
+
+    // lines of one group keep the config file order
+    for (; p != NULL; p = next) {
+        next = p->next;
+        grp->init (ctl->ctx, p->line);
+        free (p);
+    }
+
+    pthread_mutex_lock (&ctl->mutex);
+    ctl->grp[gid].state = eINIT_READY;
+    pthread_cond_broadcast (&ctl->cond);
+
+    // release the groups waiting for this lane owner
+    for (i = 0; i < DEVICE_GROUP_MAX; i++) {
+        if ((ctl->grp[i].state == eINIT_WAIT) && ((dep = init_depend (i)) == gid))
+            init_submit (ctl, i);
+    }
+    if (!--ctl->remain && ctl->done) {
+        done     = ctl->done;
+        done_arg = ctl->arg;
+        ctl->done = NULL;
+        ctl->busy = 1;
+    }
+    pthread_mutex_unlock (&ctl->mutex);
+
+    if (done) {
+        done (done_arg);
+
+        pthread_mutex_lock     (&ctl->mutex);
+        ctl->busy = 0;
+        pthread_cond_broadcast (&ctl->cond);
+        pthread_mutex_unlock   (&ctl->mutex);
+    }
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// init state of a new context (dev_check_ctx_alloc)
+//------------------------------------------------------------------------------
+struct init_ctl *device_group_init_alloc (struct dev_check_ctx *ctx)
+{
+    struct init_ctl *ctl;
+    pthread_condattr_t attr;
+    int i;
+
+    if ((ctl = calloc (1, sizeof(struct init_ctl))) == NULL)
+        return NULL;
+
+    pthread_mutex_init (&ctl->mutex, NULL);
+
+    pthread_condattr_init     (&attr);
+    pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+    pthread_cond_init         (&ctl->cond, &attr);
+    pthread_condattr_destroy  (&attr);
+
+    ctl->ctx = ctx;
+    for (i = 0; i < DEVICE_GROUP_MAX; i++) {
+        ctl->grp[i].ctl = ctl;
+        ctl->grp[i].gid = i;
+    }
+    return ctl;
+}
+
+//------------------------------------------------------------------------------
+// (device_group_init_wait first)
+//------------------------------------------------------------------------------
+void device_group_init_free (struct init_ctl *ctl)
+{
+    struct init_line *p, *next;
+    int i;
+
+    if (ctl == NULL)
+        return;
+
+    // lines queued but never started
+    for (i = 0; i < DEVICE_GROUP_MAX; i++)
+        for (p = ctl->grp[i].head; p != NULL; p = next) {
+            next = p->next;
+            free (p);
+        }
+
+    pthread_mutex_destroy (&ctl->mutex);
+    pthread_cond_destroy  (&ctl->cond);
+    free (ctl);
+}
+
+//------------------------------------------------------------------------------
+// queue one config line (copied, init modifies it)
+//------------------------------------------------------------------------------
+void device_group_init_add (struct dev_check_ctx *ctx, int gid, const char *line)
+{
+    struct init_ctl *ctl = ctx->init;
+    struct init_line *p;
+
+    if (device_group_find (gid) == NULL)
+        return;
+
+    if ((p = malloc (sizeof(struct init_line))) == NULL) {
+        printf ("%s : line alloc error!\n", __func__);
+        return;
+    }
+    memset  (p, 0, sizeof(struct init_line));
+    strncpy (p->line, line, sizeof(p->line) -1);
+
+    pthread_mutex_lock (&ctl->mutex);
+    if (ctl->grp[gid].tail) ctl->grp[gid].tail->next = p;
+    else                    ctl->grp[gid].head       = p;
+    ctl->grp[gid].tail = p;
+
+    if (ctl->grp[gid].state != eINIT_WAIT) {
+        ctl->grp[gid].state = eINIT_WAIT;
+        ctl->remain++;
+    }
+    pthread_mutex_unlock (&ctl->mutex);
+}
+
+//------------------------------------------------------------------------------
+//
+// start the queued groups. done(arg) is called once every group is ready.
+// return : started group count
+//
+//------------------------------------------------------------------------------
+int device_group_init_start (struct dev_check_ctx *ctx, void (*done)(void *arg), void *arg)
+{
+    struct init_ctl *ctl = ctx->init;
+    int i, dep, cnt = 0;
+
+    pthread_mutex_lock (&ctl->mutex);
+    ctl->done = done;
+    ctl->arg  = arg;
+
+    if (!ctl->remain) {
+        ctl->done = NULL;
+        pthread_mutex_unlock (&ctl->mutex);
+        if (done)
+            done (arg);
+        return 0;
+    }
+
+    for (i = 0; i < DEVICE_GROUP_MAX; i++) {
+        if (ctl->grp[i].state != eINIT_WAIT)
+            continue;
+
+        cnt++;
+        dep = init_depend (i);
+        if ((dep < 0) || (ctl->grp[dep].state == eINIT_NONE) ||
+                         (ctl->grp[dep].state == eINIT_READY))
+            init_submit (ctl, i);
+    }
+    pthread_mutex_unlock (&ctl->mutex);
+
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+// every started group ready and done() returned
+//------------------------------------------------------------------------------
+void device_group_init_wait (struct dev_check_ctx *ctx)
+{
+    struct init_ctl *ctl = ctx->init;
+    int i, run;
+
+    pthread_mutex_lock (&ctl->mutex);
+    while (1) {
+        for (i = 0, run = ctl->busy; (i < DEVICE_GROUP_MAX) && !run; i++)
+            run = (ctl->grp[i].state == eINIT_RUN);
+        if (!run)
+            break;
+        pthread_cond_wait (&ctl->cond, &ctl->mutex);
+    }
+    pthread_mutex_unlock (&ctl->mutex);
+}
+
+//------------------------------------------------------------------------------
+// GROUP_WAIT_FOREVER caller : the init job of gid (or of its lane owner) may
+// sit in the pool queue behind this caller, and the caller may be a worker
+// itself (batch, async, plan). Run the queued job here instead of waiting
+// for a free thread. return 0 : nothing to run, wait for the cond.
+// (mutex locked, unlocked while the job runs)
+//------------------------------------------------------------------------------
+static int init_help (struct init_ctl *ctl, int gid)
+{
+    struct dev_check_ctx *ctx = ctl->ctx;
+    int dep;
+
+    switch (ctl->grp[gid].state) {
+    case eINIT_WAIT:
+        // lane owner first : its init_job submits this group
+        if (((dep = init_depend (gid)) < 0) ||
+            ((ctl->grp[dep].state != eINIT_WAIT) && (ctl->grp[dep].state != eINIT_RUN)))
+            return 0;
+        pthread_mutex_unlock (&ctl->mutex);
+        device_group_ready   (ctx, dep, GROUP_WAIT_FOREVER);
+        pthread_mutex_lock   (&ctl->mutex);
+        return 1;
+    case eINIT_RUN:
+        // idle future : init_submit ran the job on its own thread
+        if (!worker_future_busy (&ctl->grp[gid].future))
+            return 0;
+        pthread_mutex_unlock (&ctl->mutex);
+        worker_future_wait   (&ctl->grp[gid].future);
+        pthread_mutex_lock   (&ctl->mutex);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+// readiness barrier. return 1 : group usable, 0 : timeout
+//
+//------------------------------------------------------------------------------
+int device_group_ready (struct dev_check_ctx *ctx, int gid, int timeout_ms)
+{
+    struct init_ctl *ctl = ctx->init;
+    struct timespec ts;
+    int ret = 1;
+
+    if ((gid < 0) || (gid >= DEVICE_GROUP_MAX))
+        return 1;
+
+    if (timeout_ms > 0)
+        dev_abs_timeout (&ts, timeout_ms);
+
+    pthread_mutex_lock (&ctl->mutex);
+    while ((ctl->grp[gid].state == eINIT_WAIT) || (ctl->grp[gid].state == eINIT_RUN)) {
+        if (!timeout_ms) {
+            ret = 0;
+            break;
+        }
+        if (timeout_ms < 0) {
+            if (!init_help (ctl, gid))
+                pthread_cond_wait (&ctl->cond, &ctl->mutex);
+        }
+        else if (pthread_cond_timedwait (&ctl->cond, &ctl->mutex, &ts)) {
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock (&ctl->mutex);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+/**
+ * @file group_init.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (parallel group init)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __GROUP_INIT_H__
+#define __GROUP_INIT_H__
+
+//------------------------------------------------------------------------------
+// device_setup() queues the config lines per group, then every group runs its
+// init lines (file order) as one job on the worker pool.
+//
+// Dependency : a group on another group's lane (LED -> ETHERNET,
+// USB/FW -> STORAGE, GPIO -> HEADER) starts after the lane owner is ready,
+// other groups start at once. Each group is marked ready when its last line
+// is done, device_check() waits only for the group it checks.
+// A check waiting forever runs its group init (and the lane owner init) in
+// place when the job is still queued : a check on a pool thread never waits
+// for an init queued behind it.
+// The queue and the ready state belong to a dev_check_ctx.
+//------------------------------------------------------------------------------
+#define GROUP_WAIT_FOREVER  -1
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+struct init_ctl;
+struct dev_check_ctx;
+
+extern struct init_ctl *device_group_init_alloc (struct dev_check_ctx *ctx);
+extern void device_group_init_free  (struct init_ctl *ctl);
+
+extern void device_group_init_add   (struct dev_check_ctx *ctx, int gid, const char *line);
+extern int  device_group_init_start (struct dev_check_ctx *ctx, void (*done)(void *arg), void *arg);
+extern void device_group_init_wait  (struct dev_check_ctx *ctx);
+extern int  device_group_ready      (struct dev_check_ctx *ctx, int gid, int timeout_ms);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __GROUP_INIT_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
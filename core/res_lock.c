@@ -0,0 +1,203 @@
+//------------------------------------------------------------------------------
+/**
+ * @file res_lock.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (named resource lock)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "res_lock.h"
+#include "dev_util.h"
+
+//------------------------------------------------------------------------------
+struct res_lock {
+    // "" = free entry (entries are not removed, the index is kept)
+    char name[RES_LOCK_NAME_MAX];
+    pthread_rwlock_t lock;
+};
+
+struct res_lock_tbl {
+    // name lookup / add
+    pthread_mutex_t mutex;
+    struct res_lock res[RES_LOCK_MAX];
+    int cnt;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct res_lock_tbl ResLock = {
+    PTHREAD_MUTEX_INITIALIZER, { { { 0, }, PTHREAD_RWLOCK_INITIALIZER }, }, 0
+};
+
+// set held by this thread (one at a time)
+static __thread int ResLockHeld = 0;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// return : table index, -1 = table full
+//------------------------------------------------------------------------------
+static int res_find (const char *name)
+{
+    pthread_rwlockattr_t attr;
+    int i, idx = -1;
+
+    pthread_mutex_lock (&ResLock.mutex);
+    for (i = 0; i < ResLock.cnt; i++) {
+        if (!strcmp (ResLock.res[i].name, name)) {
+            idx = i;
+            break;
+        }
+    }
+    if ((idx < 0) && (ResLock.cnt < RES_LOCK_MAX)) {
+        idx = ResLock.cnt++;
+        strncpy (ResLock.res[idx].name, name, RES_LOCK_NAME_MAX -1);
+
+        // a link speed change is not kept waiting by the readers
+        pthread_rwlockattr_init    (&attr);
+        pthread_rwlockattr_setkind_np (&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        pthread_rwlock_init        (&ResLock.res[idx].lock, &attr);
+        pthread_rwlockattr_destroy (&attr);
+    }
+    pthread_mutex_unlock (&ResLock.mutex);
+
+    return idx;
+}
+
+//------------------------------------------------------------------------------
+// ts : CLOCK_MONOTONIC deadline, NULL = no timeout. return : 1 = locked
+//------------------------------------------------------------------------------
+static int res_lock (pthread_rwlock_t *lock, int mode, const struct timespec *ts)
+{
+    if (ts == NULL)
+        return (mode == RES_LOCK_WRITE) ?
+            !pthread_rwlock_wrlock (lock) : !pthread_rwlock_rdlock (lock);
+
+    return (mode == RES_LOCK_WRITE) ?
+        !pthread_rwlock_clockwrlock (lock, CLOCK_MONOTONIC, ts) :
+        !pthread_rwlock_clockrdlock (lock, CLOCK_MONOTONIC, ts);
+}
+
+//------------------------------------------------------------------------------
+// name order : the same for every thread
+//------------------------------------------------------------------------------
+static void set_sort (struct res_lock_set *set)
+{
+    int i, j, idx, mode;
+
+    for (i = 1; i < set->cnt; i++) {
+        idx = set->res[i].idx;     mode = set->res[i].mode;
+        for (j = i; j > 0; j--) {
+            if (strcmp (ResLock.res[set->res[j -1].idx].name, ResLock.res[idx].name) <= 0)
+                break;
+            set->res[j] = set->res[j -1];
+        }
+        set->res[j].idx  = idx;
+        set->res[j].mode = mode;
+    }
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+void res_lock_set_init (struct res_lock_set *set)
+{
+    memset (set, 0, sizeof(struct res_lock_set));
+}
+
+//------------------------------------------------------------------------------
+// resource name (printf format). A name in the set twice is locked once,
+// write if one of them is a write.
+// return : 1 = added, 0 = error (set / lock table full)
+//------------------------------------------------------------------------------
+int res_lock_set_add (struct res_lock_set *set, int mode, const char *fmt, ...)
+{
+    char name[RES_LOCK_NAME_MAX];
+    va_list ap;
+    int i, idx;
+
+    va_start  (ap, fmt);
+    vsnprintf (name, sizeof(name), fmt, ap);
+    va_end    (ap);
+
+    if (set->held || !name[0] || ((idx = res_find (name)) < 0)) {
+        printf ("%s : error! %s (held or lock max = %d)\n", __func__, name, RES_LOCK_MAX);
+        return 0;
+    }
+    for (i = 0; i < set->cnt; i++) {
+        if (set->res[i].idx == idx) {
+            if (mode == RES_LOCK_WRITE)
+                set->res[i].mode = RES_LOCK_WRITE;
+            return 1;
+        }
+    }
+    if (set->cnt >= RES_LOCK_SET_MAX) {
+        printf ("%s : error! %s (set max = %d)\n", __func__, name, RES_LOCK_SET_MAX);
+        return 0;
+    }
+    set->res[set->cnt].idx  = idx;
+    set->res[set->cnt].mode = mode;
+    set->cnt++;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// every resource of the set or none. timeout_ms < 0 : no timeout
+// return : 1 = locked, 0 = timeout / a set is held by this thread
+//------------------------------------------------------------------------------
+int res_lock_acquire (struct res_lock_set *set, int timeout_ms)
+{
+    struct timespec ts;
+    int i;
+
+    if (set->held || ResLockHeld) {
+        printf ("%s : error! a set is held by this thread\n", __func__);
+        return 0;
+    }
+    set_sort (set);
+
+    // one deadline for the whole set
+    dev_abs_timeout (&ts, (timeout_ms > 0) ? timeout_ms : 0);
+    for (i = 0; i < set->cnt; i++) {
+        if (!res_lock (&ResLock.res[set->res[i].idx].lock, set->res[i].mode,
+                       (timeout_ms < 0) ? NULL : &ts)) {
+            while (i--)
+                pthread_rwlock_unlock (&ResLock.res[set->res[i].idx].lock);
+            return 0;
+        }
+    }
+    set->held   = 1;
+    ResLockHeld = 1;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+void res_lock_release (struct res_lock_set *set)
+{
+    int i;
+
+    if (!set->held)
+        return;
+
+    for (i = set->cnt -1; i >= 0; i--)
+        pthread_rwlock_unlock (&ResLock.res[set->res[i].idx].lock);
+
+    set->held   = 0;
+    ResLockHeld = 0;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
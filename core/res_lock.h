@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+/**
+ * @file res_lock.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (named resource lock)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __RES_LOCK_H__
+#define __RES_LOCK_H__
+
+//------------------------------------------------------------------------------
+// Hardware shared by the checks is locked by name, the same name in every
+// group : network interface ("eth0"), audio card ("hw:0,0"), block device
+// (config path), "usb_hub", GPIO bank ("gpio_bank{num / RES_LOCK_GPIO_BANK}").
+// Reader / writer locks (writer preferred) : measuring / using the resource
+// is a read, changing it (link speed) or a measurement that needs it alone
+// (dd speed, aplay) is a write.
+//
+// A check puts every resource it needs in a res_lock_set and takes them at
+// once, in name order. A thread holds one set at a time (a second acquire
+// fails), so two checks never wait for each other in a cycle.
+// Never hold a set across an open-ended wait (e.g. iperf3 server waiting for
+// the host client) : a writer queued behind it also stalls the new readers.
+//------------------------------------------------------------------------------
+#define RES_LOCK_MAX        64
+#define RES_LOCK_SET_MAX    16
+#define RES_LOCK_NAME_MAX   64
+
+#define RES_LOCK_READ       0
+#define RES_LOCK_WRITE      1
+
+// gpio numbers per bank (sysfs gpio chip base)
+#define RES_LOCK_GPIO_BANK  32
+
+struct res_lock_set {
+    int cnt;
+    struct {
+        // lock table index
+        int idx;
+        int mode;
+    } res[RES_LOCK_SET_MAX];
+    int held;
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern void res_lock_set_init   (struct res_lock_set *set);
+extern int  res_lock_set_add    (struct res_lock_set *set, int mode, const char *fmt, ...)
+                                    __attribute__((format(printf, 3, 4)));
+extern int  res_lock_acquire    (struct res_lock_set *set, int timeout_ms);
+extern void res_lock_release    (struct res_lock_set *set);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __RES_LOCK_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
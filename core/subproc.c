@@ -0,0 +1,275 @@
+//------------------------------------------------------------------------------
+/**
+ * @file subproc.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (subprocess runner)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+//------------------------------------------------------------------------------
+#include "subproc.h"
+#include "dev_util.h"
+
+extern char **environ;
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// pid clear (reap) vs kill
+static pthread_mutex_t mutex_subproc = PTHREAD_MUTEX_INITIALIZER;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// return : ms left to the deadline, -1 = no deadline
+//------------------------------------------------------------------------------
+static int subproc_left (struct subproc *sp)
+{
+    long long left;
+
+    if (!sp->deadline)
+        return -1;
+
+    left = sp->deadline - dev_time_ms ();
+    return (left > 0) ? (int)left : 0;
+}
+
+//------------------------------------------------------------------------------
+static int subproc_fill (struct subproc *sp)
+{
+    struct pollfd pfd = { sp->fd, POLLIN, 0 };
+    ssize_t n;
+    int left;
+
+    while (1) {
+        n = read (sp->fd, &sp->buf[sp->len], sizeof(sp->buf) - sp->len);
+        if (n > 0) {
+            sp->len += n;
+            return 1;
+        }
+        // EOF
+        if (n == 0)
+            return 0;
+        if ((errno != EAGAIN) && (errno != EINTR))
+            return 0;
+
+        if ((left = subproc_left (sp)) == 0) {
+            sp->timeout = 1;
+            return 0;
+        }
+        poll (&pfd, 1, left);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void subproc_signal (struct subproc *sp, int sig)
+{
+    pthread_mutex_lock   (&mutex_subproc);
+    if (sp->pid > 0)
+        kill (sp->pid, sig);
+    pthread_mutex_unlock (&mutex_subproc);
+}
+
+//------------------------------------------------------------------------------
+// return : 1 = exited (not reaped), 0 = still running
+//------------------------------------------------------------------------------
+static int subproc_exited (struct subproc *sp, int wait_ms)
+{
+    siginfo_t info;
+    long long end = dev_time_ms () + wait_ms;
+    int options = WEXITED | WNOWAIT | ((wait_ms < 0) ? 0 : WNOHANG);
+
+    while (1) {
+        memset (&info, 0, sizeof(info));
+        // WNOWAIT : the pid stays allocated until subproc_wait clears it
+        if (waitid (P_PID, sp->pid, &info, options) < 0) {
+            if (errno == EINTR)
+                continue;
+            return 1;
+        }
+        if (info.si_pid == sp->pid)
+            return 1;
+        if (dev_time_ms () >= end)
+            return 0;
+        usleep (10 * 1000);
+    }
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// argv[0] : tool name (PATH) or full path. return 1 = started.
+//
+//------------------------------------------------------------------------------
+int subproc_spawn (struct subproc *sp, char *const argv[], int flags, int timeout)
+{
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t attr;
+    sigset_t sigs;
+    int fds[2] = { -1, -1 }, err;
+    pid_t pid;
+
+    memset (sp, 0, sizeof(struct subproc));
+    sp->fd = -1;
+
+    if ((flags & SUBPROC_OUT) && pipe2 (fds, O_CLOEXEC)) {
+        printf ("%s : pipe error! (%s)\n", __func__, strerror(errno));
+        return 0;
+    }
+
+    posix_spawn_file_actions_init (&fa);
+    posix_spawn_file_actions_addopen (&fa, 0, "/dev/null", O_RDONLY, 0);
+    if (flags & SUBPROC_OUT) {
+        posix_spawn_file_actions_adddup2 (&fa, fds[1], 1);
+        posix_spawn_file_actions_adddup2 (&fa, fds[1], 2);
+    } else {
+        posix_spawn_file_actions_addopen (&fa, 1, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_adddup2 (&fa, 1, 2);
+    }
+
+    // the tool must not inherit the library signal state (SIGPIPE ignored ...)
+    posix_spawnattr_init (&attr);
+    sigemptyset (&sigs);
+    posix_spawnattr_setsigmask (&attr, &sigs);
+    sigaddset (&sigs, SIGPIPE);
+    posix_spawnattr_setsigdefault (&attr, &sigs);
+    posix_spawnattr_setflags (&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    err = posix_spawnp (&pid, argv[0], &fa, &attr, argv, environ);
+
+    posix_spawnattr_destroy (&attr);
+    posix_spawn_file_actions_destroy (&fa);
+    if (fds[1] >= 0)
+        close (fds[1]);
+
+    if (err) {
+        printf ("%s : %s spawn error! (%s)\n", __func__, argv[0], strerror(err));
+        if (fds[0] >= 0)
+            close (fds[0]);
+        return 0;
+    }
+    if (fds[0] >= 0) {
+        fcntl (fds[0], F_SETFL, fcntl (fds[0], F_GETFL) | O_NONBLOCK);
+        sp->fd = fds[0];
+    }
+    sp->deadline = timeout ? dev_time_ms () + timeout : 0;
+    sp->pid = pid;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//
+// next output line (with '\n', cut at size -1). NULL : EOF or deadline
+//
+//------------------------------------------------------------------------------
+char *subproc_gets (struct subproc *sp, char *line, int size)
+{
+    char *nl;
+    int n;
+
+    if ((sp->fd < 0) || (size < 2))
+        return NULL;
+
+    while (((nl = memchr (sp->buf, '\n', sp->len)) == NULL) &&
+           (sp->len < (int)sizeof(sp->buf)) && (sp->len < size -1)) {
+        if (!subproc_fill (sp))
+            break;
+    }
+
+    n = (nl != NULL) ? (nl - sp->buf + 1) : sp->len;
+    if (!n)
+        return NULL;
+    if (n > size -1)
+        n = size -1;
+
+    memcpy  (line, sp->buf, n);
+    line[n] = 0;
+    memmove (sp->buf, &sp->buf[n], sp->len - n);
+    sp->len -= n;
+    return line;
+}
+
+//------------------------------------------------------------------------------
+//
+// drains the output, waits for the exit (kills it at the deadline).
+// return : exit status, -1 = killed / signaled / not started
+//
+//------------------------------------------------------------------------------
+int subproc_wait (struct subproc *sp)
+{
+    int status = -1;
+
+    if (sp->fd >= 0) {
+        // the tool may block on a full pipe until its output is read
+        do {
+            sp->len = 0;
+        } while (subproc_fill (sp));
+        close (sp->fd);
+        sp->fd = -1;
+    }
+    if (sp->pid <= 0)
+        return -1;
+
+    if (!subproc_exited (sp, subproc_left (sp))) {
+        sp->timeout = 1;
+        subproc_signal (sp, SIGTERM);
+        if (!subproc_exited (sp, SUBPROC_KILL_MS)) {
+            subproc_signal (sp, SIGKILL);
+            subproc_exited (sp, -1);
+        }
+    }
+
+    pthread_mutex_lock   (&mutex_subproc);
+    if (waitpid (sp->pid, &status, 0) < 0)
+        status = -1;
+    sp->pid = 0;
+    pthread_mutex_unlock (&mutex_subproc);
+
+    if ((status == -1) || !WIFEXITED(status))
+        return -1;
+
+    return sp->timeout ? -1 : WEXITSTATUS(status);
+}
+
+//------------------------------------------------------------------------------
+// stop a running tool (SIGTERM), the owner still calls subproc_wait
+//------------------------------------------------------------------------------
+void subproc_kill (struct subproc *sp)
+{
+    subproc_signal (sp, SIGTERM);
+}
+
+//------------------------------------------------------------------------------
+// run a tool without output. return : exit status, -1 = error / timeout
+//------------------------------------------------------------------------------
+int subproc_run (char *const argv[], int timeout)
+{
+    struct subproc sp;
+
+    if (!subproc_spawn (&sp, argv, 0, timeout))
+        return -1;
+
+    return subproc_wait (&sp);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------
+/**
+ * @file subproc.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (subprocess runner)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __SUBPROC_H__
+#define __SUBPROC_H__
+
+#include <sys/types.h>
+
+//------------------------------------------------------------------------------
+// External tools (dd, iperf3, nmap, ethtool, aplay ...) are started with
+// posix_spawnp, no /bin/sh : argv[0] is looked up in PATH, no pipes,
+// redirections or globbing. stdin is /dev/null.
+//
+// SUBPROC_OUT : stdout + stderr go to a non-blocking pipe read with
+//               subproc_gets(), otherwise both go to /dev/null.
+//
+// timeout (ms, 0 = none) is a deadline for the whole run : subproc_gets()
+// returns NULL and subproc_wait() kills the tool (SIGTERM, SIGKILL after
+// SUBPROC_KILL_MS) when it is reached.
+//
+// subproc_kill() may be called from any thread, it only signals the pid of
+// a tool that has not been reaped yet (never a recycled pid).
+//------------------------------------------------------------------------------
+#define SUBPROC_OUT         0x01
+
+#define SUBPROC_BUF_SIZE    512
+#define SUBPROC_KILL_MS     200
+
+struct subproc {
+    // 0 : not running (reaped)
+    volatile pid_t pid;
+    // read end of the output pipe, -1 : none
+    int fd;
+    // CLOCK_MONOTONIC ms, 0 = none
+    long long deadline;
+    // deadline reached
+    int timeout;
+
+    // output not returned by subproc_gets yet
+    int  len;
+    char buf[SUBPROC_BUF_SIZE];
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int   subproc_spawn   (struct subproc *sp, char *const argv[], int flags, int timeout);
+extern char *subproc_gets    (struct subproc *sp, char *line, int size);
+extern int   subproc_wait    (struct subproc *sp);
+extern void  subproc_kill    (struct subproc *sp);
+extern int   subproc_run     (char *const argv[], int timeout);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __SUBPROC_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
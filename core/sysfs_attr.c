@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sysfs_attr.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (sysfs attribute handle cache)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "sysfs_attr.h"
+
+//------------------------------------------------------------------------------
+struct sysfs_attr {
+    // remapped path (malloc), NULL = free entry
+    char *path;
+    // O_RDONLY, O_WRONLY
+    int mode;
+    // -1 = open failed (opened again on the next access)
+    int fd;
+    // regular file (fake device tree) : a write also truncates
+    int regular;
+};
+
+struct sysfs_attr_tbl {
+    // rdlock : access with a cached fd, wrlock : open / close
+    pthread_rwlock_t lock;
+    // open addressing (path, mode), at least one free entry
+    struct sysfs_attr attr[SYSFS_ATTR_MAX];
+    int cnt;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct sysfs_attr_tbl SysfsAttr = {
+    PTHREAD_RWLOCK_INITIALIZER, { { NULL, 0, 0, 0 }, }, 0
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static unsigned int attr_hash (const char *path, int mode)
+{
+    return (dev_fnv32_str (DEV_FNV32_INIT, path) ^ mode) % SYSFS_ATTR_MAX;
+}
+
+//------------------------------------------------------------------------------
+// (locked)
+//------------------------------------------------------------------------------
+static struct sysfs_attr *attr_find (const char *rpath, int mode, int add)
+{
+    struct sysfs_attr *a;
+    unsigned int idx = attr_hash (rpath, mode), i;
+
+    for (i = 0; i < SYSFS_ATTR_MAX; i++) {
+        a = &SysfsAttr.attr[(idx + i) % SYSFS_ATTR_MAX];
+        if (a->path == NULL)
+            break;
+        if ((a->mode == mode) && !strcmp (a->path, rpath))
+            return a;
+    }
+    if (!add || (i == SYSFS_ATTR_MAX) || (SysfsAttr.cnt >= SYSFS_ATTR_MAX -1))
+        return NULL;
+    if ((a->path = strdup (rpath)) == NULL)
+        return NULL;
+
+    a->mode = mode;
+    a->fd   = -1;
+    SysfsAttr.cnt++;
+    return a;
+}
+
+//------------------------------------------------------------------------------
+static int attr_open (const char *path, int mode, int *regular)
+{
+    struct stat st;
+    int fd;
+
+    if ((fd = dev_root_open (path, mode | O_CLOEXEC)) < 0)
+        return -1;
+
+    *regular = !fstat (fd, &st) && S_ISREG(st.st_mode);
+    return fd;
+}
+
+//------------------------------------------------------------------------------
+// one pread / pwrite at offset 0. return : bytes, -1 = error (errno)
+//------------------------------------------------------------------------------
+static int attr_rw (int fd, int mode, int regular, char *buf, int size)
+{
+    ssize_t n;
+
+    if (mode == O_RDONLY) {
+        if ((n = pread (fd, buf, size -1, 0)) >= 0)
+            buf[n] = 0;
+        return (int)n;
+    }
+    if (((n = pwrite (fd, buf, size, 0)) >= 0) && regular) {
+        if (ftruncate (fd, n) < 0)
+            return -1;
+    }
+    return (int)n;
+}
+
+//------------------------------------------------------------------------------
+static int attr_io (const char *path, int mode, char *buf, int size)
+{
+    struct sysfs_attr *a;
+    char rbuf[PATH_MAX];
+    const char *rpath = dev_root_path (path, rbuf, sizeof(rbuf));
+    int n, fd, regular = 0;
+
+    // cached fd : one syscall
+    pthread_rwlock_rdlock (&SysfsAttr.lock);
+    if (((a = attr_find (rpath, mode, 0)) != NULL) && (a->fd >= 0)) {
+        n = attr_rw (a->fd, mode, a->regular, buf, size);
+        if ((n >= 0) || (errno != ENODEV)) {
+            pthread_rwlock_unlock (&SysfsAttr.lock);
+            return n;
+        }
+    }
+    pthread_rwlock_unlock (&SysfsAttr.lock);
+
+    // first access, open failed before or ENODEV : (re)open
+    pthread_rwlock_wrlock (&SysfsAttr.lock);
+    if ((a = attr_find (rpath, mode, 1)) != NULL) {
+        if (a->fd >= 0)
+            close (a->fd);
+        a->fd = attr_open (path, mode, &a->regular);
+        n = (a->fd >= 0) ? attr_rw (a->fd, mode, a->regular, buf, size) : -1;
+        pthread_rwlock_unlock (&SysfsAttr.lock);
+        return n;
+    }
+    pthread_rwlock_unlock (&SysfsAttr.lock);
+
+    // handle table full
+    if ((fd = attr_open (path, mode, &regular)) < 0)
+        return -1;
+    n = attr_rw (fd, mode, regular, buf, size);
+    close (fd);
+    return n;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// return : bytes read (buf is a string, cut at size -1), -1 = error
+//
+//------------------------------------------------------------------------------
+int sysfs_attr_read (const char *path, char *buf, int size)
+{
+    int n;
+
+    if (size < 1)
+        return -1;
+
+    if ((n = attr_io (path, O_RDONLY, buf, size)) < 0)
+        buf[0] = 0;
+
+    return n;
+}
+
+//------------------------------------------------------------------------------
+// return : 1 = written, 0 = error
+//------------------------------------------------------------------------------
+int sysfs_attr_write (const char *path, const char *wdata)
+{
+    int len = strlen (wdata);
+
+    // O_WRONLY : the buffer is only read
+    return (attr_io (path, O_WRONLY, (char *)wdata, len) == len);
+}
+
+//------------------------------------------------------------------------------
+void sysfs_attr_close (void)
+{
+    struct sysfs_attr *a;
+    int i;
+
+    pthread_rwlock_wrlock (&SysfsAttr.lock);
+    for (i = 0; i < SYSFS_ATTR_MAX; i++) {
+        a = &SysfsAttr.attr[i];
+        if (a->fd >= 0 && a->path != NULL)
+            close (a->fd);
+        free (a->path);
+        memset (a, 0, sizeof(struct sysfs_attr));
+    }
+    SysfsAttr.cnt = 0;
+    pthread_rwlock_unlock (&SysfsAttr.lock);
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,39 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sysfs_attr.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (sysfs attribute handle cache)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __SYSFS_ATTR_H__
+#define __SYSFS_ATTR_H__
+
+//------------------------------------------------------------------------------
+// sysfs / procfs attributes are opened once (dev_root_open, so the device
+// root and its open latency apply) and the fd is kept : a read is one
+// pread(fd, buf, n, 0), a write is one pwrite(fd, buf, n, 0). An fd failing
+// with ENODEV (device removed and added again) is opened again and the
+// access retried once.
+//
+// Handles are keyed by the remapped path and shared by every context. More
+// than SYSFS_ATTR_MAX attributes : the others are opened per access.
+// sysfs_attr_close() drops every handle (device root change).
+//------------------------------------------------------------------------------
+#define SYSFS_ATTR_MAX      128
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  sysfs_attr_read     (const char *path, char *buf, int size);
+extern int  sysfs_attr_write    (const char *path, const char *wdata);
+extern void sysfs_attr_close    (void);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __SYSFS_ATTR_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
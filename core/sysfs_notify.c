@@ -0,0 +1,330 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sysfs_notify.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (sysfs attribute change notify)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+//------------------------------------------------------------------------------
+#include "../lib_dev_check.h"
+#include "sysfs_notify.h"
+
+//------------------------------------------------------------------------------
+struct notify_watch {
+    // event loop source id (watch id), 0 = free entry
+    int id;
+    // malloc, opened through dev_root_open
+    char *path;
+    // -1 = not opened (opened again on the timer)
+    int fd;
+    // the kernel sent POLLPRI / POLLERR : no timer
+    int notify;
+    // adaptive timer (ms)
+    int interval, interval_max;
+
+    // value read at least once
+    int valid;
+    char value[SYSFS_NOTIFY_VALUE_MAX];
+
+    sysfs_notify_func_t func;
+    void *arg;
+};
+
+struct sysfs_notify {
+    pthread_mutex_t mutex;
+    struct notify_watch watch[SYSFS_NOTIFY_MAX];
+};
+
+// sysfs_notify_wait state (caller stack)
+struct notify_wait {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    const char *value;
+    int done;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct sysfs_notify SysfsNotify = {
+    PTHREAD_MUTEX_INITIALIZER, { { 0, }, }
+};
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static struct notify_watch *watch_find (int id)
+{
+    int i;
+
+    if (id <= 0)
+        return NULL;
+
+    for (i = 0; i < SYSFS_NOTIFY_MAX; i++) {
+        if (SysfsNotify.watch[i].id == id)
+            return &SysfsNotify.watch[i];
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int watch_open (const char *path)
+{
+    return dev_root_open (path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+}
+
+//------------------------------------------------------------------------------
+// read the value again (open it first if needed).
+// return : 1 = changed (or first value), 0 = same value (mutex locked)
+//------------------------------------------------------------------------------
+static int watch_read (struct notify_watch *w)
+{
+    char rdata[SYSFS_NOTIFY_VALUE_MAX];
+    ssize_t n = -1;
+
+    if ((w->fd < 0) && ((w->fd = watch_open (w->path)) >= 0))
+        event_loop_fd (w->id, w->fd);
+
+    // sysfs : the read also re-arms POLLPRI
+    if ((w->fd >= 0) && ((n = pread (w->fd, rdata, sizeof(rdata) -1, 0)) < 0)) {
+        // device removed : opened again on the timer
+        if ((errno == ENODEV) || (errno == EBADF)) {
+            event_loop_fd (w->id, -1);
+            close (w->fd);
+            w->fd     = -1;
+            w->notify = 0;
+        }
+    }
+    // link down speed (EINVAL), missing attribute : empty value
+    rdata[(n > 0) ? n : 0] = 0;
+
+    if (w->valid && !strcmp (w->value, rdata))
+        return 0;
+
+    memcpy (w->value, rdata, sizeof(rdata));
+    w->valid = 1;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// (mutex locked)
+//------------------------------------------------------------------------------
+static void watch_timer (struct notify_watch *w, int changed)
+{
+    if (changed)
+        w->interval = SYSFS_NOTIFY_POLL_MIN_MS;
+    else if ((w->interval *= 2) > w->interval_max)
+        w->interval = w->interval_max;
+
+    // notified by the kernel : no timer
+    event_loop_timer (w->id, ((w->fd >= 0) && w->notify) ? -1 : w->interval);
+}
+
+//------------------------------------------------------------------------------
+// event loop callback : POLLPRI / POLLERR or the poll timer
+//------------------------------------------------------------------------------
+static void watch_event (void *arg, int fd, unsigned int events)
+{
+    // entry is not freed before its event loop source (sysfs_notify_del)
+    struct notify_watch *w = (struct notify_watch *)arg;
+    char value[SYSFS_NOTIFY_VALUE_MAX];
+    sysfs_notify_func_t func = NULL;
+    int id, changed;
+
+    (void)fd;
+    pthread_mutex_lock (&SysfsNotify.mutex);
+    if (!(id = w->id)) {
+        pthread_mutex_unlock (&SysfsNotify.mutex);
+        return;
+    }
+    if (!(events & EVENT_LOOP_TIMER))
+        w->notify = 1;
+
+    changed = watch_read (w);
+    watch_timer (w, changed);
+    if (changed) {
+        memcpy (value, w->value, sizeof(value));
+        func = w->func;     arg = w->arg;
+    }
+    pthread_mutex_unlock (&SysfsNotify.mutex);
+
+    // sysfs_notify_del waits for this (event_loop_del)
+    if ((func != NULL) && func (arg, value))
+        sysfs_notify_del (id);
+}
+
+//------------------------------------------------------------------------------
+static int watch_add (const char *path, sysfs_notify_func_t func, void *arg, int interval_max)
+{
+    struct notify_watch *w = NULL;
+    int i, id = 0;
+
+    if ((path == NULL) || !path[0] || (func == NULL))
+        return 0;
+
+    pthread_mutex_lock (&SysfsNotify.mutex);
+    for (i = 0; i < SYSFS_NOTIFY_MAX; i++) {
+        if (!SysfsNotify.watch[i].id) {
+            w = &SysfsNotify.watch[i];
+            break;
+        }
+    }
+    if ((w != NULL) && ((w->path = strdup (path)) != NULL)) {
+        w->fd = watch_open (path);
+        // the callback waits for the mutex : id is set before it runs
+        if ((id = event_loop_add (w->fd, EPOLLPRI | EPOLLERR, watch_event, w)) != 0) {
+            w->id           = id;
+            w->notify       = 0;
+            w->interval     = SYSFS_NOTIFY_POLL_MIN_MS;
+            w->interval_max = interval_max;
+            w->valid        = 0;
+            w->func         = func;
+            w->arg          = arg;
+            // first value : on the event loop
+            event_loop_timer (id, 0);
+        } else {
+            if (w->fd >= 0)
+                close (w->fd);
+            free (w->path);
+            memset (w, 0, sizeof(struct notify_watch));
+        }
+    }
+    pthread_mutex_unlock (&SysfsNotify.mutex);
+
+    if (!id)
+        printf ("%s : error! %s (watch max = %d)\n", __func__, path, SYSFS_NOTIFY_MAX);
+
+    return id;
+}
+
+//------------------------------------------------------------------------------
+// sysfs_notify_wait callback : the value up to the white space must match
+//------------------------------------------------------------------------------
+static int wait_match (void *arg, const char *value)
+{
+    struct notify_wait *nw = (struct notify_wait *)arg;
+    int len = strlen (nw->value);
+
+    if (strncmp (value, nw->value, len) || (value[len] && !strchr (" \t\r\n", value[len])))
+        return 0;
+
+    pthread_mutex_lock   (&nw->mutex);
+    nw->done = 1;
+    pthread_cond_signal  (&nw->cond);
+    pthread_mutex_unlock (&nw->mutex);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// return : watch id, 0 = error
+//
+//------------------------------------------------------------------------------
+int sysfs_notify_add (const char *path, sysfs_notify_func_t func, void *arg)
+{
+    return watch_add (path, func, arg, SYSFS_NOTIFY_POLL_MAX_MS);
+}
+
+//------------------------------------------------------------------------------
+// the callback is not running / called any more once it returns.
+// (id 0 or a watch already stopped : nothing to do)
+//------------------------------------------------------------------------------
+void sysfs_notify_del (int id)
+{
+    struct notify_watch *w;
+
+    if (id <= 0)
+        return;
+
+    // waits for a running callback (not on the event loop thread)
+    event_loop_del (id);
+
+    pthread_mutex_lock (&SysfsNotify.mutex);
+    if ((w = watch_find (id)) != NULL) {
+        if (w->fd >= 0)
+            close (w->fd);
+        free (w->path);
+        memset (w, 0, sizeof(struct notify_watch));
+    }
+    pthread_mutex_unlock (&SysfsNotify.mutex);
+}
+
+//------------------------------------------------------------------------------
+// last value of a watch. return : length, -1 = not read yet / no watch
+//------------------------------------------------------------------------------
+int sysfs_notify_value (int id, char *buf, int size)
+{
+    struct notify_watch *w;
+    int len = -1;
+
+    if (size < 1)
+        return -1;
+
+    pthread_mutex_lock (&SysfsNotify.mutex);
+    if (((w = watch_find (id)) != NULL) && w->valid) {
+        strncpy (buf, w->value, size -1);
+        buf[size -1] = 0;
+        len = strlen (buf);
+    }
+    pthread_mutex_unlock (&SysfsNotify.mutex);
+
+    return len;
+}
+
+//------------------------------------------------------------------------------
+// wait until the attribute reads value (e.g. link speed "1000").
+// return : 1 = matched, 0 = timeout / error
+//------------------------------------------------------------------------------
+int sysfs_notify_wait (const char *path, const char *value, int timeout_ms)
+{
+    struct notify_wait nw;
+    pthread_condattr_t attr;
+    struct timespec ts;
+    int id, done;
+
+    memset (&nw, 0, sizeof(nw));
+    nw.value = value;
+    pthread_mutex_init        (&nw.mutex, NULL);
+    pthread_condattr_init     (&attr);
+    pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+    pthread_cond_init         (&nw.cond, &attr);
+    pthread_condattr_destroy  (&attr);
+
+    if ((id = watch_add (path, wait_match, &nw, SYSFS_NOTIFY_WAIT_MAX_MS)) != 0) {
+        dev_abs_timeout (&ts, timeout_ms);
+        pthread_mutex_lock (&nw.mutex);
+        while (!nw.done) {
+            if (pthread_cond_timedwait (&nw.cond, &nw.mutex, &ts))
+                break;
+        }
+        pthread_mutex_unlock (&nw.mutex);
+        // nw is on this stack : no callback after this
+        sysfs_notify_del (id);
+    }
+    done = nw.done;
+
+    pthread_cond_destroy  (&nw.cond);
+    pthread_mutex_destroy (&nw.mutex);
+    return done;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------------
+/**
+ * @file sysfs_notify.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (sysfs attribute change notify)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __SYSFS_NOTIFY_H__
+#define __SYSFS_NOTIFY_H__
+
+//------------------------------------------------------------------------------
+// The registered attributes are watched on the event loop for POLLPRI /
+// POLLERR (sysfs_notify() of the driver), the callback gets the new value on
+// every change. The first value is reported as a change.
+//
+// An attribute that never notifies (most netdev / vendor attributes, files of
+// a fake device tree) is read again on a timer : SYSFS_NOTIFY_POLL_MIN_MS
+// after a change, doubled while the value does not change up to the max of
+// the watch. Once the kernel notifies an attribute its timer is dropped.
+// A missing attribute (device not there yet) is opened again on the timer.
+//
+// Callbacks run on the event loop thread. return 1 : stop watching.
+//------------------------------------------------------------------------------
+#define SYSFS_NOTIFY_MAX            32
+#define SYSFS_NOTIFY_VALUE_MAX      64
+
+#define SYSFS_NOTIFY_POLL_MIN_MS    10
+#define SYSFS_NOTIFY_POLL_MAX_MS    1000
+// sysfs_notify_wait : somebody is waiting for the value
+#define SYSFS_NOTIFY_WAIT_MAX_MS    50
+
+typedef int (*sysfs_notify_func_t) (void *arg, const char *value);
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  sysfs_notify_add    (const char *path, sysfs_notify_func_t func, void *arg);
+extern void sysfs_notify_del    (int id);
+extern int  sysfs_notify_value  (int id, char *buf, int size);
+extern int  sysfs_notify_wait   (const char *path, const char *value, int timeout_ms);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __SYSFS_NOTIFY_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,313 @@
+//------------------------------------------------------------------------------
+/**
+ * @file worker.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (shared worker pool)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "worker.h"
+#include "dev_util.h"
+
+//------------------------------------------------------------------------------
+struct worker_job {
+    struct worker_job *next;
+    void (*func)(void *arg);
+    void *arg;
+
+    // NULL : worker_submit (no completion)
+    struct worker_future *future;
+    int flags;
+};
+
+struct worker_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    // job fifo
+    struct worker_job *head, *tail;
+
+    // running threads, idle threads, queued jobs
+    int threads, idle, queued;
+
+    // WORKER_LONG jobs (queued or running), threads above the max for them
+    int longrun;
+    // future finished (CLOCK_MONOTONIC, worker_init)
+    pthread_cond_t done;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct worker_pool WorkerPool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0, 0,
+    0, PTHREAD_COND_INITIALIZER
+};
+static pthread_once_t WorkerOnce = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static void worker_init (void)
+{
+    pthread_condattr_t attr;
+
+    // timed wait must not jump with the wall clock
+    pthread_condattr_init     (&attr);
+    pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+    pthread_cond_init         (&WorkerPool.done, &attr);
+    pthread_condattr_destroy  (&attr);
+}
+
+//------------------------------------------------------------------------------
+static int worker_thread_max (void)
+{
+    long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+    if (cpus < WORKER_THREAD_MIN)   return WORKER_THREAD_MIN;
+    if (cpus > WORKER_THREAD_MAX)   return WORKER_THREAD_MAX;
+    return (int)cpus;
+}
+
+//------------------------------------------------------------------------------
+// take a queued job off the fifo (mutex locked)
+//------------------------------------------------------------------------------
+static void queue_remove (struct worker_pool *pool, struct worker_job *job)
+{
+    struct worker_job **pp, *prev = NULL;
+
+    for (pp = &pool->head; *pp != NULL; prev = *pp, pp = &(*pp)->next) {
+        if (*pp != job)
+            continue;
+
+        *pp = job->next;
+        if (pool->tail == job)
+            pool->tail = prev;
+        pool->queued--;
+        return;
+    }
+}
+
+//------------------------------------------------------------------------------
+// job finished or dropped (mutex locked)
+//------------------------------------------------------------------------------
+static void job_done (struct worker_pool *pool, struct worker_job *job)
+{
+    if (job->flags & WORKER_LONG)
+        pool->longrun--;
+
+    if (job->future != NULL) {
+        job->future->job   = NULL;
+        job->future->state = WORKER_FUTURE_IDLE;
+        pthread_cond_broadcast (&pool->done);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void *thread_func_worker (void *arg)
+{
+    struct worker_pool *pool = (struct worker_pool *)arg;
+    struct worker_job *job;
+
+    while (1) {
+        pthread_mutex_lock (&pool->mutex);
+        pool->idle++;
+        while (pool->head == NULL)
+            pthread_cond_wait (&pool->cond, &pool->mutex);
+        pool->idle--;
+
+        job = pool->head;
+        if ((pool->head = job->next) == NULL)
+            pool->tail = NULL;
+        pool->queued--;
+        if (job->future != NULL) {
+            job->future->job   = NULL;
+            job->future->state = WORKER_FUTURE_RUNNING;
+        }
+        pthread_mutex_unlock (&pool->mutex);
+
+        job->func (job->arg);
+
+        pthread_mutex_lock (&pool->mutex);
+        job_done (pool, job);
+        // thread added for a long job : not needed any more
+        if (pool->threads > worker_thread_max () + pool->longrun) {
+            pool->threads--;
+            pthread_mutex_unlock (&pool->mutex);
+            free (job);
+            break;
+        }
+        pthread_mutex_unlock (&pool->mutex);
+        free (job);
+    }
+    return arg;
+}
+
+//------------------------------------------------------------------------------
+static int pool_submit (void (*func)(void *arg), void *arg, struct worker_future *f, int flags)
+{
+    struct worker_pool *pool = &WorkerPool;
+    struct worker_job *job;
+    pthread_t thread;
+
+    if ((job = malloc (sizeof(struct worker_job))) == NULL) {
+        printf ("%s : job alloc error!\n", __func__);
+        return 0;
+    }
+    job->func   = func;
+    job->arg    = arg;
+    job->next   = NULL;
+    job->future = f;
+    job->flags  = flags;
+
+    pthread_mutex_lock (&pool->mutex);
+    if ((f != NULL) && (f->state != WORKER_FUTURE_IDLE)) {
+        pthread_mutex_unlock (&pool->mutex);
+        free (job);
+        printf ("%s : error! future busy\n", __func__);
+        return 0;
+    }
+    if (f != NULL) {
+        f->state = WORKER_FUTURE_QUEUED;
+        f->job   = job;
+    }
+    if (flags & WORKER_LONG)
+        pool->longrun++;
+
+    if (pool->tail) pool->tail->next = job;
+    else            pool->head       = job;
+    pool->tail = job;
+    pool->queued++;
+
+    // grow the pool while there are more jobs than waiting threads
+    if ((pool->queued > pool->idle) && (pool->threads < worker_thread_max () + pool->longrun)) {
+        if (!pthread_create (&thread, NULL, thread_func_worker, pool)) {
+            pthread_detach (thread);
+            pool->threads++;
+        } else
+            printf ("%s : pthread_create error!\n", __func__);
+    }
+    pthread_cond_signal  (&pool->cond);
+    pthread_mutex_unlock (&pool->mutex);
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+int worker_submit (void (*func)(void *arg), void *arg)
+{
+    return pool_submit (func, arg, NULL, 0);
+}
+
+//------------------------------------------------------------------------------
+int worker_threads (void)
+{
+    return worker_thread_max ();
+}
+
+//------------------------------------------------------------------------------
+// f NULL : no completion, only the flags (WORKER_LONG)
+// return : 1 = queued, 0 = error (future still busy)
+//------------------------------------------------------------------------------
+int worker_future_submit (struct worker_future *f, void (*func)(void *arg), void *arg, int flags)
+{
+    pthread_once (&WorkerOnce, worker_init);
+    return pool_submit (func, arg, f, flags);
+}
+
+//------------------------------------------------------------------------------
+int worker_future_busy (struct worker_future *f)
+{
+    return (f->state != WORKER_FUTURE_IDLE);
+}
+
+//------------------------------------------------------------------------------
+// wait for the job (a job not started yet runs on this thread)
+//------------------------------------------------------------------------------
+void worker_future_wait (struct worker_future *f)
+{
+    struct worker_pool *pool = &WorkerPool;
+    struct worker_job *job;
+
+    pthread_once (&WorkerOnce, worker_init);
+
+    pthread_mutex_lock (&pool->mutex);
+    if ((f->state == WORKER_FUTURE_QUEUED) && ((job = f->job) != NULL)) {
+        queue_remove (pool, job);
+        f->job   = NULL;
+        f->state = WORKER_FUTURE_RUNNING;
+        pthread_mutex_unlock (&pool->mutex);
+
+        job->func (job->arg);
+
+        pthread_mutex_lock (&pool->mutex);
+        job_done (pool, job);
+        pthread_mutex_unlock (&pool->mutex);
+        free (job);
+        return;
+    }
+    while (f->state != WORKER_FUTURE_IDLE)
+        pthread_cond_wait (&pool->done, &pool->mutex);
+    pthread_mutex_unlock (&pool->mutex);
+}
+
+//------------------------------------------------------------------------------
+// return : 1 = finished (or idle), 0 = timeout
+//------------------------------------------------------------------------------
+int worker_future_timedwait (struct worker_future *f, int timeout_ms)
+{
+    struct worker_pool *pool = &WorkerPool;
+    struct timespec ts;
+    int done;
+
+    pthread_once (&WorkerOnce, worker_init);
+
+    dev_abs_timeout (&ts, timeout_ms);
+    pthread_mutex_lock (&pool->mutex);
+    while (f->state != WORKER_FUTURE_IDLE) {
+        if (pthread_cond_timedwait (&pool->done, &pool->mutex, &ts))
+            break;
+    }
+    done = (f->state == WORKER_FUTURE_IDLE);
+    pthread_mutex_unlock (&pool->mutex);
+
+    return done;
+}
+
+//------------------------------------------------------------------------------
+// drop a job not started yet. return : 1 = dropped (or idle), 0 = running
+//------------------------------------------------------------------------------
+int worker_future_cancel (struct worker_future *f)
+{
+    struct worker_pool *pool = &WorkerPool;
+    struct worker_job *job = NULL;
+    int cancel;
+
+    pthread_mutex_lock (&pool->mutex);
+    if ((f->state == WORKER_FUTURE_QUEUED) && ((job = f->job) != NULL)) {
+        queue_remove (pool, job);
+        job_done (pool, job);
+    } else
+        job = NULL;
+    cancel = (f->state == WORKER_FUTURE_IDLE);
+    pthread_mutex_unlock (&pool->mutex);
+
+    free (job);
+    return cancel;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
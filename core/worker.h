@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+/**
+ * @file worker.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (shared worker pool)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __WORKER_H__
+#define __WORKER_H__
+
+//------------------------------------------------------------------------------
+// Worker threads are started on the first submit (up to WORKER_THREAD_MAX,
+// default = online cpu count, min WORKER_THREAD_MIN) and live until exit.
+//------------------------------------------------------------------------------
+#define WORKER_THREAD_MIN   2
+#define WORKER_THREAD_MAX   8
+
+//------------------------------------------------------------------------------
+// A future tracks one job of the pool (zero = idle, so it can live in the
+// default state of a group). worker_future_wait() runs a job not started yet
+// in place : a job waiting for another job never waits for a free thread.
+//
+// WORKER_LONG : the job blocks for a long time (tool server, playback, dd).
+// It does not count against WORKER_THREAD_MAX, the pool adds a thread for it.
+//------------------------------------------------------------------------------
+#define WORKER_LONG             0x01
+
+#define WORKER_FUTURE_IDLE      0
+#define WORKER_FUTURE_QUEUED    1
+#define WORKER_FUTURE_RUNNING   2
+
+struct worker_job;
+
+struct worker_future {
+    volatile int state;
+    // queued job (run in place / cancel)
+    struct worker_job *job;
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int  worker_submit   (void (*func)(void *arg), void *arg);
+extern int  worker_threads  (void);
+
+extern int  worker_future_submit    (struct worker_future *f, void (*func)(void *arg), void *arg, int flags);
+extern int  worker_future_busy      (struct worker_future *f);
+extern void worker_future_wait      (struct worker_future *f);
+extern int  worker_future_timedwait (struct worker_future *f, int timeout_ms);
+extern int  worker_future_cancel    (struct worker_future *f);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __WORKER_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
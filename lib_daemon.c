@@ -0,0 +1,461 @@
+//------------------------------------------------------------------------------
+/**
+ * @file lib_daemon.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (serial protocol daemon)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/epoll.h>
+
+//------------------------------------------------------------------------------
+#include "lib_dev_check.h"
+#include "lib_daemon.h"
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#if defined(__LIB_DEV_CHECK_APP__)
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+struct daemon_req {
+    // 0 = free
+    int used;
+    int gid, did, lane;
+    // arrival order (per lane FIFO)
+    unsigned int seq;
+    // 0 = queued, else running (check_async ticket)
+    int ticket;
+};
+
+struct daemon_ctl {
+    int epoll_fd, port_fd, event_fd;
+    // pty slave kept open : no hangup on the master while no client is attached
+    int slave_fd;
+
+    struct frame_ring rx;
+
+    char tx[DAEMON_TX_SIZE];
+    int  tx_len, tx_wait;
+
+    struct daemon_req req[DAEMON_REQ_MAX];
+    unsigned int seq;
+    // a check of the lane is on the worker pool
+    unsigned char lane_busy[DEVICE_LANE_UNKNOWN +1];
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+static struct daemon_ctl DaemonCTL;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+static speed_t baud_speed (int baud)
+{
+    switch (baud) {
+        case 9600:      return B9600;
+        case 19200:     return B19200;
+        case 38400:     return B38400;
+        case 57600:     return B57600;
+        case 115200:    return B115200;
+        case 230400:    return B230400;
+        case 460800:    return B460800;
+        case 921600:    return B921600;
+        default:
+            printf ("%s : unsupported baud %d, use %d\n", __func__, baud, DAEMON_BAUD_DEF);
+            return B115200;
+    }
+}
+
+//------------------------------------------------------------------------------
+// raw 8N1, no flow control, read returns what is there
+//------------------------------------------------------------------------------
+static int tty_raw (int fd, int baud)
+{
+    struct termios tio;
+
+    if (tcgetattr (fd, &tio) < 0) {
+        printf ("%s : tcgetattr error! (%s)\n", __func__, strerror (errno));
+        return 0;
+    }
+    cfmakeraw (&tio);
+    tio.c_cflag |=  (CLOCAL | CREAD);
+    tio.c_cflag &= ~CRTSCTS;
+    tio.c_cc[VMIN]  = 1;
+    tio.c_cc[VTIME] = 0;
+
+    cfsetispeed (&tio, baud_speed (baud));
+    cfsetospeed (&tio, baud_speed (baud));
+
+    if (tcsetattr (fd, TCSANOW, &tio) < 0) {
+        printf ("%s : tcsetattr error! (%s)\n", __func__, strerror (errno));
+        return 0;
+    }
+    tcflush (fd, TCIOFLUSH);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int port_open (struct daemon_ctl *ctl, const char *port, int baud)
+{
+    const char *slave;
+
+    ctl->slave_fd = -1;
+
+    if (strcmp (port, DAEMON_PORT_PTY)) {
+        if ((ctl->port_fd = open (port, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+            printf ("%s : %s open error! (%s)\n", __func__, port, strerror (errno));
+            return 0;
+        }
+        return tty_raw (ctl->port_fd, baud);
+    }
+
+    if ((ctl->port_fd = posix_openpt (O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        printf ("%s : posix_openpt error! (%s)\n", __func__, strerror (errno));
+        return 0;
+    }
+    if (grantpt (ctl->port_fd) || unlockpt (ctl->port_fd) || ((slave = ptsname (ctl->port_fd)) == NULL)) {
+        printf ("%s : pty setup error! (%s)\n", __func__, strerror (errno));
+        return 0;
+    }
+    if ((ctl->slave_fd = open (slave, O_RDWR | O_NOCTTY | O_CLOEXEC)) < 0) {
+        printf ("%s : %s open error! (%s)\n", __func__, slave, strerror (errno));
+        return 0;
+    }
+    // line discipline of the slave side : no echo, no '\n' -> '\r\n'
+    if (!tty_raw (ctl->slave_fd, baud))
+        return 0;
+
+    printf ("%s : pty slave = %s\n", __func__, slave);
+    fflush (stdout);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static void port_events (struct daemon_ctl *ctl, unsigned int events)
+{
+    struct epoll_event ev;
+
+    memset (&ev, 0, sizeof(ev));
+    ev.events  = events;
+    ev.data.fd = ctl->port_fd;
+
+    if (epoll_ctl (ctl->epoll_fd, EPOLL_CTL_MOD, ctl->port_fd, &ev) < 0)
+        printf ("%s : epoll_ctl error! (%s)\n", __func__, strerror (errno));
+}
+
+//------------------------------------------------------------------------------
+// write what the port takes, the rest waits for EPOLLOUT
+//------------------------------------------------------------------------------
+static void tx_flush (struct daemon_ctl *ctl)
+{
+    int len;
+
+    while (ctl->tx_len) {
+        if ((len = write (ctl->port_fd, ctl->tx, ctl->tx_len)) < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN)
+                printf ("%s : write error! (%s)\n", __func__, strerror (errno));
+            break;
+        }
+        ctl->tx_len -= len;
+        memmove (ctl->tx, &ctl->tx[len], ctl->tx_len);
+    }
+
+    if (ctl->tx_len && !ctl->tx_wait)
+        port_events (ctl, EPOLLIN | EPOLLOUT);
+    else if (!ctl->tx_len && ctl->tx_wait)
+        port_events (ctl, EPOLLIN);
+
+    ctl->tx_wait = ctl->tx_len ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+static void tx_queue (struct daemon_ctl *ctl, const char *msg, int len)
+{
+    if (ctl->tx_len + len > DAEMON_TX_SIZE) {
+        DEV_LOG (eLOG_WARN, DEV_LOG_GID_NONE, "%s : tx full, drop %d bytes\n", __func__, len);
+        return;
+    }
+    memcpy (&ctl->tx[ctl->tx_len], msg, len);
+    ctl->tx_len += len;
+
+    tx_flush (ctl);
+}
+
+//------------------------------------------------------------------------------
+static void tx_frame (struct daemon_ctl *ctl, char cmd, int gid, int did, const char *resp)
+{
+    char msg[SERIAL_RESP_SIZE +3];
+    int len;
+
+    len = SERIAL_RESP_FORM (msg, cmd, gid, did, resp);
+    msg[len++] = '\r';  msg[len++] = '\n';
+
+    tx_queue (ctl, msg, len);
+}
+
+//------------------------------------------------------------------------------
+static void tx_error (struct daemon_ctl *ctl, int gid, int did, const char *why)
+{
+    char resp[DEVICE_RESP_SIZE +1];
+
+    DEVICE_RESP_FORM_STR (resp, 'F', why);
+    tx_frame (ctl, RESP_CMD_ERROR, gid, did, resp);
+}
+
+//------------------------------------------------------------------------------
+static struct daemon_req *req_find (struct daemon_ctl *ctl, int gid, int did, int ticket)
+{
+    int i;
+
+    for (i = 0; i < DAEMON_REQ_MAX; i++) {
+        struct daemon_req *r = &ctl->req[i];
+
+        if (!r->used)
+            continue;
+        if (ticket ? (r->ticket == ticket) : ((r->gid == gid) && (r->did == did)))
+            return r;
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// oldest queued request of every idle lane -> worker pool
+//------------------------------------------------------------------------------
+static void req_dispatch (struct daemon_ctl *ctl)
+{
+    struct daemon_req *next[DEVICE_LANE_UNKNOWN +1];
+    int i;
+
+    memset (next, 0, sizeof(next));
+
+    for (i = 0; i < DAEMON_REQ_MAX; i++) {
+        struct daemon_req *r = &ctl->req[i];
+
+        if (!r->used || r->ticket || ctl->lane_busy[r->lane])
+            continue;
+        if ((next[r->lane] == NULL) || ((int)(r->seq - next[r->lane]->seq) < 0))
+            next[r->lane] = r;
+    }
+
+    for (i = 0; i <= DEVICE_LANE_UNKNOWN; i++) {
+        struct daemon_req *r = next[i];
+
+        if (r == NULL)
+            continue;
+
+        if ((r->ticket = device_check_submit (r->gid, r->did)) == 0) {
+            tx_error (ctl, r->gid, r->did, "busy");
+            memset (r, 0, sizeof(struct daemon_req));
+            continue;
+        }
+        ctl->lane_busy[i] = 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+static void req_add (struct daemon_ctl *ctl, int gid, int did)
+{
+    const struct dev_group *grp = device_group_find (gid);
+    struct daemon_req *r;
+    int i;
+
+    if ((grp == NULL) || (grp->check == NULL)) {
+        tx_error (ctl, gid, did, "unknown gid");
+        return;
+    }
+    // same item queued or running : one check, one response
+    if (req_find (ctl, gid, did, 0) != NULL)
+        return;
+
+    for (i = 0, r = NULL; i < DAEMON_REQ_MAX; i++) {
+        if (!ctl->req[i].used) {
+            r = &ctl->req[i];
+            break;
+        }
+    }
+    if (r == NULL) {
+        tx_error (ctl, gid, did, "busy");
+        return;
+    }
+
+    r->used = 1;
+    r->gid  = gid;
+    r->did  = did;
+    r->lane = device_group_lane (gid);
+    r->seq  = ctl->seq++;
+    r->ticket = 0;
+
+    req_dispatch (ctl);
+}
+
+//------------------------------------------------------------------------------
+static void rx_frame (struct daemon_ctl *ctl, parse_resp_data_t *pdata)
+{
+    char msg[CHECK_STAT_FRAME_SIZE];
+
+    DEV_LOG (eLOG_DEBUG, DEV_LOG_GID_NONE, "%s : cmd = %c, gid = %d, did = %d\n",
+             __func__, pdata->cmd, pdata->gid, pdata->did);
+
+    switch (pdata->cmd) {
+        case RESP_CMD_REQUEST:
+            req_add (ctl, pdata->gid, pdata->did);
+            break;
+        case RESP_CMD_STAT:
+            tx_queue (ctl, msg, check_stat_frame (pdata->gid, pdata->did, msg));
+            break;
+        default:
+            tx_error (ctl, pdata->gid, pdata->did, "unknown cmd");
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+// return 0 : port closed / error
+//------------------------------------------------------------------------------
+static int rx_read (struct daemon_ctl *ctl)
+{
+    parse_resp_data_t pdata;
+    char *wptr;
+    int len;
+
+    while (1) {
+        len = frame_ring_space (&ctl->rx, &wptr);
+
+        if ((len = read (ctl->port_fd, wptr, len)) < 0) {
+            if (errno == EINTR)
+                continue;
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                return 1;
+            printf ("%s : read error! (%s)\n", __func__, strerror (errno));
+            return 0;
+        }
+        if (len == 0)
+            return 0;
+
+        frame_ring_commit (&ctl->rx, len);
+        while (frame_ring_next (&ctl->rx, &pdata))
+            rx_frame (ctl, &pdata);
+    }
+}
+
+//------------------------------------------------------------------------------
+// finished checks -> response frames, free lanes -> next requests
+//------------------------------------------------------------------------------
+static void check_done (struct daemon_ctl *ctl)
+{
+    char resp[DEVICE_RESP_SIZE +1];
+    struct daemon_req *r;
+    unsigned long long cnt;
+    int ticket, status;
+
+    if (read (ctl->event_fd, &cnt, sizeof(cnt)) < 0 && (errno != EAGAIN))
+        printf ("%s : eventfd read error! (%s)\n", __func__, strerror (errno));
+
+    while ((ticket = device_check_complete (resp, &status, 0)) != 0) {
+        if ((r = req_find (ctl, 0, 0, ticket)) == NULL)
+            continue;
+
+        tx_frame (ctl, RESP_CMD_STATUS, r->gid, DEVICE_ID(r->did), resp);
+
+        ctl->lane_busy[r->lane] = 0;
+        memset (r, 0, sizeof(struct daemon_req));
+    }
+    req_dispatch (ctl);
+}
+
+//------------------------------------------------------------------------------
+static int epoll_add (struct daemon_ctl *ctl, int fd, unsigned int events)
+{
+    struct epoll_event ev;
+
+    memset (&ev, 0, sizeof(ev));
+    ev.events  = events;
+    ev.data.fd = fd;
+
+    if (epoll_ctl (ctl->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        printf ("%s : epoll_ctl error! (%s)\n", __func__, strerror (errno));
+        return 0;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+//
+// serve the port until it is closed. return 0 : setup / port error
+//
+//------------------------------------------------------------------------------
+int daemon_run (const char *port, int baud)
+{
+    struct daemon_ctl *ctl = &DaemonCTL;
+    struct epoll_event ev[4];
+    char resp[DEVICE_RESP_SIZE +1];
+    int i, cnt, run = 1;
+
+    memset (ctl, 0, sizeof(struct daemon_ctl));
+    frame_ring_init (&ctl->rx);
+
+    if (!port_open (ctl, port, baud))
+        return 0;
+
+    if ((ctl->event_fd = device_check_event_fd ()) < 0)
+        return 0;
+
+    if ((ctl->epoll_fd = epoll_create1 (EPOLL_CLOEXEC)) < 0) {
+        printf ("%s : epoll_create1 error! (%s)\n", __func__, strerror (errno));
+        return 0;
+    }
+    if (!epoll_add (ctl, ctl->port_fd, EPOLLIN) || !epoll_add (ctl, ctl->event_fd, EPOLLIN))
+        return 0;
+
+    DEVICE_RESP_FORM_STR (resp, 'P', "");
+    tx_frame (ctl, RESP_CMD_BOOT, 0, 0, resp);
+
+    while (run) {
+        if ((cnt = epoll_wait (ctl->epoll_fd, ev, sizeof(ev)/sizeof(ev[0]), -1)) < 0) {
+            if (errno == EINTR)
+                continue;
+            printf ("%s : epoll_wait error! (%s)\n", __func__, strerror (errno));
+            break;
+        }
+        for (i = 0; i < cnt; i++) {
+            if (ev[i].data.fd == ctl->event_fd) {
+                check_done (ctl);
+                continue;
+            }
+            if (ev[i].events & EPOLLOUT)
+                tx_flush (ctl);
+            if (ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                run = rx_read (ctl);
+        }
+    }
+    printf ("%s : %s closed\n", __func__, port);
+
+    close (ctl->epoll_fd);
+    close (ctl->port_fd);
+    if (ctl->slave_fd >= 0)
+        close (ctl->slave_fd);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #if defined(__LIB_DEV_CHECK_APP__)
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+/**
+ * @file lib_daemon.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (serial protocol daemon)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __LIB_DAEMON_H__
+#define __LIB_DAEMON_H__
+
+//------------------------------------------------------------------------------
+// JIG serial protocol server (one epoll thread, checks on the worker pool)
+//
+//   host -> board : @,R,GID,DID,#          check request (DID = did + action * 10)
+//                   @,T,GID,DID,#          latency statistics
+//   board -> host : @,B,00,0000,P, ... ,#  daemon start
+//                   @,S,GID,DID,{resp},#   check result, sent when it finishes
+//                   @,E,GID,DID,F,{why},#  unknown cmd / gid, request table full
+//
+// Requests are queued per lane (dev_group.lane) and one check per lane is on
+// the worker pool at a time, so a long check (storage, audio ...) only delays
+// the checks of its own lane. A request for a (gid, did) that is already
+// queued or running gets the one response of that check.
+//
+// port : tty device (e.g. /dev/ttyS0) or "pty" (local test, slave name printed)
+//------------------------------------------------------------------------------
+#define DAEMON_PORT_PTY     "pty"
+#define DAEMON_BAUD_DEF     115200
+
+// queued + running requests
+#define DAEMON_REQ_MAX      64
+// unsent response bytes (slow / stopped host)
+#define DAEMON_TX_SIZE      8192
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int daemon_run (const char *port, int baud);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __LIB_DAEMON_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
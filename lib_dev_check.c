@@ -35,38 +35,11 @@
 
 //------------------------------------------------------------------------------
 // return 1 : find success, 0 : not found
+// (file_path is STR_PATH_LENGTH bytes, see core/file_path.c)
 //------------------------------------------------------------------------------
 int find_file_path (const char *fname, char *file_path)
 {
-    FILE *fp;
-    char cmd_line[STR_PATH_LENGTH * 2];
-
-    memset (cmd_line, 0, sizeof(cmd_line));
-    sprintf(cmd_line, "%s\n", "pwd");
-
-    if (NULL != (fp = popen(cmd_line, "r"))) {
-        memset (cmd_line, 0, sizeof(cmd_line));
-        fgets  (cmd_line, STR_PATH_LENGTH, fp);
-        pclose (fp);
-
-        strncpy (file_path, cmd_line, strlen(cmd_line)-1);
-
-        memset (cmd_line, 0, sizeof(cmd_line));
-        sprintf(cmd_line, "find -name %s\n", fname);
-        if (NULL != (fp = popen(cmd_line, "r"))) {
-            memset (cmd_line, 0, sizeof(cmd_line));
-            fgets  (cmd_line, STR_PATH_LENGTH, fp);
-            pclose (fp);
-            if (strlen(cmd_line)) {
-                strncpy (&file_path[strlen(file_path)], &cmd_line[1], strlen(cmd_line)-1);
-                file_path[strlen(file_path)-1] = 0;
-                return 1;
-            }
-            return 0;
-        }
-    }
-    pclose(fp);
-    return 0;
+    return file_path_lookup (fname, file_path, STR_PATH_LENGTH);
 }
 
 //------------------------------------------------------------------------------
@@ -74,153 +47,279 @@ int find_file_path (const char *fname, char *file_path)
 int device_resp_parse (const char *resp_msg, parse_resp_data_t *pdata)
 {
     int msg_size = (int)strlen(resp_msg);
-    char *ptr, resp[SERIAL_RESP_SIZE+1];
 
-    if ((msg_size != SERIAL_RESP_SIZE) && (msg_size != DEVICE_RESP_SIZE)) {
-        printf ("%s : unknown resp size = %d, resp = %s\n", __func__, msg_size, resp_msg);
-        return 0;
+    // serial frame '@,cmd,gid,did,status,value,#' or device resp 'status,value'
+    if (resp_msg[0] == FRAME_START) {
+        if (frame_decode (resp_msg, msg_size, pdata))
+            return 1;
+    }
+    else if (msg_size) {
+        return frame_decode_resp (resp_msg, msg_size, pdata);
     }
 
-    memset (resp,   0, sizeof(resp));
-    memset (pdata,  0, sizeof(parse_resp_data_t));
+    printf ("%s : unknown resp, size = %d, resp = %s\n", __func__, msg_size, resp_msg);
+    return 0;
+}
 
-    // copy org msg
-    memcpy (resp, resp_msg, msg_size);
+//------------------------------------------------------------------------------
+int device_resp_check_ctx (struct dev_check_ctx *ctx, parse_resp_data_t *pdata)
+{
+    const struct dev_group *grp = device_group_find (pdata->gid);
 
-    if ((ptr = strtok (resp, ",")) != NULL) {
-        if (msg_size == SERIAL_RESP_SIZE) {
-            // cmd
-            if ((ptr = strtok (NULL, ",")) != NULL) pdata->cmd = *ptr;
-            // gid
-            if ((ptr = strtok (NULL, ",")) != NULL) pdata->gid = atoi(ptr);
-            // did
-            if ((ptr = strtok (NULL, ",")) != NULL) pdata->did = atoi(ptr);
+    if ((grp != NULL) && (grp->data_check != NULL))
+        return grp->data_check (ctx, pdata);
 
-            ptr = strtok (NULL, ",");
-        }
+    /* not implement */
+    pdata->status_i = 0;
 
-        // status
-        if (ptr != NULL) {
-            pdata->status_c =  *ptr;
-            pdata->status_i = (*ptr == 'P') ? 1 : 0;
-        }
-        // resp str
-        if ((ptr = strtok (NULL, ",")) != NULL) {
-            {
-                int i, pos;
-                for (i = 0, pos = 0; i < DEVICE_RESP_SIZE -2; i++)
-                {
-                    if ((*(ptr + i) != 0x20) && (*(ptr + i) != 0x00))
-                        pdata->resp_s[pos++] = *(ptr + i);
-                }
-            }
-            pdata->resp_i = atoi(ptr);
-        }
-        return 1;
-    }
-    return 0;
+    // device_data_check ok
+    return 1;
 }
 
 //------------------------------------------------------------------------------
 int device_resp_check (parse_resp_data_t *pdata)
 {
-    char resp [DEVICE_RESP_SIZE+1];
-    memset (resp, 0, sizeof(resp));
-
-    switch (pdata->gid) {
-        case eGID_SYSTEM:
-            pdata->status_i = system_data_check (pdata->did, pdata->resp_i);
-            return pdata->status_i;
-        case eGID_MISC:
-            pdata->status_i = misc_check (pdata->did, resp);
-            return pdata->status_i;
-        /* IR Thread running */
-        case eGID_IR:
-            pdata->status_i = ir_check (pdata->did, resp);
-            return pdata->status_i;
-
-         case eGID_ETHERNET:
-            switch (pdata->did) {
-                case eETHERNET_IPERF:
-                case eETHERNET_IPERF_S:
-                case eETHERNET_IPERF_C:
-                    pdata->status_i = ethernet_check (pdata->did, resp);
-                    return pdata->status_i;
-            }
-            break;
-        case eGID_LED:
-            pdata->status_i = led_data_check (pdata->did, pdata->resp_i);
-            break;
-        case eGID_HEADER:
-            pdata->status_i = header_data_check (pdata->did, pdata->resp_s);
-            break;
-        case eGID_AUDIO:
-            pdata->status_i = audio_data_check (pdata->did, pdata->resp_i);
-            break;
-
-        /* not implement */
-        case eGID_PWM: case eGID_GPIO:
-        default:
-            pdata->status_i = 0;
-            break;
+    return device_resp_check_ctx (dev_check_ctx_default (), pdata);
+}
+
+//------------------------------------------------------------------------------
+// Groups in the same lane (dev_group.lane) touch the same hardware.
+// device_check() holds the lane lock while a check runs, so checks of the same
+// lane never overlap and checks of different lanes may run from concurrent
+// threads. Unknown gid share one lane (DEVICE_LANE_UNKNOWN).
+// Lanes are process wide : contexts share the hardware.
+//------------------------------------------------------------------------------
+static pthread_mutex_t DeviceLaneMutex [DEVICE_LANE_UNKNOWN +1] = {
+    [0 ... DEVICE_LANE_UNKNOWN] = PTHREAD_MUTEX_INITIALIZER
+};
+
+//------------------------------------------------------------------------------
+// device_check without the budget (DEADLINE config)
+//------------------------------------------------------------------------------
+static int device_check_exec (struct dev_check_ctx *ctx, int gid, int did, char *dev_resp)
+{
+    const struct dev_group *grp;
+    int status  = 0, lane = device_group_lane (gid);
+    unsigned int gen = 0;
+    long long start;
+
+    memset (dev_resp, 0, DEVICE_RESP_SIZE);
+
+    // group init still running (device_setup), results go to the journal
+    device_group_ready (ctx, gid, GROUP_WAIT_FOREVER);
+    device_group_ready (ctx, eGID_CFG_JOURNAL, GROUP_WAIT_FOREVER);
+    device_group_ready (ctx, eGID_CFG_RESUME,  GROUP_WAIT_FOREVER);
+
+    // latency (check_stat) : lane wait + check, group init excluded
+    start = dev_time_usec ();
+
+    // passed before a reset of the board (RESUME config)
+    if (check_journal_resume (ctx, gid, did, dev_resp, &status)) {
+        check_stat_add (gid, did, dev_time_usec () - start);
+        DEV_LOG (eLOG_INFO, gid, "%s : [size = %d] -> %s (resumed)\n", __func__, (int)strlen(dev_resp), dev_resp);
+        return status;
     }
-    // device_data_check ok
-    return 1;
+
+    // static device facts (CACHE config)
+    if (check_cache_get (ctx, gid, did, dev_resp, &status, &gen)) {
+        check_stat_add    (gid, did, dev_time_usec () - start);
+        check_journal_add (ctx, gid, did, status, dev_resp, dev_time_usec () - start);
+        DEV_LOG (eLOG_INFO, gid, "%s : [size = %d] -> %s (cached)\n", __func__, (int)strlen(dev_resp), dev_resp);
+        return status;
+    }
+
+    pthread_mutex_lock (&DeviceLaneMutex[lane]);
+    if (((grp = device_group_find (gid)) != NULL) && (grp->check != NULL))
+        status = grp->check (ctx, did, dev_resp);
+    else
+        sprintf (dev_resp, "0,%20s", "unkonwn");
+    pthread_mutex_unlock (&DeviceLaneMutex[lane]);
+
+    check_stat_add    (gid, did, dev_time_usec () - start);
+    check_journal_add (ctx, gid, did, status, dev_resp, dev_time_usec () - start);
+    check_cache_put   (ctx, gid, did, dev_resp, status, gen);
+    DEV_LOG (eLOG_INFO, gid, "%s : [size = %d] -> %s\n", __func__, (int)strlen(dev_resp), dev_resp);
+
+    return status;
 }
 
 //------------------------------------------------------------------------------
 //
 // status value : 0 -> Wait, 1 -> Success, -1 -> Error
 //
+//------------------------------------------------------------------------------
+int device_check_ctx (struct dev_check_ctx *ctx, int gid, int did, char *dev_resp)
+{
+    int status = 0;
+
+    // budget (DEADLINE config) : 'W' when the check takes longer, result on the next call
+    if (check_deadline_run (ctx, gid, did, dev_resp, &status, device_check_exec))
+        return status;
+
+    return device_check_exec (ctx, gid, did, dev_resp);
+}
+
 //------------------------------------------------------------------------------
 int device_check (int gid, int did, char *dev_resp)
 {
-    int status  = 0;
+    return device_check_ctx (dev_check_ctx_default (), gid, did, dev_resp);
+}
 
-    memset (dev_resp, 0, DEVICE_RESP_SIZE);
+//------------------------------------------------------------------------------
+//
+// Batch check : items of the same lane run one after another (request order),
+// different lanes run in parallel on the worker pool.
+//
+//------------------------------------------------------------------------------
+struct batch_ctl {
+    device_batch_t *items;
+    int cnt;
+
+    // lanes still running
+    int remain;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+};
+
+struct batch_lane {
+    struct batch_ctl *ctl;
+    int lane;
+};
 
-    switch(gid) {
-        case eGID_SYSTEM:   status = system_check   (did, dev_resp);  break;
-        case eGID_ADC:      status = adc_check      (did, dev_resp);  break;
-        case eGID_HDMI:     status = hdmi_check     (did, dev_resp);  break;
-        case eGID_STORAGE:  status = storage_check  (did, dev_resp);  break;
-        case eGID_USB:      status = usb_check      (did, dev_resp);  break;
-        case eGID_ETHERNET: status = ethernet_check (did, dev_resp);  break;
-        case eGID_HEADER:   status = header_check   (did, dev_resp);  break;
-        case eGID_AUDIO:    status = audio_check    (did, dev_resp);  break;
-        case eGID_PWM:      status = pwm_check      (did, dev_resp);  break;
-        case eGID_LED:      status = led_check      (did, dev_resp);  break;
-        case eGID_IR:       status = ir_check       (did, dev_resp);  break;
-        case eGID_GPIO:     status = gpio_check     (did, dev_resp);  break;
-        case eGID_FW:       status = fw_check       (did, dev_resp);  break;
-        case eGID_MISC:     status = misc_check     (did, dev_resp);  break;
-        default :
-            sprintf (dev_resp, "0,%20s", "unkonwn");
-            break;
+//------------------------------------------------------------------------------
+static void batch_lane_run (void *arg)
+{
+    struct batch_lane *p_lane = (struct batch_lane *)arg;
+    struct batch_ctl  *ctl = p_lane->ctl;
+    int i;
+
+    for (i = 0; i < ctl->cnt; i++) {
+        device_batch_t *item = &ctl->items[i];
+
+        if (device_group_lane (item->gid) != p_lane->lane)
+            continue;
+
+        memset (item->resp, 0, sizeof(item->resp));
+        item->status = device_check (item->gid, item->did, item->resp);
     }
-    printf ("%s : [size = %d] -> %s\n", __func__, (int)strlen(dev_resp), dev_resp);
 
-    return status;
+    pthread_mutex_lock   (&ctl->mutex);
+    if (!--ctl->remain)
+        pthread_cond_signal (&ctl->cond);
+    pthread_mutex_unlock (&ctl->mutex);
 }
 
 //------------------------------------------------------------------------------
+//
+// return : pass count. items[].status, items[].resp = device_check() result
+//
 //------------------------------------------------------------------------------
-int device_setup (const char *cfg_fname)
+int device_check_batch (device_batch_t *items, int cnt)
+{
+    struct batch_ctl ctl;
+    struct batch_lane lanes[DEVICE_LANE_UNKNOWN +1];
+    int i, lane_cnt = 0, pass = 0, used[DEVICE_LANE_UNKNOWN +1];
+
+    memset (&ctl,  0, sizeof(ctl));
+    memset (used,  0, sizeof(used));
+
+    ctl.items = items;
+    ctl.cnt   = cnt;
+    pthread_mutex_init (&ctl.mutex, NULL);
+    pthread_cond_init  (&ctl.cond,  NULL);
+
+    for (i = 0; i < cnt; i++) {
+        int lane = device_group_lane (items[i].gid);
+
+        if (used[lane]++)
+            continue;
+
+        lanes[lane_cnt].ctl  = &ctl;
+        lanes[lane_cnt].lane = lane;
+        lane_cnt++;
+    }
+    ctl.remain = lane_cnt;
+
+    // first lane runs on the caller thread, the others on the worker pool
+    for (i = 1; i < lane_cnt; i++) {
+        if (!worker_submit (batch_lane_run, &lanes[i]))
+            batch_lane_run (&lanes[i]);
+    }
+    if (lane_cnt)
+        batch_lane_run (&lanes[0]);
+
+    pthread_mutex_lock   (&ctl.mutex);
+    while (ctl.remain)
+        pthread_cond_wait (&ctl.cond, &ctl.mutex);
+    pthread_mutex_unlock (&ctl.mutex);
+
+    pthread_mutex_destroy (&ctl.mutex);
+    pthread_cond_destroy  (&ctl.cond);
+
+    for (i = 0; i < cnt; i++)
+        if (items[i].status == 1)   pass++;
+
+    return pass;
+}
+
+//------------------------------------------------------------------------------
+//
+// Setup : config lines are queued per group and the group init runs on the
+// worker pool (core/group_init.c). device_setup returns once every init is
+// started, device_check waits for its own group only.
+//
+//------------------------------------------------------------------------------
+struct setup_ctl {
+    struct dev_check_ctx *ctx;
+    char cfg_fname[STR_PATH_LENGTH];
+    char cfg_path [STR_PATH_LENGTH];
+};
+
+//------------------------------------------------------------------------------
+// every group ready : file paths resolved by the init are known, save the cache
+//------------------------------------------------------------------------------
+static void device_setup_done (void *arg)
 {
+    struct setup_ctl *setup = (struct setup_ctl *)arg;
+
+    cfg_cache_save (setup->ctx, setup->cfg_fname, setup->cfg_path);
+}
+
+//------------------------------------------------------------------------------
+int device_setup_ctx (struct dev_check_ctx *ctx, const char *cfg_fname)
+{
+    const struct dev_group *grp;
+    struct setup_ctl *setup;
     FILE *pfd;
     char buf[STR_PATH_LENGTH] = {0,}, *ptr, check_cfg = 0;
 
-    memset (buf, 0, sizeof(buf));
-    if (!find_file_path (cfg_fname, buf)) {
+    // compiled config (same source, same groups) : no text parse, no file search
+    if (cfg_cache_load (ctx, cfg_fname)) {
+        device_group_init_start (ctx, NULL, NULL);
+        return 1;
+    }
+
+    if ((setup = ctx->setup) == NULL) {
+        if ((setup = ctx->setup = malloc (sizeof(struct setup_ctl))) == NULL) {
+            printf ("%s : setup alloc error!\n", __func__);
+            return 0;
+        }
+    }
+    memset (setup, 0, sizeof(struct setup_ctl));
+    setup->ctx = ctx;
+    strncpy (setup->cfg_fname, cfg_fname, sizeof(setup->cfg_fname) -1);
+    if (!find_file_path (cfg_fname, setup->cfg_path)) {
         printf ("%s : %s file not found!\n", __func__, cfg_fname);
         return 0;
     }
 
-    if ((pfd = fopen(buf, "r")) == NULL) {
-        printf ("%s : %s file open error!\n", __func__, buf);
+    if ((pfd = fopen(setup->cfg_path, "r")) == NULL) {
+        printf ("%s : %s file open error!\n", __func__, setup->cfg_path);
         return 0;
     }
 
+    cfg_cache_begin (ctx);
+
     while (fgets(buf, sizeof(buf), pfd) != NULL) {
 
         if (buf[0] == '#' || buf[0] == '\n')  continue;
@@ -231,24 +330,27 @@ int device_setup (const char *cfg_fname)
         }
         //        printf ("%s : buf = %s\n", __func__, buf);
 
-        if ((ptr = strstr (buf, "SYSTEM"))    != NULL)  system_grp_init (buf);
-        if ((ptr = strstr (buf, "STORAGE"))   != NULL)  storage_grp_init (buf);
-        if ((ptr = strstr (buf, "USB"))       != NULL)  usb_grp_init (buf);
-        if ((ptr = strstr (buf, "HDMI"))      != NULL)  hdmi_grp_init (buf);
-        if ((ptr = strstr (buf, "ADC"))       != NULL)  adc_grp_init (buf);
-        if ((ptr = strstr (buf, "ETHERNET"))  != NULL)  ethernet_grp_init (buf);
-        if ((ptr = strstr (buf, "HEADER"))    != NULL)  header_grp_init (buf);
-        if ((ptr = strstr (buf, "AUDIO"))     != NULL)  audio_grp_init (buf);
-        if ((ptr = strstr (buf, "LED"))       != NULL)  led_grp_init (buf);
-        if ((ptr = strstr (buf, "PWM"))       != NULL)  pwm_grp_init (buf);
-        if ((ptr = strstr (buf, "IR"))        != NULL)  ir_grp_init (buf);
-        if ((ptr = strstr (buf, "GPIO"))      != NULL)  gpio_grp_init (buf);
-        if ((ptr = strstr (buf, "FW"))        != NULL)  fw_grp_init (buf);
-        if ((ptr = strstr (buf, "MISC"))      != NULL)  misc_grp_init (buf);
+        // group name = first token
+        for (ptr = buf; (*ptr == ' ') || (*ptr == '\t'); ptr++)
+            ;
+        if ((grp = device_group_lookup (ptr, strcspn (ptr, ", \t\r\n"))) != NULL) {
+            cfg_cache_add (ctx, grp->gid, ptr);
+            device_group_init_add (ctx, grp->gid, ptr);
+        }
+        else
+            printf ("%s : unknown group, %s", __func__, buf);
     }
     fclose (pfd);
+
+    device_group_init_start (ctx, device_setup_done, setup);
     return 1;
 }
 
+//------------------------------------------------------------------------------
+int device_setup (const char *cfg_fname)
+{
+    return device_setup_ctx (dev_check_ctx_default (), cfg_fname);
+}
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
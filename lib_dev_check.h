@@ -34,6 +34,26 @@
 #include "./lib_efuse/lib_efuse.h"
 #include "./lib_efuse/lib_efuse.h"
 #include "./lib_mac/lib_mac.h"
+#include "./core/dev_util.h"
+#include "./core/file_path.h"
+#include "./core/dev_root.h"
+#include "./core/sysfs_attr.h"
+#include "./core/sysfs_notify.h"
+#include "./core/subproc.h"
+#include "./core/worker.h"
+#include "./core/res_lock.h"
+#include "./core/event_loop.h"
+#include "./core/check_async.h"
+#include "./core/frame.h"
+#include "./core/group.h"
+#include "./core/cfg_cache.h"
+#include "./core/group_init.h"
+#include "./core/check_cache.h"
+#include "./core/check_deadline.h"
+#include "./core/check_stat.h"
+#include "./core/check_journal.h"
+#include "./core/dev_log.h"
+#include "./core/check_ctx.h"
 
 //------------------------------------------------------------------------------
 #define STR_PATH_LENGTH     128
@@ -76,14 +96,17 @@
 #define RESP_CMD_REQUEST    'R'
 #define RESP_CMD_BOOT       'B'
 #define RESP_CMD_ERROR      'E'
+// check latency statistics (core/check_stat.c)
+#define RESP_CMD_STAT       'T'
 
 #define DEVICE_GID_SIZE     2
 #define DEVICE_DID_SIZE     4
 #define DEVICE_RESP_SIZE    22  // [status(1), value(20)]
 
-#define SERIAL_RESP_FORM(buf, cmd, gid, did, resp)  sprintf (buf, "@,%c,%02d,%04d,%22s,#", cmd, gid, did, resp)
-#define DEVICE_RESP_FORM_INT(buf, status, value)    sprintf (buf, "%c,%20d", status, value)
-#define DEVICE_RESP_FORM_STR(buf, status, value)    sprintf (buf, "%c,%20s", status, value)
+// same output as sprintf "@,%c,%02d,%04d,%22s,#", "%c,%20d", "%c,%20s" (core/frame.c)
+#define SERIAL_RESP_FORM(buf, cmd, gid, did, resp)  frame_encode     (buf, cmd, gid, did, resp)
+#define DEVICE_RESP_FORM_INT(buf, status, value)    frame_encode_int (buf, status, value)
+#define DEVICE_RESP_FORM_STR(buf, status, value)    frame_encode_str (buf, status, value)
 
 //------------------------------------------------------------------------------
 // Group ID
@@ -106,6 +129,17 @@ enum {
     eGID_END,
 };
 
+//------------------------------------------------------------------------------
+// Config only Group ID (DEVICE_GROUP_CFG ~, core/)
+//------------------------------------------------------------------------------
+enum {
+    eGID_CFG_CACHE = DEVICE_GROUP_CFG,
+    eGID_CFG_LOG,
+    eGID_CFG_DEADLINE,
+    eGID_CFG_JOURNAL,
+    eGID_CFG_RESUME,
+};
+
 //------------------------------------------------------------------------------
 typedef struct parse_resp_data__t {
     char    cmd;
@@ -117,6 +151,16 @@ typedef struct parse_resp_data__t {
     int     resp_i;
 }   parse_resp_data_t;
 
+//------------------------------------------------------------------------------
+// device_check_batch item (gid, did : request / status, resp : response)
+//------------------------------------------------------------------------------
+typedef struct device_batch__t {
+    int     gid;
+    int     did;
+    int     status;
+    char    resp[DEVICE_RESP_SIZE +1];
+}   device_batch_t;
+
 //------------------------------------------------------------------------------
 extern int find_file_path       (const char *fname, char *file_path);
 //------------------------------------------------------------------------------
@@ -124,7 +168,14 @@ extern int  device_resp_parse   (const char *resp, parse_resp_data_t *pdata);
 extern int  device_resp_check   (parse_resp_data_t *pdata);
 //------------------------------------------------------------------------------
 extern int  device_check        (int gid, int did, char *resp);
+extern int  device_check_batch  (device_batch_t *items, int cnt);
 extern int  device_setup        (const char *cfg_fname);
+//------------------------------------------------------------------------------
+// same as above on a dev_check_ctx (core/check_ctx.h)
+//------------------------------------------------------------------------------
+extern int  device_resp_check_ctx   (struct dev_check_ctx *ctx, parse_resp_data_t *pdata);
+extern int  device_check_ctx        (struct dev_check_ctx *ctx, int gid, int did, char *resp);
+extern int  device_setup_ctx        (struct dev_check_ctx *ctx, const char *cfg_fname);
 
 //------------------------------------------------------------------------------
 #endif  // __LIB_DEV_TEST_H__
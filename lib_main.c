@@ -32,6 +32,8 @@
 
 //------------------------------------------------------------------------------
 #include "lib_dev_check.h"
+#include "lib_plan.h"
+#include "lib_daemon.h"
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -198,17 +200,27 @@ static void toupperstr (char *p)
 static void print_usage (const char *prog)
 {
     puts("");
-    printf("Usage: %s [-g:group] [-d:dev id] [-a:action]\n", prog);
+    printf("Usage: %s [-f:dev cfg] [-s] [-p:plan file] [-o:report file] [-n:iterations] [-d:tty|pty] [-b:baud] [-r:device root]\n", prog);
     puts("\n"
          "Protocol)\n"
          "https://docs.google.com/spreadsheets/d/1igBObU7CnP6FRaRt-x46l5R77-8uAKEskkhthnFwtpY/edit?gid=719914769#gid=719914769\n"
          "\n"
          "  -f --dev_cfg      Device config file\n"
+         "  -s --stat         show check latency stats after every test\n"
+         "  -p --plan         run a test plan file (no menu) and exit\n"
+         "  -o --report       plan report file (*.json = JSON, else CSV, default stdout)\n"
+         "  -n --iteration    plan iterations (default 1)\n"
+         "  -d --daemon       serve the JIG protocol on a tty (\"pty\" = local test pty)\n"
+         "  -b --baud         daemon tty baud rate (default 115200)\n"
+         "  -r --root         fake /sys, /dev, /proc tree (tools/dev_fixture.sh)\n"
          "  -h --help         show help\n"
          "\n"
          "  e.g) Default cfg = dev_check.cfg\n"
          "       lib_dev_test \n"
          "       lib_dev_test -f {dev cfg file}\n"
+         "       lib_dev_test -p {plan file} -n 100 -o report.json\n"
+         "       lib_dev_test -d /dev/ttyS0 -b 115200\n"
+         "       lib_dev_test -r /tmp/fixture -f /tmp/fixture/dev_check.cfg -p {plan file}\n"
     );
     exit(1);
 }
@@ -220,6 +232,13 @@ static int  OPT_GROUP_ID  = 0;
 static int  OPT_DEVICE_ID = 0;
 static int  OPT_ACTION    = 0;
 static char *OPT_CFG_FNAME = CONFIG_FILE_NAME;
+static int  OPT_STAT      = 0;
+static char *OPT_PLAN_FNAME   = NULL;
+static char *OPT_REPORT_FNAME = "-";
+static int  OPT_ITERATION = 1;
+static char *OPT_DAEMON_PORT  = NULL;
+static int  OPT_BAUD      = DAEMON_BAUD_DEF;
+static char *OPT_DEV_ROOT = NULL;
 
 //------------------------------------------------------------------------------
 static void parse_opts (int argc, char *argv[])
@@ -227,12 +246,19 @@ static void parse_opts (int argc, char *argv[])
     while (1) {
         static const struct option lopts[] = {
             { "cfg file" ,  1, 0, 'f' },
+            { "stat    " ,  0, 0, 's' },
+            { "plan    " ,  1, 0, 'p' },
+            { "report  " ,  1, 0, 'o' },
+            { "iteration", 1, 0, 'n' },
+            { "daemon  " ,  1, 0, 'd' },
+            { "baud    " ,  1, 0, 'b' },
+            { "root    " ,  1, 0, 'r' },
             { "help    " ,  0, 0, 'h' },
             { NULL, 0, 0, 0 },
         };
         int c;
 
-        c = getopt_long(argc, argv, "hf:", lopts, NULL);
+        c = getopt_long(argc, argv, "hsf:p:o:n:d:b:r:", lopts, NULL);
 
         if (c == -1)
             break;
@@ -241,6 +267,27 @@ static void parse_opts (int argc, char *argv[])
         case 'f':
             OPT_CFG_FNAME = optarg;
             break;
+        case 's':
+            OPT_STAT = 1;
+            break;
+        case 'p':
+            OPT_PLAN_FNAME = optarg;
+            break;
+        case 'o':
+            OPT_REPORT_FNAME = optarg;
+            break;
+        case 'n':
+            OPT_ITERATION = atoi(optarg);
+            break;
+        case 'd':
+            OPT_DAEMON_PORT = optarg;
+            break;
+        case 'b':
+            OPT_BAUD = atoi(optarg);
+            break;
+        case 'r':
+            OPT_DEV_ROOT = optarg;
+            break;
         case 'h':
         default:
             print_usage(argv[0]);
@@ -272,6 +319,19 @@ void make_msg (int grp_id, int dev_id, char *dev_resp)
     printf ("\nResponse : size = %ld, msg = %s\n", strlen(msg), msg);
 }
 
+//------------------------------------------------------------------------------
+// 'T' command response of the test item + all (gid, did) latency stats
+//------------------------------------------------------------------------------
+void make_stat_msg (int grp_id, int dev_id)
+{
+    char msg[CHECK_STAT_FRAME_SIZE];
+
+    check_stat_frame (grp_id, dev_id, msg);
+
+    printf ("\nStatistics : \n%s", msg);
+    check_stat_dump ();
+}
+
 //------------------------------------------------------------------------------
 int get_int (void)
 {
@@ -325,8 +385,24 @@ int main (int argc, char *argv[])
 
     parse_opts(argc, argv);
 
-    // device thread wait
-    device_setup (OPT_CFG_FNAME);   sleep (2);
+    // off-target run : every /sys, /dev, /proc access goes below the root
+    if ((OPT_DEV_ROOT != NULL) && !dev_root_set (OPT_DEV_ROOT))
+        return 1;
+
+    // batch report on stdout : console output to stderr (before the group init)
+    if ((OPT_PLAN_FNAME != NULL) && !plan_console (OPT_REPORT_FNAME))
+        return 1;
+
+    // group init runs in the background, device_check waits for its group
+    device_setup (OPT_CFG_FNAME);
+
+    // batch mode : no menu, exit status = plan result
+    if (OPT_PLAN_FNAME != NULL)
+        return plan_run (OPT_PLAN_FNAME, OPT_REPORT_FNAME, OPT_ITERATION) ? 0 : 1;
+
+    // serial protocol server : no menu, returns when the port is closed
+    if (OPT_DAEMON_PORT != NULL)
+        return daemon_run (OPT_DAEMON_PORT, OPT_BAUD) ? 0 : 1;
 
     while (1)
     {
@@ -344,9 +420,15 @@ int main (int argc, char *argv[])
         printf ("\n===> TEST ITEM RESULT (ret = %s) <===\n",
             device_check (OPT_GROUP_ID, did, dev_resp) == 1 ? "PASS" : "FAIL");
 
+        // check log lines before the result msg
+        dev_log_flush ();
+
         // Serial msg
         make_msg (OPT_GROUP_ID, did, dev_resp); printf ("\n");
 
+        if (OPT_STAT)
+            make_stat_msg (OPT_GROUP_ID, did);
+
         // pause
         sleep (1);
         printf ("\nPress [Enter] key to continue....");   get_int ();
@@ -0,0 +1,834 @@
+//------------------------------------------------------------------------------
+/**
+ * @file lib_plan.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (test plan runner)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+#include "lib_dev_check.h"
+#include "lib_plan.h"
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#if defined(__LIB_DEV_CHECK_APP__)
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+struct plan_step {
+    // did = device id + action * 10, dev = device id (RESOURCE)
+    int gid, did, dev, repeat;
+    // result count over all iterations
+    int pass, fail;
+};
+
+struct plan_result {
+    int iter, step, rep;
+    int gid, did, status;
+    char resp[DEVICE_RESP_SIZE +1];
+    // usec from the plan start, check wall time
+    long long start, wall;
+};
+
+// RESOURCE, gid, did, name, (dev -1 : every device of the group)
+struct plan_rule {
+    int gid, dev;
+    unsigned int res;
+};
+
+// estimate of a check (runs 0 : DURATION line or default)
+struct plan_time {
+    int gid, did;
+    long long usec;
+    int runs;
+};
+
+// one (step, repeat) of the schedule
+struct plan_item {
+    int step, rep, lane, stage;
+    unsigned int res;
+    long long est;
+};
+
+struct plan_stage {
+    int cnt;
+    unsigned int res;
+    // longest estimate in the stage (usec)
+    long long span;
+};
+
+struct plan_ctl {
+    struct plan_step step[PLAN_STEP_MAX];
+    // concurrency used (clamped), requested (CONCURRENCY line)
+    int step_cnt, concurrency, concurrency_req;
+
+    struct plan_result *result;
+    int result_cnt;
+
+    // iteration cycle time (usec)
+    long long *cycle;
+
+    long long t0;
+    int inflight;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    // SCHEDULE
+    int schedule;
+    char res_name[PLAN_RESOURCE_MAX][STR_NAME_LENGTH];
+    int res_cnt;
+    struct plan_rule rule[PLAN_RULE_MAX];
+    int rule_cnt;
+    struct plan_time time[PLAN_STEP_MAX];
+    int time_cnt;
+
+    struct plan_item  *item;
+    int item_cnt;
+    struct plan_stage *stage;
+    int stage_cnt;
+};
+
+//------------------------------------------------------------------------------
+//
+// Configuration
+//
+//------------------------------------------------------------------------------
+// shared by groups of different lanes (jig side measurement)
+static const struct {
+    int gid;
+    const char *name;
+} PlanResDefault[] = {
+    { eGID_AUDIO,   "jig_adc" },
+    { eGID_LED,     "jig_adc" },
+    { eGID_GPIO,    "jig_adc" },
+};
+
+// report on stdout : the real stdout (plan_console), -1 = not moved
+static int PlanReportFd = -1;
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// resource name -> bit (added if new). return : 0 = table full
+//------------------------------------------------------------------------------
+static unsigned int plan_res (struct plan_ctl *ctl, const char *name)
+{
+    int i;
+
+    for (i = 0; i < ctl->res_cnt; i++) {
+        if (!strcmp (ctl->res_name[i], name))
+            return 1u << i;
+    }
+    if (ctl->res_cnt >= PLAN_RESOURCE_MAX) {
+        printf ("%s : error! too many resources (max %d)\n", __func__, PLAN_RESOURCE_MAX);
+        return 0;
+    }
+    strncpy (ctl->res_name[ctl->res_cnt], name, STR_NAME_LENGTH -1);
+    return 1u << ctl->res_cnt++;
+}
+
+//------------------------------------------------------------------------------
+static void plan_rule_add (struct plan_ctl *ctl, int gid, int dev, const char *name)
+{
+    unsigned int res;
+
+    if (ctl->rule_cnt >= PLAN_RULE_MAX) {
+        printf ("%s : error! too many resource lines (max %d)\n", __func__, PLAN_RULE_MAX);
+        return;
+    }
+    if ((res = plan_res (ctl, name)) == 0)
+        return;
+
+    ctl->rule[ctl->rule_cnt].gid = gid;
+    ctl->rule[ctl->rule_cnt].dev = dev;
+    ctl->rule[ctl->rule_cnt].res = res;
+    ctl->rule_cnt++;
+}
+
+//------------------------------------------------------------------------------
+static struct plan_time *plan_time_find (struct plan_ctl *ctl, int gid, int did, int add)
+{
+    struct plan_time *t;
+    int i;
+
+    for (i = 0; i < ctl->time_cnt; i++) {
+        if ((ctl->time[i].gid == gid) && (ctl->time[i].did == did))
+            return &ctl->time[i];
+    }
+    if (!add || (ctl->time_cnt >= PLAN_STEP_MAX))
+        return NULL;
+
+    t = &ctl->time[ctl->time_cnt++];
+    t->gid  = gid;
+    t->did  = did;
+    t->usec = PLAN_TIME_DEFAULT;
+    t->runs = 0;
+    return t;
+}
+
+//------------------------------------------------------------------------------
+// numbers of a plan line (up to max). return : count
+//------------------------------------------------------------------------------
+static int plan_values (char *line, int *v, int max, char **save)
+{
+    char *tok;
+    int cnt;
+
+    // the token after the last number is not taken (RESOURCE name)
+    for (cnt = 0; cnt < max; cnt++, line = NULL) {
+        if ((tok = strtok_r (line, ",", save)) == NULL)
+            break;
+        if (((*tok < '0') || (*tok > '9')) && (*tok != '-') && (*tok != ' '))
+            break;
+        v[cnt] = atoi (tok);
+    }
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+static int plan_load (struct plan_ctl *ctl, const char *plan_fname)
+{
+    FILE *pfd;
+    char buf[STR_PATH_LENGTH], name[STR_NAME_LENGTH], *tok, *save;
+    struct plan_time *t;
+    int v[4], cnt;
+
+    if ((pfd = fopen (plan_fname, "r")) == NULL) {
+        printf ("%s : %s file open error!\n", __func__, plan_fname);
+        return 0;
+    }
+
+    while (fgets (buf, sizeof(buf), pfd) != NULL) {
+        if ((buf[0] == '#') || (buf[0] == '\n') || (buf[0] == '\r'))
+            continue;
+
+        if (!strncmp (buf, "CONCURRENCY", strlen("CONCURRENCY"))) {
+            strtok_r (buf, ",", &save);
+            if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                ctl->concurrency = atoi (tok);
+            continue;
+        }
+        if (!strncmp (buf, "SCHEDULE", strlen("SCHEDULE"))) {
+            strtok_r (buf, ",", &save);
+            if ((tok = strtok_r (NULL, ",", &save)) != NULL)
+                ctl->schedule = atoi (tok);
+            continue;
+        }
+        // RESOURCE, gid, did, name,
+        if (!strncmp (buf, "RESOURCE", strlen("RESOURCE"))) {
+            strtok_r (buf, ",", &save);
+            if ((plan_values (NULL, v, 2, &save) < 2) ||
+                (sscanf (save, " %15[^, \t\r\n]", name) != 1)) {
+                printf ("%s : skip line, RESOURCE (gid, did, name)\n", __func__);
+                continue;
+            }
+            plan_rule_add (ctl, v[0], v[1], name);
+            continue;
+        }
+        // DURATION, gid, did, action, ms,
+        if (!strncmp (buf, "DURATION", strlen("DURATION"))) {
+            strtok_r (buf, ",", &save);
+            if ((plan_values (NULL, v, 4, &save) < 4) ||
+                ((t = plan_time_find (ctl, v[0], v[1] + v[2] * 10, 1)) == NULL)) {
+                printf ("%s : skip line, DURATION (gid, did, action, ms)\n", __func__);
+                continue;
+            }
+            t->usec = (long long)v[3] * 1000;
+            continue;
+        }
+
+        // gid, did, action, repeat
+        memset (v, 0, sizeof(v));
+        if ((cnt = plan_values (buf, v, 4, &save)) < 3) {
+            printf ("%s : skip line, %s", __func__, buf);
+            continue;
+        }
+        if (ctl->step_cnt >= PLAN_STEP_MAX) {
+            printf ("%s : error! too many steps (max %d)\n", __func__, PLAN_STEP_MAX);
+            break;
+        }
+        ctl->step[ctl->step_cnt].gid    = v[0];
+        ctl->step[ctl->step_cnt].did    = v[1] + v[2] * 10;
+        ctl->step[ctl->step_cnt].dev    = v[1];
+        ctl->step[ctl->step_cnt].repeat = (cnt > 3 && v[3] > 0) ? v[3] : 1;
+        ctl->step_cnt++;
+    }
+    fclose (pfd);
+
+    if (ctl->concurrency < 1)                       ctl->concurrency = 1;
+    ctl->concurrency_req = ctl->concurrency;
+    // checks in flight run on the worker pool (online cpu count)
+    if (ctl->concurrency > worker_threads ()) {
+        printf ("%s : concurrency %d -> %d (worker pool)\n", __func__,
+                ctl->concurrency, worker_threads ());
+        ctl->concurrency = worker_threads ();
+    }
+
+    return ctl->step_cnt;
+}
+
+//------------------------------------------------------------------------------
+static void plan_check (struct plan_ctl *ctl, struct plan_result *r)
+{
+    long long start = dev_time_usec ();
+    struct timespec ts;
+    int backoff = 1;
+
+    // 'W' : budget (DEADLINE config) ran out, ask again until the result is
+    // there. The thread sleeps in between (a pool thread, other jobs run).
+    while (1) {
+        r->status = device_check (r->gid, r->did, r->resp);
+        if (r->status || (r->resp[0] != 'W'))
+            break;
+
+        ts.tv_sec  = backoff / 1000;
+        ts.tv_nsec = (backoff % 1000) * 1000000L;
+        nanosleep (&ts, NULL);
+        if ((backoff *= 2) > PLAN_RETRY_MS)
+            backoff = PLAN_RETRY_MS;
+    }
+    r->start  = start - ctl->t0;
+    r->wall   = dev_time_usec () - start;
+}
+
+//------------------------------------------------------------------------------
+struct plan_job {
+    struct plan_ctl *ctl;
+    struct plan_result *r;
+};
+
+static void plan_job (void *arg)
+{
+    struct plan_job *job = (struct plan_job *)arg;
+    struct plan_ctl *ctl = job->ctl;
+
+    plan_check (ctl, job->r);
+    free (job);
+
+    pthread_mutex_lock   (&ctl->mutex);
+    ctl->inflight--;
+    pthread_cond_broadcast (&ctl->cond);
+    pthread_mutex_unlock (&ctl->mutex);
+}
+
+//------------------------------------------------------------------------------
+// one result, up to ctl->concurrency in flight
+//------------------------------------------------------------------------------
+static void plan_submit (struct plan_ctl *ctl, struct plan_result *r)
+{
+    struct plan_job *job;
+
+    if ((ctl->concurrency == 1) || ((job = malloc (sizeof(struct plan_job))) == NULL)) {
+        plan_check (ctl, r);
+        return;
+    }
+    job->ctl = ctl;
+    job->r   = r;
+
+    pthread_mutex_lock (&ctl->mutex);
+    while (ctl->inflight >= ctl->concurrency)
+        pthread_cond_wait (&ctl->cond, &ctl->mutex);
+    ctl->inflight++;
+    pthread_mutex_unlock (&ctl->mutex);
+
+    if (!worker_submit (plan_job, job)) {
+        pthread_mutex_lock   (&ctl->mutex);
+        ctl->inflight--;
+        pthread_mutex_unlock (&ctl->mutex);
+        free (job);
+        plan_check (ctl, r);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void plan_drain (struct plan_ctl *ctl)
+{
+    pthread_mutex_lock (&ctl->mutex);
+    while (ctl->inflight)
+        pthread_cond_wait (&ctl->cond, &ctl->mutex);
+    pthread_mutex_unlock (&ctl->mutex);
+}
+
+//------------------------------------------------------------------------------
+// '{plan_fname}.time' : gid, did, usec, runs, (one line per check)
+//------------------------------------------------------------------------------
+static void plan_time_load (struct plan_ctl *ctl, const char *plan_fname)
+{
+    FILE *pfd;
+    char buf[STR_PATH_LENGTH], *save;
+    struct plan_time *t;
+    int v[4];
+
+    snprintf (buf, sizeof(buf), "%s%s", plan_fname, PLAN_TIME_SUFFIX);
+    // first run : DURATION / default
+    if ((pfd = fopen (buf, "r")) == NULL)
+        return;
+
+    while (fgets (buf, sizeof(buf), pfd) != NULL) {
+        if ((buf[0] == '#') || (plan_values (buf, v, 4, &save) < 4) || (v[3] < 1))
+            continue;
+        if ((t = plan_time_find (ctl, v[0], v[1], 1)) != NULL) {
+            t->usec = v[2];
+            t->runs = v[3];
+        }
+    }
+    fclose (pfd);
+}
+
+//------------------------------------------------------------------------------
+// moving average of the measured wall time, write + rename
+//------------------------------------------------------------------------------
+static void plan_time_save (struct plan_ctl *ctl, const char *plan_fname)
+{
+    FILE *pfd;
+    char name[STR_PATH_LENGTH], tmp[STR_PATH_LENGTH + 8];
+    struct plan_time *t;
+    long long sum;
+    int i, r, cnt;
+
+    for (i = 0; i < ctl->time_cnt; i++) {
+        t = &ctl->time[i];
+        for (r = 0, sum = 0, cnt = 0; r < ctl->result_cnt; r++) {
+            if ((ctl->result[r].gid == t->gid) && (ctl->result[r].did == t->did)) {
+                sum += ctl->result[r].wall;
+                cnt++;
+            }
+        }
+        if (!cnt)
+            continue;
+        // DURATION / default is replaced by the first measure
+        t->usec = t->runs ? t->usec + (sum / cnt - t->usec) / PLAN_TIME_WEIGHT : sum / cnt;
+        t->runs++;
+    }
+
+    snprintf (name, sizeof(name), "%s%s", plan_fname, PLAN_TIME_SUFFIX);
+    snprintf (tmp,  sizeof(tmp),  "%s.tmp", name);
+    if ((pfd = fopen (tmp, "w")) == NULL) {
+        printf ("%s : %s file open error!\n", __func__, tmp);
+        return;
+    }
+    fprintf (pfd, "# gid, did, usec, runs,\n");
+    for (i = 0; i < ctl->time_cnt; i++) {
+        if (ctl->time[i].runs)
+            fprintf (pfd, "%d,%d,%lld,%d,\n",
+                     ctl->time[i].gid, ctl->time[i].did, ctl->time[i].usec, ctl->time[i].runs);
+    }
+    if (fclose (pfd) || rename (tmp, name)) {
+        printf ("%s : %s write error!\n", __func__, name);
+        unlink (tmp);
+    }
+}
+
+//------------------------------------------------------------------------------
+static unsigned int plan_item_res (struct plan_ctl *ctl, struct plan_step *s)
+{
+    unsigned int res = 0;
+    int i;
+
+    for (i = 0; i < (int)(sizeof(PlanResDefault) / sizeof(PlanResDefault[0])); i++) {
+        if (PlanResDefault[i].gid == s->gid)
+            res |= plan_res (ctl, PlanResDefault[i].name);
+    }
+    for (i = 0; i < ctl->rule_cnt; i++) {
+        if ((ctl->rule[i].gid == s->gid) && ((ctl->rule[i].dev < 0) || (ctl->rule[i].dev == s->dev)))
+            res |= ctl->rule[i].res;
+    }
+    return res;
+}
+
+//------------------------------------------------------------------------------
+// stage of one item : from min_stage, the stage that gets the least longer
+// (no shared resource, room for one more check), else a new stage.
+//------------------------------------------------------------------------------
+static void plan_place (struct plan_ctl *ctl, struct plan_item *item, int min_stage)
+{
+    struct plan_stage *st;
+    long long grow, best_grow = item->est;
+    int i, best = ctl->stage_cnt;
+
+    for (i = min_stage; i < ctl->stage_cnt; i++) {
+        st = &ctl->stage[i];
+        if ((st->cnt >= ctl->concurrency) || (st->res & item->res))
+            continue;
+        grow = (item->est > st->span) ? item->est - st->span : 0;
+        if (grow < best_grow || ((grow == best_grow) && (best == ctl->stage_cnt))) {
+            best_grow = grow;
+            best = i;
+        }
+    }
+    st = &ctl->stage[best];
+    if (best == ctl->stage_cnt)
+        ctl->stage_cnt++;
+
+    st->cnt++;
+    st->res |= item->res;
+    if (st->span < item->est)
+        st->span = item->est;
+    item->stage = best;
+}
+
+//------------------------------------------------------------------------------
+// plan steps -> stages. The lane is a resource of its own : the items of a lane
+// are placed in plan order, every one in a later stage than the one before, so
+// no stage holds two items of a lane. Lanes with the longest total go first.
+//------------------------------------------------------------------------------
+static int plan_schedule (struct plan_ctl *ctl)
+{
+    long long total[DEVICE_LANE_UNKNOWN +1];
+    // done : no item (left) in the lane
+    int i, s, r, lane, last, done[DEVICE_LANE_UNKNOWN +1];
+
+    for (s = 0; s < ctl->step_cnt; s++)
+        ctl->item_cnt += ctl->step[s].repeat;
+
+    ctl->item  = calloc (ctl->item_cnt, sizeof(struct plan_item));
+    // worst case : one item per stage
+    ctl->stage = calloc (ctl->item_cnt, sizeof(struct plan_stage));
+    if ((ctl->item == NULL) || (ctl->stage == NULL))
+        return 0;
+
+    memset (total, 0, sizeof(total));
+    for (i = 0; i <= DEVICE_LANE_UNKNOWN; i++)
+        done[i] = 1;
+    for (s = 0, i = 0; s < ctl->step_cnt; s++) {
+        struct plan_step *step = &ctl->step[s];
+        struct plan_time *t = plan_time_find (ctl, step->gid, step->did, 1);
+        unsigned int res = plan_item_res (ctl, step);
+
+        for (r = 0; r < step->repeat; r++, i++) {
+            ctl->item[i].step = s;
+            ctl->item[i].rep  = r;
+            ctl->item[i].lane = device_group_lane (step->gid);
+            ctl->item[i].res  = res;
+            ctl->item[i].est  = (t != NULL) ? t->usec : PLAN_TIME_DEFAULT;
+            total[ctl->item[i].lane] += ctl->item[i].est;
+            done [ctl->item[i].lane]  = 0;
+        }
+    }
+
+    while (1) {
+        for (i = 0, lane = -1; i <= DEVICE_LANE_UNKNOWN; i++) {
+            if (!done[i] && ((lane < 0) || (total[i] > total[lane])))
+                lane = i;
+        }
+        if (lane < 0)
+            break;
+        done[lane] = 1;
+
+        for (i = 0, last = -1; i < ctl->item_cnt; i++) {
+            if (ctl->item[i].lane != lane)
+                continue;
+            plan_place (ctl, &ctl->item[i], last + 1);
+            last = ctl->item[i].stage;
+        }
+    }
+    return ctl->stage_cnt;
+}
+
+//------------------------------------------------------------------------------
+static void plan_stage_print (struct plan_ctl *ctl)
+{
+    long long span = 0, serial = 0;
+    int i, s;
+
+    for (s = 0; s < ctl->stage_cnt; s++)
+        span += ctl->stage[s].span;
+    for (i = 0; i < ctl->item_cnt; i++)
+        serial += ctl->item[i].est;
+
+    printf ("\n[ PLAN SCHEDULE ] stages = %d, estimate (ms) = %.3f (in order = %.3f)\n",
+            ctl->stage_cnt, span / 1000.0, serial / 1000.0);
+
+    for (s = 0; s < ctl->stage_cnt; s++) {
+        printf ("stage %3d : %9.3f ms :", s, ctl->stage[s].span / 1000.0);
+        for (i = 0; i < ctl->item_cnt; i++) {
+            struct plan_step *step = &ctl->step[ctl->item[i].step];
+
+            if (ctl->item[i].stage == s)
+                printf (" %d,%d", step->gid, step->did);
+        }
+        printf ("\n");
+    }
+}
+
+//------------------------------------------------------------------------------
+// resp without the padding space
+//------------------------------------------------------------------------------
+static void resp_trim (const char *resp, char *out)
+{
+    int i, pos = 0;
+
+    for (i = 0; resp[i] && (i < DEVICE_RESP_SIZE); i++) {
+        if (resp[i] != ' ')
+            out[pos++] = resp[i];
+    }
+    out[pos] = 0;
+}
+
+//------------------------------------------------------------------------------
+// json string value (quotes, backslash, control chars escaped)
+//------------------------------------------------------------------------------
+static void json_str (FILE *fp, const char *str)
+{
+    fputc ('"', fp);
+    for (; *str; str++) {
+        if ((*str == '"') || (*str == '\\'))
+            fprintf (fp, "\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            fprintf (fp, "\\u%04x", (unsigned char)*str);
+        else
+            fputc (*str, fp);
+    }
+    fputc ('"', fp);
+}
+
+//------------------------------------------------------------------------------
+static void report_csv (struct plan_ctl *ctl, FILE *fp)
+{
+    char resp[DEVICE_RESP_SIZE +1], *p;
+    int i;
+
+    fprintf (fp, "iter,step,rep,gid,did,status,resp,start_ms,wall_ms\n");
+    for (i = 0; i < ctl->result_cnt; i++) {
+        struct plan_result *r = &ctl->result[i];
+
+        resp_trim (r->resp, resp);
+        fprintf (fp, "%d,%d,%d,%d,%d,%d,\"",
+                 r->iter, r->step, r->rep, r->gid, r->did, r->status);
+        // csv quoted field : quote doubled
+        for (p = resp; *p; p++) {
+            if (*p == '"')
+                fputc ('"', fp);
+            fputc (*p, fp);
+        }
+        fprintf (fp, "\",%.3f,%.3f\n", r->start / 1000.0, r->wall / 1000.0);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void report_json (struct plan_ctl *ctl, FILE *fp, const char *plan_fname, int iterations)
+{
+    char resp[DEVICE_RESP_SIZE +1];
+    int i;
+
+    fprintf (fp, "{\n  \"plan\": ");
+    json_str (fp, plan_fname);
+    fprintf (fp, ",\n  \"iterations\": %d,\n  \"concurrency\": %d,\n  \"concurrency_requested\": %d,\n",
+             iterations, ctl->concurrency, ctl->concurrency_req);
+
+    fprintf (fp, "  \"cycle_ms\": [");
+    for (i = 0; i < iterations; i++)
+        fprintf (fp, "%s%.3f", i ? ", " : "", ctl->cycle[i] / 1000.0);
+    fprintf (fp, "],\n");
+
+    fprintf (fp, "  \"results\": [\n");
+    for (i = 0; i < ctl->result_cnt; i++) {
+        struct plan_result *r = &ctl->result[i];
+
+        resp_trim (r->resp, resp);
+        fprintf (fp, "    { \"iter\": %d, \"step\": %d, \"rep\": %d, \"gid\": %d, \"did\": %d, "
+                     "\"status\": %d, \"resp\": ",
+                 r->iter, r->step, r->rep, r->gid, r->did, r->status);
+        json_str (fp, resp);
+        fprintf (fp, ", \"start_ms\": %.3f, \"wall_ms\": %.3f }%s\n",
+                 r->start / 1000.0, r->wall / 1000.0,
+                 (i < ctl->result_cnt -1) ? "," : "");
+    }
+    fprintf (fp, "  ]\n}\n");
+}
+
+//------------------------------------------------------------------------------
+// cycle time, pass / fail per step, flaky steps (pass and fail in the run)
+//------------------------------------------------------------------------------
+static void plan_summary (struct plan_ctl *ctl, int iterations)
+{
+    long long min = 0, max = 0, sum = 0;
+    int i;
+
+    for (i = 0; i < ctl->result_cnt; i++) {
+        struct plan_step *s = &ctl->step[ctl->result[i].step];
+
+        if (ctl->result[i].status == 1)     s->pass++;
+        else                                s->fail++;
+    }
+    for (i = 0; i < iterations; i++) {
+        if (!i || (ctl->cycle[i] < min))    min = ctl->cycle[i];
+        if (!i || (ctl->cycle[i] > max))    max = ctl->cycle[i];
+        sum += ctl->cycle[i];
+    }
+
+    printf ("\n[ PLAN SUMMARY ] iterations = %d, concurrency = %d (requested %d)%s\n",
+            iterations, ctl->concurrency, ctl->concurrency_req, ctl->schedule ? ", schedule" : "");
+    printf ("cycle (ms) : min = %.3f, avg = %.3f, max = %.3f\n",
+            min / 1000.0, iterations ? sum / 1000.0 / iterations : 0.0, max / 1000.0);
+
+    for (i = 0; i < ctl->step_cnt; i++) {
+        struct plan_step *s = &ctl->step[i];
+
+        printf ("step %3d : gid = %2d, did = %4d, pass = %4d, fail = %4d%s\n",
+                i, s->gid, s->did, s->pass, s->fail, (s->pass && s->fail) ? " (flaky)" : "");
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+// report on stdout ('-') : stdout of the process goes to stderr, so the
+// report is the only thing on the real stdout. Call it before device_setup
+// (group init output). return : 0 = error
+//
+//------------------------------------------------------------------------------
+int plan_console (const char *report_fname)
+{
+    if (strcmp (report_fname, "-") || (PlanReportFd >= 0))
+        return 1;
+
+    fflush (stdout);
+    if ((PlanReportFd = dup (STDOUT_FILENO)) < 0)
+        return 0;
+    if (dup2 (STDERR_FILENO, STDOUT_FILENO) < 0) {
+        close (PlanReportFd);
+        PlanReportFd = -1;
+        return 0;
+    }
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+//
+// return : 1 = every check passed, 0 = fail or plan error
+//
+//------------------------------------------------------------------------------
+int plan_run (const char *plan_fname, const char *report_fname, int iterations)
+{
+    struct plan_ctl *ctl;
+    FILE *fp = NULL;
+    int i, s, r, total = 0, ret = 1, format, fd;
+
+    if ((ctl = calloc (1, sizeof(struct plan_ctl))) == NULL)
+        return 0;
+
+    pthread_mutex_init (&ctl->mutex, NULL);
+    pthread_cond_init  (&ctl->cond, NULL);
+
+    if (iterations < 1)
+        iterations = 1;
+
+    if (!plan_load (ctl, plan_fname)) {
+        printf ("%s : %s no step!\n", __func__, plan_fname);
+        ret = 0;
+        goto out;
+    }
+
+    for (s = 0; s < ctl->step_cnt; s++)
+        total += ctl->step[s].repeat;
+
+    ctl->result = calloc ((size_t)total * iterations, sizeof(struct plan_result));
+    ctl->cycle  = calloc (iterations, sizeof(long long));
+    if ((ctl->result == NULL) || (ctl->cycle == NULL)) {
+        printf ("%s : result alloc error!\n", __func__);
+        ret = 0;
+        goto out;
+    }
+
+    if (ctl->schedule) {
+        plan_time_load (ctl, plan_fname);
+        if (!plan_schedule (ctl)) {
+            printf ("%s : schedule error!\n", __func__);
+            ret = 0;
+            goto out;
+        }
+        plan_stage_print (ctl);
+    }
+
+    ctl->t0 = dev_time_usec ();
+    for (i = 0; i < iterations; i++) {
+        long long start = dev_time_usec ();
+
+        if (ctl->schedule) {
+            for (s = 0; s < ctl->stage_cnt; s++) {
+                for (r = 0; r < ctl->item_cnt; r++) {
+                    struct plan_item *item = &ctl->item[r];
+                    struct plan_result *res;
+
+                    if (item->stage != s)
+                        continue;
+                    res = &ctl->result[ctl->result_cnt++];
+                    res->iter = i;  res->step = item->step;  res->rep = item->rep;
+                    res->gid  = ctl->step[item->step].gid;
+                    res->did  = ctl->step[item->step].did;
+                    plan_submit (ctl, res);
+                }
+                // next stage : every check of this one is done
+                plan_drain (ctl);
+            }
+        }
+        for (s = 0; !ctl->schedule && (s < ctl->step_cnt); s++) {
+            for (r = 0; r < ctl->step[s].repeat; r++) {
+                struct plan_result *res = &ctl->result[ctl->result_cnt++];
+
+                res->iter = i;  res->step = s;  res->rep = r;
+                res->gid  = ctl->step[s].gid;
+                res->did  = ctl->step[s].did;
+                plan_submit (ctl, res);
+            }
+        }
+        plan_drain (ctl);
+        ctl->cycle[i] = dev_time_usec () - start;
+    }
+    dev_log_flush ();
+
+    if (ctl->schedule)
+        plan_time_save (ctl, plan_fname);
+
+    for (i = 0; i < ctl->result_cnt; i++)
+        if (ctl->result[i].status != 1)
+            ret = 0;
+
+    plan_summary (ctl, iterations);
+
+    format = ((strlen (report_fname) > 5) &&
+              !strcmp (&report_fname[strlen (report_fname) - 5], ".json")) ?
+                ePLAN_REPORT_JSON : ePLAN_REPORT_CSV;
+
+    if (!strcmp (report_fname, "-")) {
+        // summary / log lines are not mixed into the report
+        if (plan_console (report_fname) && ((fd = dup (PlanReportFd)) >= 0) &&
+            ((fp = fdopen (fd, "w")) == NULL))
+            close (fd);
+    } else
+        fp = fopen (report_fname, "w");
+
+    if (fp == NULL) {
+        printf ("%s : %s file open error!\n", __func__, report_fname);
+        ret = 0;
+        goto out;
+    }
+    fflush (stdout);
+    if (format == ePLAN_REPORT_JSON)    report_json (ctl, fp, plan_fname, iterations);
+    else                                report_csv  (ctl, fp);
+    fclose (fp);
+out:
+    pthread_mutex_destroy (&ctl->mutex);
+    pthread_cond_destroy  (&ctl->cond);
+    free (ctl->result);
+    free (ctl->cycle);
+    free (ctl->item);
+    free (ctl->stage);
+    free (ctl);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #if defined(__LIB_DEV_CHECK_APP__)
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
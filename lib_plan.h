@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+/**
+ * @file lib_plan.h
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (test plan runner)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#ifndef __LIB_PLAN_H__
+#define __LIB_PLAN_H__
+
+//------------------------------------------------------------------------------
+// Plan file (same style as the device config, '#' = comment)
+//
+//   gid, did, action, repeat,      one step (repeat default 1)
+//   CONCURRENCY, n,                steps in flight (default 1 = in order)
+//   SCHEDULE, 1,                   run the steps in conflict free stages
+//   RESOURCE, gid, did, name,      the checks of (gid, did) use name (did -1 : all)
+//   DURATION, gid, did, action, ms, estimate until a run measured the check
+//
+// e.g) CONCURRENCY,4,
+//      4,0,0,
+//      5,1,0,10,
+//
+// Every (iteration, step, repeat) is one device_check(gid, did + action * 10).
+// Report : JSON (report name *.json) or CSV (anything else, '-' = stdout).
+// With the report on stdout, the console output of the library (printf,
+// DEV_LOG) goes to stderr (plan_console(), before device_setup()).
+// CONCURRENCY is clamped to the worker pool size of the board (online cpu
+// count, worker_threads()), the summary and the report show the requested
+// and the used value.
+//
+// Schedule : the checks are packed into stages (up to CONCURRENCY checks each),
+// a stage runs in parallel and the next one starts when it is done. Two checks
+// never share a stage when they use the same resource : the lane of the group
+// (hardware of the group, e.g. LED speed change / ethernet link, usb / storage
+// bus) and the RESOURCE names (default : jig_adc for AUDIO, LED and GPIO).
+// Plan order is kept between the checks of a lane. The longest lanes are placed
+// first, each check into the stage it makes the least longer (estimated).
+// Every scheduled run updates '{plan_fname}.time' (gid, did, usec, runs),
+// the estimate of the next run (moving average of the measured wall time).
+//------------------------------------------------------------------------------
+#define PLAN_STEP_MAX       256
+// 'W' (DEADLINE budget) retry : backoff doubles from 1 ms up to this (ms)
+#define PLAN_RETRY_MS       100
+
+// resource names (bit mask) and RESOURCE lines
+#define PLAN_RESOURCE_MAX   32
+#define PLAN_RULE_MAX       64
+
+#define PLAN_TIME_SUFFIX    ".time"
+// estimate of a check without DURATION / past run (usec)
+#define PLAN_TIME_DEFAULT   100000
+// new estimate = old + (measured - old) / PLAN_TIME_WEIGHT
+#define PLAN_TIME_WEIGHT    4
+
+enum {
+    ePLAN_REPORT_CSV = 0,
+    ePLAN_REPORT_JSON,
+};
+
+//------------------------------------------------------------------------------
+// function prototype
+//------------------------------------------------------------------------------
+extern int plan_console  (const char *report_fname);
+extern int plan_run      (const char *plan_fname, const char *report_fname, int iterations);
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#endif  // #define __LIB_PLAN_H__
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
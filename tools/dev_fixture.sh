@@ -0,0 +1,145 @@
+#!/bin/sh
+#------------------------------------------------------------------------------
+# * @file dev_fixture.sh
+# * @author charles-park (charles.park@hardkernel.com)
+# * @brief Fake /sys, /dev, /proc tree for off-target runs.(ODROID-C5)
+# *
+# * @copyright Copyright (c) 2022
+# *
+#------------------------------------------------------------------------------
+# Builds the device nodes used by dev_check.cfg below {root} and writes a
+# matching {root}/dev_check.cfg, then run the library on it :
+#
+#   tools/dev_fixture.sh -l /sys/bus/iio=2000 /tmp/fixture
+#   lib_dev_check -r /tmp/fixture -f /tmp/fixture/dev_check.cfg
+#   (or DEV_CHECK_ROOT=/tmp/fixture for programs linking the library)
+#
+# -l {path}={usec} : open latency of every node below {path} (repeat -l)
+# -s {MB}          : size of the file backed block devices (default 32)
+#
+# Node values can be changed while the library runs (echo 0 > .../hpd_state).
+# Input event nodes are fifos : write struct input_event records to inject
+# key presses.
+#------------------------------------------------------------------------------
+set -e
+
+usage () {
+    echo "Usage: $0 [-l path=usec] ... [-s MB] {root}"
+    exit 1
+}
+
+LATENCY=""
+BLK_SIZE=32
+
+while getopts "l:s:h" opt; do
+    case $opt in
+        l)  LATENCY="$LATENCY $OPTARG" ;;
+        s)  BLK_SIZE=$OPTARG ;;
+        *)  usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 1 ] || usage
+ROOT=$1
+
+# node {path} {value} : sysfs attribute
+node () {
+    mkdir -p "$ROOT$(dirname "$1")"
+    printf "%s\n" "$2" > "$ROOT$1"
+}
+
+# blk {path} : block device backed by a sparse file
+blk () {
+    mkdir -p "$ROOT$(dirname "$1")"
+    truncate -s "${BLK_SIZE}M" "$ROOT$1"
+}
+
+mkdir -p "$ROOT"
+
+#------------------------------------------------------------------------------
+# SYSTEM : memory (4G), frame buffer
+#------------------------------------------------------------------------------
+node /proc/meminfo "MemTotal:        3882384 kB"
+node /sys/class/graphics/fb0/virtual_size "800,480"
+
+#------------------------------------------------------------------------------
+# STORAGE : eMMC
+#------------------------------------------------------------------------------
+blk /dev/mmcblk0
+
+#------------------------------------------------------------------------------
+# USB : port speed, usb storage (sda ...) per port
+#------------------------------------------------------------------------------
+DISK=a
+for port in 3-1 1-1.1 1-1.2 1-1.3 1-1.4; do
+    node /sys/bus/usb/devices/$port/speed 480
+    mkdir -p "$ROOT/sys/bus/usb/devices/$port/$port:1.0/host0/block/sd$DISK"
+    blk /dev/sd$DISK
+    DISK=$(echo $DISK | tr a-d b-e)
+done
+
+#------------------------------------------------------------------------------
+# HDMI : edid (hex string), hot plug detect
+#------------------------------------------------------------------------------
+node /sys/devices/virtual/amhdmitx/amhdmitx0/rawedid 00ffffffffffff001e6d010001010101
+node /sys/devices/virtual/amhdmitx/amhdmitx0/hpd_state 1
+
+#------------------------------------------------------------------------------
+# ADC : H37 (1.358V), H40 (0.441V)
+#------------------------------------------------------------------------------
+node /sys/bus/iio/devices/iio:device0/in_voltage1_input 1358
+node /sys/bus/iio/devices/iio:device0/in_voltage0_input 441
+
+#------------------------------------------------------------------------------
+# ETHERNET / LED : link speed, led brightness / trigger
+#------------------------------------------------------------------------------
+node /sys/class/net/eth0/speed 1000
+for led in red blue; do
+    node /sys/class/leds/$led/brightness 0
+    node /sys/class/leds/$led/trigger none
+done
+
+#------------------------------------------------------------------------------
+# IR : input event node (fifo) + device name (find_event)
+#------------------------------------------------------------------------------
+mkdir -p "$ROOT/dev/input"
+[ -p "$ROOT/dev/input/event0" ] || mkfifo "$ROOT/dev/input/event0"
+node /sys/class/input/event0/device/name meson-ir
+
+#------------------------------------------------------------------------------
+# open latency (core/dev_root.h)
+#------------------------------------------------------------------------------
+: > "$ROOT/.latency"
+for l in $LATENCY; do
+    echo "${l%%=*} ${l#*=}" >> "$ROOT/.latency"
+done
+
+#------------------------------------------------------------------------------
+# config of the fake board (paths as on the target, remapped at run time)
+#------------------------------------------------------------------------------
+cat > "$ROOT/dev_check.cfg" << EOF
+# dev_fixture.sh : fake ODROID-C5 ($ROOT)
+ODROID-DEVICE-CONFIG
+SYSTEM,0,4,
+SYSTEM,1,800,
+SYSTEM,2,480,
+SYSTEM,3,/sys/class/graphics/fb0/virtual_size,
+STORAGE,0,/dev/mmcblk0,1,1,0,
+USB,0,/sys/bus/usb/devices/3-1,1,1,480,
+USB,1,/sys/bus/usb/devices/1-1.1,1,1,480,
+USB,2,/sys/bus/usb/devices/1-1.2,1,1,480,
+USB,3,/sys/bus/usb/devices/1-1.3,1,1,480,
+USB,4,/sys/bus/usb/devices/1-1.4,1,1,480,
+HDMI,0,/sys/devices/virtual/amhdmitx/amhdmitx0/rawedid,00ffffffffffff00,1,
+HDMI,1,/sys/devices/virtual/amhdmitx/amhdmitx0/hpd_state,1,1,
+ADC,0,/sys/bus/iio/devices/iio:device0/in_voltage1_input,1400,1300,
+ADC,1,/sys/bus/iio/devices/iio:device0/in_voltage0_input,490,390,
+LED,00,/sys/class/leds/red/brightness,1,0,P1_6.3,600,400,
+LED,01,/sys/class/leds/blue/brightness,1,0,P1_6.4,600,500,
+LED,03,/sys/class/net/eth0/speed,1000,100,P1_6.6,300,100,
+LED,-1,00,/sys/class/leds/red/trigger,none,
+LED,-1,01,/sys/class/leds/blue/trigger,none,
+IR,-1,meson-ir,5,0,
+EOF
+
+echo "$0 : $ROOT ready (cfg : $ROOT/dev_check.cfg)"
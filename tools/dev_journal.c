@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+/**
+ * @file dev_journal.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief Device Test library for ODROID-JIG. (result journal CSV export)
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------------
+#include "../core/check_journal.h"
+
+//------------------------------------------------------------------------------
+// make journal : tools/dev_journal {journal} ... > yield.csv
+//
+//   file,rec,mac,uuid,time,gid,did,id,action,status,value,resp,wall_ms
+//
+// One line per valid record of every journal (board), in file order.
+// time : UTC (ISO 8601, msec), id / action : did % 10, did / 10.
+// Torn records (reset while writing) are skipped and counted on stderr.
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+// CSV field : padding space removed, '"' doubled
+//------------------------------------------------------------------------------
+static void csv_str (const char *str, int size, char *out)
+{
+    int i, pos = 0;
+
+    for (i = 0; (i < size) && str[i]; i++) {
+        if ((str[i] == ' ') || (str[i] == '\r') || (str[i] == '\n'))
+            continue;
+        if (str[i] == '"')
+            out[pos++] = '"';
+        out[pos++] = str[i];
+    }
+    out[pos] = 0;
+}
+
+//------------------------------------------------------------------------------
+static void csv_time (long long usec, char *out, int size)
+{
+    time_t sec = (time_t)(usec / 1000000);
+    struct tm tm;
+    char buf[32];
+
+    gmtime_r (&sec, &tm);
+    strftime (buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf (out, size, "%s.%03lldZ", buf, (usec % 1000000) / 1000);
+}
+
+//------------------------------------------------------------------------------
+// return : exported records, -1 = not a journal
+//------------------------------------------------------------------------------
+static int journal_export (const char *fname, FILE *fp, int *torn)
+{
+    const struct journal_hdr *hdr;
+    const struct journal_rec *rec;
+    char resp[JOURNAL_RESP_SIZE * 2 +1], mac[JOURNAL_MAC_SIZE * 2 +1];
+    char uuid[JOURNAL_UUID_SIZE * 2 +1], stime[40];
+    struct stat st;
+    unsigned int i;
+    void *map;
+    int fd, cnt = 0;
+
+    if ((fd = open (fname, O_RDONLY)) < 0)
+        return -1;
+    if (fstat (fd, &st) || (st.st_size < JOURNAL_HDR_SIZE)) {
+        close (fd);
+        return -1;
+    }
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+        return -1;
+
+    hdr = (const struct journal_hdr *)map;
+    if (memcmp (hdr->magic, JOURNAL_MAGIC, sizeof(hdr->magic)) ||
+        (hdr->version != JOURNAL_VERSION) || (hdr->rec_size != JOURNAL_REC_SIZE) ||
+        (st.st_size < JOURNAL_HDR_SIZE + (off_t)hdr->rec_cnt * JOURNAL_REC_SIZE)) {
+        munmap (map, st.st_size);
+        return -1;
+    }
+    rec = (const struct journal_rec *)((const char *)map + JOURNAL_HDR_SIZE);
+
+    for (i = 0; i < hdr->rec_cnt; i++, rec++) {
+        if (rec->magic != JOURNAL_REC_MAGIC) {
+            // free record : a claimed one (reset) may follow
+            continue;
+        }
+        if (rec->hash != check_journal_hash (rec)) {
+            (*torn)++;
+            continue;
+        }
+        csv_str  (rec->resp, JOURNAL_RESP_SIZE, resp);
+        csv_str  (rec->mac,  JOURNAL_MAC_SIZE,  mac);
+        csv_str  (rec->uuid, JOURNAL_UUID_SIZE, uuid);
+        csv_time (rec->time_us, stime, sizeof(stime));
+
+        fprintf (fp, "\"%s\",%u,\"%s\",\"%s\",%s,%d,%d,%d,%d,%d,%d,\"%s\",%.3f\n",
+                 fname, i, mac, uuid, stime, rec->gid, rec->did, rec->did % 10, rec->did / 10,
+                 rec->status, rec->value, resp, rec->wall_us / 1000.0);
+        cnt++;
+    }
+    munmap (map, st.st_size);
+    return cnt;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+    int i, cnt, total = 0, torn = 0, ret = 0;
+
+    if (argc < 2) {
+        fprintf (stderr, "Usage: %s {journal file} ... > {csv file}\n", argv[0]);
+        return 1;
+    }
+
+    fprintf (stdout, "file,rec,mac,uuid,time,gid,did,id,action,status,value,resp,wall_ms\n");
+    for (i = 1; i < argc; i++) {
+        if ((cnt = journal_export (argv[i], stdout, &torn)) < 0) {
+            fprintf (stderr, "%s : %s not a journal!\n", __func__, argv[i]);
+            ret = 1;
+            continue;
+        }
+        total += cnt;
+    }
+    fprintf (stderr, "%s : %d files, %d records, %d torn\n", __func__, argc -1, total, torn);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------